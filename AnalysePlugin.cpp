@@ -19,9 +19,15 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 ------------------------------------- */
 //#include "stdafx.h"
 #include <windows.h>
+#include <algorithm>
+#include <new>
 #define MDBG_COMP "APmain:" 
 #include "AnalysePlugin.h"
 #include "tclFindResultDoc.h"
+#include "tclBatchAnalyser.h"
+#include "tclCompiledPattern.h"
+#include "tclMappedFile.h"
+#include "tclLineIndexFile.h"
 #include "chardefines.h"
 #include "PleaseWaitDlg.h"
 #include "boostregexsearch.h"
@@ -56,6 +62,7 @@ const TCHAR AnalysePlugin::KEYCONFIGLISTCOLORDER[] = TEXT("configListColumnOrder
 const TCHAR AnalysePlugin::KEYCUSTOMCOLORS[] = TEXT("customColors");
 const TCHAR AnalysePlugin::KEYORDERNUMHIDECOLWIDTH[] = TEXT("orderNumHideColWidth");
 const TCHAR AnalysePlugin::KEYWARNFOROLDNPPVERDONE[] = TEXT("warnForOldNppVersionDone");
+const TCHAR AnalysePlugin::KEYHIGHLIGHTINEDITOR[] = TEXT("highlightInEditor");
 const TCHAR AnalysePlugin::SECTIONNAME[] = TEXT("Analyse Plugin");
 const TCHAR AnalysePlugin::LOCALCONFFILE[] = TEXT("doLocalConf.xml");
 const TCHAR AnalysePlugin::ANALYSE_INIFILE[] = TEXT("AnalysePlugin.ini");
@@ -101,6 +108,9 @@ void MenuAddSelectionToPatterns () {
 void MenuRunSearch() {
    g_plugin.runSearch();
 }
+void MenuAnalyseDiskFile() {
+   g_plugin.analyseDiskFile();
+}
 void MenuShowHelpDialog () {
    g_plugin.showHelpDialog();
 }
@@ -127,6 +137,7 @@ BOOL AnalysePlugin::dllmain(HANDLE hModule,
          _funcItem[SHOWFINDDLG]._pFunc = MenuAnalyseToggle;
          _funcItem[ADDSELTOPATT]._pFunc = MenuAddSelectionToPatterns;
          _funcItem[RUNSEARCH]._pFunc = MenuRunSearch;
+         _funcItem[ANALYSEDISKFILE]._pFunc = MenuAnalyseDiskFile;
 #ifdef CONFIG_DIALOG
          _funcItem[SHOWCNFGDLG]._pFunc = MenuShowConfigDialog;
 #endif
@@ -135,6 +146,7 @@ BOOL AnalysePlugin::dllmain(HANDLE hModule,
          ::LoadString((HINSTANCE)_hModule, IDS_SHOW_ANALYSE_DIAG, _funcItem[SHOWFINDDLG]._itemName, nbChar);
          ::LoadString((HINSTANCE)_hModule, IDS_ADDSELTOPATT, _funcItem[ADDSELTOPATT]._itemName, nbChar);
          ::LoadString((HINSTANCE)_hModule, IDS_RUNSEARCH, _funcItem[RUNSEARCH]._itemName, nbChar);
+         ::LoadString((HINSTANCE)_hModule, IDS_ANALYSEDISKFILE, _funcItem[ANALYSEDISKFILE]._itemName, nbChar);
 #ifdef CONFIG_DIALOG
          ::LoadString((HINSTANCE)_hModule, IDS_SHOW_ANALYSE_CONFIG, _funcItem[SHOWCNFGDLG]._itemName, nbChar);
 #endif
@@ -326,6 +338,8 @@ in case new path and old path are different and in new path ini is not there loa
    _findDlg.setOrderNumHideColWidth(generic_atoi(tmp));
    ::GetPrivateProfileString(SECTIONNAME, KEYWARNFOROLDNPPVERDONE, TEXT("0"), tmp, COUNTCHAR(tmp), _iniFilePath);
    ScintillaSearchView::WarnForOldNppVersionDone = generic_atoi(tmp);
+   ::GetPrivateProfileString(SECTIONNAME, KEYHIGHLIGHTINEDITOR, TEXT("1"), tmp, COUNTCHAR(tmp), _iniFilePath);
+   _findResult.setHighlightMain(generic_atoi(tmp) != 0);
 
    generic_string man = TEXT("");
    HRSRC resourceHandle1 = ::FindResource(_hModule, MAKEINTRESOURCE(IDR_MANUAL), RT_HTML);
@@ -411,6 +425,8 @@ void AnalysePlugin::saveSettings() {
    ::WritePrivateProfileString(SECTIONNAME, KEYORDERNUMHIDECOLWIDTH, tmp, _iniFilePath);
    generic_itoa(ScintillaSearchView::WarnForOldNppVersionDone, tmp, 10);
    ::WritePrivateProfileString(SECTIONNAME, KEYWARNFOROLDNPPVERDONE, tmp, _iniFilePath);
+   generic_itoa((_findResult.getHighlightMain() ? 1 : 0), tmp, 10);
+   ::WritePrivateProfileString(SECTIONNAME, KEYHIGHLIGHTINEDITOR, tmp, _iniFilePath);
 }
 
 void AnalysePlugin::displaySectionCentered(int posStart, int posEnd, bool isDownwards)
@@ -476,45 +492,186 @@ void AnalysePlugin::setDisplayLineNo(bool bOn) {
 
 void AnalysePlugin::removeUnusedResultLines(tPatId pattId, const tclResult& oldResult, const tclResult& newResult) 
 {
+   cancelSearch();
    _findResult.removeUnusedResultLines(pattId, oldResult, newResult);
+   if (getIsResultOfActiveDoc()) {
+      _findResult.highlightMainView(true);
+   }
 }
 
 void AnalysePlugin::clearResult(bool initial)
 {
+   cancelSearch();
    setSearchFileName(TEXT(""));
    _findResult.clear(initial);
+   _resultBufferId = 0;
 }
 
 void AnalysePlugin::moveResult(tPatId oldPattId, tPatId newPattId)
 {  // this function is expected to be called from find dialog but may be called
    // from somewhere too; therefore we inform both windows about this action
    DBG2("moveResult(old, new) %f %f", oldPattId, newPattId);
+   cancelSearch();
    _findDlg.moveResult(oldPattId, newPattId);
    _findResult.moveResult(oldPattId, newPattId);
    updateStyles();
    _findResult.updateDockingDlg();
 }
 
-bool AnalysePlugin::bCheckLastFileNameSame(generic_string& file) {
-   TCHAR newFilename[MAX_PATH] = TEXT("");
-   TCHAR newDirname[MAX_PATH] = TEXT("");
-   execute(teNppWindows::nppHandle, NPPM_GETFILENAME, COUNTCHAR(newFilename), (LPARAM)newFilename);
-   execute(teNppWindows::nppHandle, NPPM_GETCURRENTDIRECTORY, COUNTCHAR(newDirname), (LPARAM)newDirname);
-   file = newDirname;
-   if(file.size()>0) {
-     file += TEXT("\\");
+void AnalysePlugin::bufferActivated(UINT_PTR bufferId)
+{
+   // the steps left search in the active view
+   cancelSearch();
+   _activeBufferId = bufferId;
+   if (bufferId != _resultBufferId && _findResult.isCreated()) {
+      // otherwise the result of the former buffer stays visible as before
+      restoreSession(bufferId);
    }
-   file += newFilename;
-   if(_LastSearchedFileName.compare(file)==0) 
-   {
-      return true;
+   if (!_findResult.isCreated()) {
+      return;
+   }
+   if (getIsResultOfActiveDoc()) {
+      _findResult.highlightMainView(true);
+   } else {
+      // colours left from a result dropped meanwhile
+      _findResult.clearMainHighlight();
+   }
+}
+
+bool AnalysePlugin::saveSession()
+{
+   if (_resultBufferId == 0 || _findResult.getOnDiskMode() || !_findResult.isCreated()) {
+      return false;
+   }
+   eraseSession(_resultBufferId);
+   _sessions.push_front(tstSession());
+   tstSession& session = _sessions.front();
+   session.bufferId = _resultBufferId;
+   session.fileName = _LastSearchedFileName;
+   session.docLength = _resultDocLength;
+   session.docHash = _resultDocHash;
+   session.bDocHash = _bResultDocHash;
+   session.patterns = _findDlg.getPatternList();
+   _findDlg.refResultList().swapResults(session.results);
+   _findResult.saveResultView(session.view);
+   session.memSize = session.view.memSize;
+   tclResultList::tlmResult::const_iterator iResult = session.results.begin();
+   for (; iResult != session.results.end(); ++iResult) {
+      session.memSize += iResult->second.size() * sizeof(tclPosInfo);
+   }
+   _sessionMemSize += session.memSize;
+   DBG3("saveSession() buffer %p with %d bytes, all sessions %d bytes", (void*)session.bufferId,
+      (int)session.memSize, (int)_sessionMemSize);
+   _resultBufferId = 0;
+   // the least recently used results are dropped first
+   while (_sessionMemSize > AP_SESSION_MEMORY_BUDGET && _sessions.size() > 0) {
+      eraseSession(--_sessions.end());
+   }
+   return true;
+}
+
+bool AnalysePlugin::restoreSession(UINT_PTR bufferId)
+{
+   tllSession::iterator iSession = _sessions.begin();
+   while (iSession != _sessions.end() && iSession->bufferId != bufferId) {
+      ++iSession;
+   }
+   if (iSession == _sessions.end()) {
+      return false;
+   }
+   if (!getIsSessionValid(*iSession)) {
+      DBG1("restoreSession() buffer %p modified since", (void*)bufferId);
+      eraseSession(iSession);
+      return false;
+   }
+   DBG1("restoreSession() buffer %p", (void*)bufferId);
+   // taken out of the list, so saving the shown result can't drop it
+   tllSession restored;
+   restored.splice(restored.begin(), _sessions, iSession);
+   _sessionMemSize -= restored.front().memSize;
+   saveSession();
+   tstSession& session = restored.front();
+   _findResult.restoreResultView(session.view);
+   _findDlg.refResultList().swapResults(session.results);
+   _resultBufferId = bufferId;
+   _resultDocLength = session.docLength;
+   _resultDocHash = session.docHash;
+   _bResultDocHash = true;
+   setSearchFileName(session.fileName);
+   updateStyles();
+   // the search engine still has the document of the last search
+   _docEdit.invalidate();
+   _findDlg.showSearchStats();
+   return true;
+}
+
+void AnalysePlugin::eraseSession(UINT_PTR bufferId)
+{
+   tllSession::iterator iSession = _sessions.begin();
+   for (; iSession != _sessions.end(); ++iSession) {
+      if (iSession->bufferId == bufferId) {
+         eraseSession(iSession);
+         return;
+      }
+   }
+}
+
+void AnalysePlugin::eraseSession(tllSession::iterator iSession)
+{
+   _findResult.releaseResultView(iSession->view);
+   _sessionMemSize -= iSession->memSize;
+   _sessions.erase(iSession);
+}
+
+bool AnalysePlugin::getIsSessionValid(const tstSession& session) const
+{
+   if ((tiLine)execute(teNppWindows::scnActiveHandle, SCI_GETLENGTH) != session.docLength) {
+      return false;
+   }
+   const tclPatternList& list = _findDlg.getPatternList();
+   if (list.size() != session.patterns.size()) {
+      return false;
+   }
+   tclPatternList::const_iterator it = list.begin();
+   for (; it != list.end(); ++it) {
+      tclPatternList::const_iterator iOld = session.patterns.find(it.getPatId());
+      if (iOld == session.patterns.end() || !iOld.getPattern().isSearchEqual(it.getPattern())) {
+         return false;
+      }
+   }
+   // a modification keeping the length, e.g. a reload or an overwrite,
+   // or one made while the result was shown but not searched yet
+   return session.bDocHash && getActiveDocHash() == session.docHash;
+}
+
+uint64_t AnalysePlugin::getActiveDocHash() const
+{
+   tiLine len = (tiLine)execute(teNppWindows::scnActiveHandle, SCI_GETLENGTH);
+   const char* pDoc = (const char*)execute(teNppWindows::scnActiveHandle, SCI_GETCHARACTERPOINTER);
+   return tclLineIndexFile::getContentHash(pDoc, len);
+}
+
+generic_string AnalysePlugin::getBufferFileName(UINT_PTR bufferId) const
+{
+   generic_string file;
+   LRESULT len = execute(teNppWindows::nppHandle, NPPM_GETFULLPATHFROMBUFFERID, bufferId, 0);
+   if (len > 0) {
+      file.resize(len + 1);
+      execute(teNppWindows::nppHandle, NPPM_GETFULLPATHFROMBUFFERID, bufferId, (LPARAM)&file[0]);
+      file.resize(len);
    }
-   return false;
+   return file;
 }
 
 BOOL AnalysePlugin::doSearch(tclResultList& resultList)
 {
    DBG0("doSearch() started");
+   // a search still running is superseded by this one
+   cancelSearch();
+   if (_searchRun.bActive) {
+      DBG0("doSearch() called during a search step");
+      return FALSE;
+   }
    BOOL bRes = TRUE;
 #ifdef FEATURE_RESVIEW_POS_KEEP_AT_SEARCH
    _findResult.saveCurrentViewPos();
@@ -525,27 +682,21 @@ BOOL AnalysePlugin::doSearch(tclResultList& resultList)
    if(isVisible()) {
       _findResult.display();
    }
-   _findResult.setCodePage(execute(teNppWindows::scnActiveHandle, SCI_GETCODEPAGE));
    // check whether search window is the same as before
    bool bReSearch = false;
-   generic_string currentfile;
-   if (!bCheckLastFileNameSame(currentfile)){
-      // not same file in editor. Remove content from results
-      setSearchFileName(currentfile);
+   _activeBufferId = (UINT_PTR)execute(teNppWindows::nppHandle, NPPM_GETCURRENTBUFFERID);
+   if (!getIsResultOfActiveDoc() && !restoreSession(_activeBufferId)) {
+      // not same file in editor. keep the shown result for switching back
+      saveSession();
+      _resultBufferId = _activeBufferId;
+      setSearchFileName(getBufferFileName(_activeBufferId));
       bReSearch = true;
    }
+   // after the former result has been put aside with its own code page
+   _findResult.setCodePage(execute(teNppWindows::scnActiveHandle, SCI_GETCODEPAGE));
    // check if we have the correct line num column size
    tiLine iNumLines = (tiLine)execute(teNppWindows::scnActiveHandle, SCI_GETLINECOUNT, 0, (LPARAM)0);
-   // easy way of int(log10(iNumLines))
-   int iLineNumColSize = (iNumLines<10)?1:
-                         (iNumLines<100)?2:
-                         (iNumLines<1000)?3:
-                         (iNumLines<10000)?4:
-                         (iNumLines<100000)?5:
-                         (iNumLines<1000000)?6:
-                         (iNumLines<10000000)?7:
-                         (iNumLines<100000000)?8:
-                         (iNumLines<1000000000)?9:10;
+   int iLineNumColSize = getLineNumColSize(iNumLines);
    if(_findResult.getLineNumColSize() != iLineNumColSize){
       // when changing the column size we have to refill the text
       _findResult.setLineNumColSize(iLineNumColSize);
@@ -557,6 +708,11 @@ BOOL AnalysePlugin::doSearch(tclResultList& resultList)
       bReSearch = true;
       DBG0("doSearch(): re search because all are same");
    }
+   // results of a file searched on disk don't belong to the editor
+   if (_findResult.getOnDiskMode()) {
+      _findResult.setOnDiskMode(false);
+      bReSearch = true;
+   }
    // did on option flag research, then ... 
    if (bReSearch) {
       _findResult.clear();
@@ -564,93 +720,330 @@ BOOL AnalysePlugin::doSearch(tclResultList& resultList)
    }
    // create the please wait message box
    _FindProcessCancelled = false;
+   _searchCancel.reset();
+   _cancelPollWatch.restart();
 
    // activate progress controls
    _findDlg.setPleaseWaitRange(0, resultList.size());
    _findDlg.activatePleaseWait();
-   unsigned commentWidth = resultList.getCommentWidth();
 
-   // for all patterns in the list test if result is dirty
+   // after text modifications the results stay valid outside of the 
+   // modified lines and only those get searched again
+   bool bTextModified = _docEdit.getIsValid() && !bReSearch;
+   prepareSearchEngine(bTextModified);
+   tiLine searchFrom = 0;
+   tiLine searchTo = -1;
+   if (bTextModified && 
+       resultList.getIsAllSearchedAt(_searchEngine.getDocLength() - _docEdit.getDelta()) && 
+       getIsRangeSearchable(resultList)) 
+   {
+      const tclLineIndex& lineIndex = _searchEngine.getLineIndex();
+      if (_docEdit.getIsModified()) {
+         searchFrom = lineIndex.positionFromLine(lineIndex.lineFromPosition(_docEdit.getStart()));
+         tiLine toLine = lineIndex.lineFromPosition(_docEdit.getNewEnd()) + 1;
+         searchTo = (toLine < lineIndex.getLineCount()) ? lineIndex.positionFromLine(toLine) : lineIndex.getLength();
+      } else {
+         searchTo = 0;
+      }
+      DBG2("doSearch() search modified range from %d to %d", (int)searchFrom, (int)searchTo);
+      shiftResults(resultList, searchFrom, searchTo);
+   } else if (!_docEdit.getIsValid() || _docEdit.getIsModified()) {
+      // results not searched now don't fit to the modified document anymore
+      tclResultList::iterator iResult = resultList.begin();
+      for (; iResult != resultList.end(); ++iResult) {
+         if (iResult.getResult().getIsDirty() == false) {
+            iResult.refResult().setSearchedLength(-1);
+         }
+      }
+   }
+   _searchRun.bActive = true;
+   _searchRun.bCopying = false;
+   _searchRun.bScanTask = false;
+   _searchRun.bScanDone = false;
+   _searchRun.bDiskFile = false;
+   _searchRun.id = ++_searchRunCount;
+   _searchRun.pList = &resultList;
+   _searchRun.from = searchFrom;
+   _searchRun.to = searchTo;
+   _searchRun.commentWidth = resultList.getCommentWidth();
+   _searchRun.iNext = resultList.begin();
+   _searchRun.patIndex = 1;
+   _searchRun.engineResults.clear();
+   // a fresh result window gets the lines found so far after each step
+   _searchRun.bBulkUpdate = _findResult.beginBulkUpdate();
+
+   // all literal patterns and regular expressions are searched together in
+   // one pass over the document on a thread of its own. the thread scans a
+   // copy, because the buffer may be modified or reloaded by notepad++ 
+   // without notifying the plugin before; modifications notified cancel the
+   // search, see beNotified(). the copy is taken in slices by the first 
+   // steps, so the editor stays responsive with a large document
+   _searchRun.pDoc = _searchEngine.getDocument();
+   _searchRun.bDocHash = false;
+   if (_searchEngine.prepare(resultList, searchFrom, searchTo) > 0) {
+      try {
+         _searchCopy.clear();
+         _searchCopy.reserve((size_t)_searchEngine.getDocLength());
+         _searchRun.bCopying = true;
+      } catch (const std::bad_alloc&) {
+         DBG0("doSearch() no memory to copy the document");
+      }
+      if (!_searchRun.bCopying) {
+         // the buffer is scanned here instead, which blocks the editor meanwhile
+         _searchEngine.setOnProgress(std::function<void()>());
+         _searchEngine.run(true);
+      }
+   }
+   ::PostMessage(_findDlg.getHSelf(), WM_COMMAND, IDC_DO_SEARCH_STEP, (LPARAM)_searchRun.id);
+   return bRes;
+}
+
+void AnalysePlugin::copySearchSlice()
+{
+   tiLine len = (tiLine)execute(teNppWindows::scnActiveHandle, SCI_GETLENGTH);
+   const char* pDoc = (const char*)execute(teNppWindows::scnActiveHandle, SCI_GETCHARACTERPOINTER);
+   if (len != _searchEngine.getDocLength() || pDoc != _searchRun.pDoc ||
+       (UINT_PTR)execute(teNppWindows::nppHandle, NPPM_GETCURRENTBUFFERID) != _activeBufferId) {
+      DBG0("copySearchSlice() document changed during the copy");
+      std::vector<char>().swap(_searchCopy);
+      _searchRun.bCopying = false;
+      _FindProcessCancelled = true;
+      return;
+   }
+   HWND hFindDlg = _findDlg.getHSelf();
+   unsigned id = _searchRun.id;
+   std::function<void()> postStep = [hFindDlg, id]() {
+      ::PostMessage(hFindDlg, WM_COMMAND, IDC_DO_SEARCH_STEP, (LPARAM)id);
+   };
+   const size_t copied = _searchCopy.size();
+   const size_t count = (std::min)((size_t)len - copied, (size_t)AP_SEARCH_COPY_SLICE);
+   _searchCopy.insert(_searchCopy.end(), pDoc + copied, pDoc + copied + count);
+   if (_searchCopy.size() < (size_t)len) {
+      postStep();
+      return;
+   }
+   // each pattern found completely gets a step of its own, the end of
+   // the scan another one
+   _searchRun.bCopying = false;
+   _searchEngine.moveDocument(_searchCopy.data());
+   _searchEngine.setOnProgress(postStep);
+   _searchRun.bScanTask = true;
+   _searchTask.start([this]() {
+      _searchEngine.run(false);
+      // for the session of the result, see finishSearch()
+      if (!_searchEngine.getCanceled()) {
+         _searchRun.docHash = tclLineIndexFile::getContentHash(_searchCopy.data(), (tiLine)_searchCopy.size());
+         _searchRun.bDocHash = true;
+      }
+   }, postStep);
+}
+
+void AnalysePlugin::insertEngineResults()
+{
+   tclResultList& resultList = *_searchRun.pList;
    tclResultList::iterator iResult = resultList.begin();
-   int iPatIndex = 1;
-   for (; iResult != resultList.end(); ++iResult, ++iPatIndex) 
+   for (; iResult != resultList.end() && !_searchRun.engineResults.empty(); ++iResult) {
+      if (iResult.getResult().getIsDirty() && 
+          _searchRun.engineResults.find(iResult.getPatId()) != _searchRun.engineResults.end()) {
+         searchPattern(iResult);
+      }
+   }
+}
+
+void AnalysePlugin::continueSearch(unsigned id)
+{
+   if (!_searchRun.bActive || _searchRun.bInStep || id != _searchRun.id) {
+      // step of a search cancelled or superseded meanwhile
+      return;
+   }
+   _searchRun.bInStep = true;
+   if (_searchRun.bDiskFile) {
+      continueDiskSearch();
+      _searchRun.bInStep = false;
+      return;
+   }
+   if (_searchRun.bCopying) {
+      copySearchSlice();
+      _searchRun.bInStep = false;
+      if (_FindProcessCancelled) {
+         finishSearch(true);
+      }
+      return;
+   }
+   if (!_searchRun.bScanDone && _searchRun.bScanTask && _searchTask.getIsRunning()) {
+      // the patterns found completely so far go into the result window
+      // while the scan goes on; the others wait for the end of the scan
+      _searchEngine.collect(_searchRun.engineResults);
+      insertEngineResults();
+      if (_searchRun.bBulkUpdate) {
+         _findResult.updateWindow();
+      } else {
+         _findResult.updateDockingDlg();
+      }
+      _searchRun.bInStep = false;
+      if (!_searchTask.getIsRunning()) {
+         // its last step may have been dropped meanwhile
+         ::PostMessage(_findDlg.getHSelf(), WM_COMMAND, IDC_DO_SEARCH_STEP, (LPARAM)id);
+      }
+      return;
+   }
+   if (!_searchRun.bScanDone) {
+      _searchTask.wait();
+      releaseSearchCopy();
+      _searchRun.bScanDone = true;
+      if (_searchRun.bScanTask && _searchTask.getFailed()) {
+         // the hits of a scan left halfway are not complete
+         DBG0("continueSearch() search engine failed");
+         _FindProcessCancelled = true;
+      } else if (!_FindProcessCancelled) {
+         _searchEngine.collect(_searchRun.engineResults);
+         showEngineErrors();
+      }
+      if (_searchEngine.getCanceled()) {
+         DBG0("continueSearch() search engine cancelled");
+         _FindProcessCancelled = true;
+      }
+   }
+   // for all patterns in the list test if result is dirty
+   tclResultList& resultList = *_searchRun.pList;
+   tclStopWatch stepWatch;
+   while (_searchRun.iNext != resultList.end() && !_FindProcessCancelled && 
+          !_searchCancel.getIsCanceled() && stepWatch.getMs() < AP_SEARCH_STEP_MS) 
    {
-      tclResult & result = iResult.refResult();
+      tclResultList::iterator iResult = _searchRun.iNext++;
+      int iPatIndex = _searchRun.patIndex++;
       // if result is dirty, start the search of the given pattern
-      if(result.getIsDirty()==false) {
+      if (iResult.getResult().getIsDirty() == false) {
          continue; // next pattern
       }
-      // find the pattern
-      tclResult oldResult = result;
-      result.clear();
-      const tclPattern& pattern = resultList.getPattern(iResult.getPatId());
       // update please wait controls
       _findDlg.setPleaseWaitProgress(iPatIndex);
-       unsigned u = doFindPattern(pattern, result);
-
-      if (u){
-         DBG1("doSearch() %d items found. Update result window.", u);
-         _findResult.reserve(u);
-         _findResult.removeUnusedResultLines(iResult.getPatId(), oldResult, result);
-         tclResult::tlvPosInfo::const_iterator it = result.getPositions().begin();
-         //int erasedLen = 0;
-         int lcount = (int)execute(teNppWindows::scnActiveHandle, SCI_GETLINECOUNT);
-         unsigned cp = (unsigned)execute(teNppWindows::scnActiveHandle, SCI_GETCODEPAGE);
-         WcharMbcsConvertor* wmc = &WcharMbcsConvertor::getInstance();
-         std::string comment;
-         if (wmc) {
-            comment = wmc->wchar2char(pattern.getComment().c_str(), cp);
-         }
-         for (;it!=result.getPositions().end();++it) {
-            if(it->line >= lcount) {
-               DBG4("doSearch() ERROR line is out of range! possible %d, line %d, start %d, end %d.",
-                  lcount, it->line, it->start, it->end);
-               continue;
-            }
-            /*int resultLine =*/ _findResult.insertPosInfo(iResult.getPatId(), it->line, *it);
-            int lend = (int)execute(teNppWindows::scnActiveHandle, SCI_GETLINEENDPOSITION, it->line);
-            int lstart = (int)execute(teNppWindows::scnActiveHandle, SCI_POSITIONFROMLINE, it->line);
-            int lineLength = lend - lstart; // formerly nbChar
-            if(!_findResult.getLineAvail(it->line)) {
-               if (_line==0 || ((int)_maxNbCharAllocated < lineLength))   //line longer than buffer, resize buffer
-               {
-                  _maxNbCharAllocated = lineLength;
-                  delete [] _line;
-                  _line = new char[_maxNbCharAllocated + 3];
-
-               }
-               execute(teNppWindows::scnActiveHandle, SCI_GETLINE, it->line, (LPARAM)_line);
-               for (int i = 0; i < lineLength; ++i) {
-                  if (_line[i] == 0) { // ensure paradigma no zeros in strings
-                     _line[i] = (char)0x20;
-                  }
-               }
-               _line[lineLength] = 0x0D;
-               _line[lineLength+1] = 0x0A;
-               _line[lineLength+2] = '\0';
-               _findResult.setLineText(it->line, _line, comment, commentWidth);
-            } else {
-               // line is already in search result
-               DBG0("doSearch() line is already in search result");
-            }
-         }
-      } else {
-         _findResult.removeUnusedResultLines(iResult.getPatId(), oldResult, result);
-      }
+      searchPattern(iResult);
       if (_FindProcessCancelled) {
-         DBG1("doSearch(_FindProcessCancelled) cancelled at pattern %d", iPatIndex );
+         DBG1("continueSearch(_FindProcessCancelled) cancelled at pattern %d", iPatIndex);
          break;
       }
-      if(_findDlg.getPleaseWaitCanceled()) {
-         DBG1("doSearch(APN_MSG_CANCEL_FIND) cancelled at pattern %d", iPatIndex );
+      if (isSearchCanceled()) {
+         DBG1("continueSearch(APN_MSG_CANCEL_FIND) cancelled at pattern %d", iPatIndex);
+         _FindProcessCancelled = true;
          break;
       }
+      if (!_searchRun.bBulkUpdate) {
+         _findResult.updateDockingDlg();
+      }
+   } // while patterns
+   _searchRun.bInStep = false;
+   if (_FindProcessCancelled || _searchCancel.getIsCanceled() || _searchRun.iNext == resultList.end()) {
+      finishSearch(_FindProcessCancelled || _searchCancel.getIsCanceled());
+      return;
+   }
+   if (_searchRun.bBulkUpdate) {
+      _findResult.updateWindow();
+   }
+   ::PostMessage(_findDlg.getHSelf(), WM_COMMAND, IDC_DO_SEARCH_STEP, (LPARAM)id);
+}
 
+void AnalysePlugin::searchPattern(tclResultList::iterator iResult)
+{
+   tclResultList& resultList = *_searchRun.pList;
+   tclResultList::tlmResult& engineResults = _searchRun.engineResults;
+   const tiLine searchTo = _searchRun.to;
+   tclResult & result = iResult.refResult();
+   // find the pattern
+   const tclPattern& pattern = resultList.getPattern(iResult.getPatId());
+   tclResultList::tlmResult::iterator iFound = engineResults.find(iResult.getPatId());
+   tiLine from = _searchRun.from;
+   // positions outside of the searched range are kept, all others get
+   // searched again
+   tclResult oldResult;
+   tclResult tail;
+   if (searchTo >= 0) {
+      result.splitAt(searchTo, tail);
+   }
+   result.splitAt(from, oldResult);
+   unsigned kept = result.size();
+   unsigned u = 0;
+   tstSearchStats stats;
+   if (iFound != engineResults.end()) {
+      // already found by the search engine
+      stats = iFound->second.getStats();
+      result.append(iFound->second);
+      result.setDirty(false);
+      result.setSearchedLength(iFound->second.getSearchedLength());
+      engineResults.erase(iFound);
+      u = result.size() - kept;
+   } else {
+      tiLine startRange = result.getLastEndBefore(from);
+      startRange = (startRange > from) ? startRange : from;
+      tclStopWatch watch;
+      u = doFindPattern(pattern, result, startRange, searchTo);
+      if (pattern.getDoSearch()) {
+         stats.searchMs = watch.getMs();
+         tiLine docLength = _searchEngine.getDocLength();
+         stats.bytes = ((searchTo < 0 || searchTo > docLength) ? docLength : searchTo) - startRange;
+      }
+      if (kept > result.size()) {
+         kept = result.size();
+      }
+   }
+   stats.hits = u;
+   tclStopWatch insertWatch;
+
+   // kept matches reaching into the searched tail get inserted again
+   unsigned first = kept;
+   while (first > 0 && result.getPosition(first - 1).end > from) {
+      --first;
+   }
+   if (result.size() > first){
+      DBG1("searchPattern() %d items found. Update result window.", u);
+      _findResult.reserve(u);
+      _findResult.removeUnusedResultLines(iResult.getPatId(), oldResult, result);
+      unsigned cp = (unsigned)execute(teNppWindows::scnActiveHandle, SCI_GETCODEPAGE);
+      stats.lines = insertResultLines(iResult.getPatId(), pattern, result, first, _searchEngine.getLineIndex(), cp, _searchRun.commentWidth);
+   } else {
+      _findResult.removeUnusedResultLines(iResult.getPatId(), oldResult, result);
+   }
+   stats.insertMs = insertWatch.getMs();
+   result.append(tail);
+   result.refStats() = stats;
+}
+
+void AnalysePlugin::finishSearch(bool bCancelled)
+{
+   DBG1("finishSearch() cancelled %d", (int)bCancelled);
+   _searchRun.bActive = false;
+   _searchRun.bCopying = false;
+   _searchRun.pList = 0;
+   _searchRun.engineResults.clear();
+   if (bCancelled) {
+      _FindProcessCancelled = true;
+   }
+   if (_searchRun.bBulkUpdate) {
+      _findResult.endBulkUpdate();
       _findResult.updateDockingDlg();
-      // we could store the the search range to the result too so that we  
-      //    later can check whether update of search is required when text
-      //    becomes appended
-   } // for patterns
+   } else {
+      // a cancelled search leaves the loop before updating the window
+      _findResult.updateWindow();
+   }
+   // further searches of a large document, e.g. after adding or editing a
+   // pattern, only scan the blocks which may contain the literals
+   if (!_FindProcessCancelled && _searchEngine.getNgramIndex() == 0 &&
+       _searchEngine.getDocLength() >= NGRAMINDEX_MIN_SIZE) {
+      _searchEngine.buildNgramIndex();
+   }
+   _resultDocLength = _searchEngine.getDocLength();
+   // the session of the result is restored for the same content only;
+   // the scan task hashes its copy, otherwise it is done here
+   _bResultDocHash = !_FindProcessCancelled;
+   if (_bResultDocHash) {
+      _resultDocHash = _searchRun.bDocHash ? _searchRun.docHash : getActiveDocHash();
+   }
+   // next modifications are collected from here on
+   if (_FindProcessCancelled) {
+      _docEdit.invalidate();
+   } else {
+      _docEdit.reset();
+   }
 #ifdef FEATURE_RESVIEW_POS_KEEP_AT_SEARCH
    _findResult.restoreCurrentViewPos();
 #endif
@@ -661,7 +1054,11 @@ BOOL AnalysePlugin::doSearch(tclResultList& resultList)
    //   _findResult.setCurrentMarkedLine(iThisLineToMove);
    //   _findResult.setCurrentViewPos(iThisLineToMove);
    //}
+   if (getIsResultOfActiveDoc()) {
+      _findResult.highlightMainView(true);
+   }
    _findDlg.activatePleaseWait(false);
+   _findDlg.showSearchStats();
 //   mCurScnHandle = getCurrentHScintilla(scnActiveHandle);
 // hier
 //#define MARGIN_SCRIPT_FOLD_INDEX 1
@@ -670,7 +1067,285 @@ BOOL AnalysePlugin::doSearch(tclResultList& resultList)
 //   ::SendMessage(mCurScnHandle, SCI_SETMARGINWIDTHN, MARGIN_SCRIPT_FOLD_INDEX, 0);
 //   ::SendMessage(mCurScnHandle, SCI_SETLEXER, SCLEX_CONTAINER, 0);
 //   ::PostMessage(mCurScnHandle, SCI_COLOURISE, 0, -1);
-   return bRes;
+}
+
+void AnalysePlugin::cancelSearch()
+{
+   if (!_searchRun.bActive) {
+      return;
+   }
+   DBG0("cancelSearch()");
+   _searchCancel.cancel();
+   if (_searchRun.bInStep) {
+      // the step stops after the pattern being searched
+      return;
+   }
+   // the scan stops soon after the token got cancelled
+   _searchTask.wait();
+   if (_searchRun.bDiskFile) {
+      finishDiskSearch(true);
+      return;
+   }
+   releaseSearchCopy();
+   finishSearch(true);
+}
+
+unsigned AnalysePlugin::insertResultLines(tPatId patId, const tclPattern& pattern, const tclResult& result, unsigned first,
+                                          const tclLineIndex& lineIndex, unsigned cp, unsigned commentWidth)
+{
+   unsigned lines = 0;
+   tclResult::tlvPosInfo::const_iterator it = result.getPositions().begin() + first;
+   //int erasedLen = 0;
+   // line text is copied directly out of the document buffer
+   const char* pDoc = lineIndex.getDocument();
+   tiLine lcount = lineIndex.getLineCount();
+   WcharMbcsConvertor* wmc = &WcharMbcsConvertor::getInstance();
+   std::string comment;
+   if (wmc) {
+      comment = wmc->wchar2char(pattern.getComment().c_str(), cp);
+   }
+   // all positions are inserted first, so they are merged at once
+   for (;it!=result.getPositions().end();++it) {
+      if(it->line >= lcount) {
+         DBG4("insertResultLines() ERROR line is out of range! possible %d, line %d, start %d, end %d.",
+            lcount, it->line, it->start, it->end);
+         continue;
+      }
+      // the result window keeps the positions relative to their line
+      tclPosInfo pos = *it;
+      tiLine lstart = lineIndex.positionFromLine(it->line);
+      pos.start -= lstart;
+      pos.end -= lstart;
+      _findResult.insertPosInfo(patId, it->line, pos);
+   }
+   for (it = result.getPositions().begin() + first;it!=result.getPositions().end();++it) {
+      if(it->line >= lcount) {
+         continue;
+      }
+      if(!_findResult.getLineAvail(it->line)) {
+         tiLine lstart = lineIndex.positionFromLine(it->line);
+         tiLine lineLength = lineIndex.lineEndPosition(it->line) - lstart; // formerly nbChar
+         if (_line==0 || ((tiLine)_maxNbCharAllocated < lineLength))   //line longer than buffer, resize buffer
+         {
+            _maxNbCharAllocated = lineLength;
+            delete [] _line;
+            _line = new char[_maxNbCharAllocated + 3];
+
+         }
+         memcpy(_line, pDoc + lstart, lineLength);
+         for (tiLine i = 0; i < lineLength; ++i) {
+            if (_line[i] == 0) { // ensure paradigma no zeros in strings
+               _line[i] = (char)0x20;
+            }
+         }
+         _line[lineLength] = 0x0D;
+         _line[lineLength+1] = 0x0A;
+         _line[lineLength+2] = '\0';
+         _findResult.setLineText(it->line, _line, comment, commentWidth);
+         ++lines;
+      } else {
+         // line is already in search result
+         DBG0("insertResultLines() line is already in search result");
+      }
+   }
+   return lines;
+}
+
+int AnalysePlugin::getLineNumColSize(tiLine iNumLines)
+{
+   // easy way of int(log10(iNumLines))
+   return (iNumLines<10)?1:
+          (iNumLines<100)?2:
+          (iNumLines<1000)?3:
+          (iNumLines<10000)?4:
+          (iNumLines<100000)?5:
+          (iNumLines<1000000)?6:
+          (iNumLines<10000000)?7:
+          (iNumLines<100000000)?8:
+          (iNumLines<1000000000)?9:10;
+}
+
+void AnalysePlugin::analyseDiskFile()
+{
+   if (!isVisible()) {
+      toggleShowFindDlg();
+   }
+   OPENFILENAME ofn;       // common dialog box structure
+   TCHAR szFile[AP_MAX_PATH]=TEXT("");       // buffer for file name
+   ZeroMemory(&ofn, sizeof(ofn));
+   ofn.lStructSize = sizeof(ofn);
+   ofn.hwndOwner = _nppData._nppHandle;
+   ofn.lpstrFile = szFile;
+   ofn.nMaxFile = COUNTCHAR(szFile);
+   ofn.lpstrFilter = TEXT("All\0*.*\0Log Files\0*.log;*.txt\0");
+   ofn.nFilterIndex = 1;
+   ofn.lpstrTitle = TEXT("Analyse File on Disk");
+   ofn.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST;
+   if (GetOpenFileName(&ofn)==TRUE) {
+      doSearchDiskFile(_findDlg.refResultList(), ofn.lpstrFile);
+   }
+}
+
+BOOL AnalysePlugin::doSearchDiskFile(tclResultList& resultList, const generic_string& fileName)
+{
+   DBG0("doSearchDiskFile() started");
+   cancelSearch();
+   if (_searchRun.bActive) {
+      DBG0("doSearchDiskFile() called during a search step");
+      return FALSE;
+   }
+   // the file is mapped and not loaded, only the found lines are copied
+   std::unique_ptr<tstDiskRun> pRun(new tstDiskRun);
+   if (!pRun->file.open(fileName)) {
+      generic_string msg = TEXT("The file could not be opened for analysing:\n") + fileName;
+      ::MessageBox(_nppData._nppHandle, msg.c_str(), TEXT("Analyse Plugin - Sorry"), MB_OK);
+      return FALSE;
+   }
+   pRun->pDoc = pRun->file.getData();
+   pRun->length = pRun->file.getLength();
+   // the editor doesn't show the utf-8 byte order mark either
+   if (pRun->length >= 3 && memcmp(pRun->pDoc, "\xEF\xBB\xBF", 3) == 0) {
+      pRun->pDoc += 3;
+      pRun->length -= 3;
+   }
+   _findResult.setPatternStyles(resultList);
+   if(isVisible()) {
+      _findResult.display();
+   }
+   // the bookmarks belong to the result put aside
+   _findResult.clear(saveSession());
+   _resultBufferId = 0;
+   _findResult.setCodePage(SC_CP_UTF8);
+   _findResult.setOnDiskMode(true);
+   setSearchFileName(fileName);
+   _findDlg.setAllDirty();
+   // the next search in the editor starts over
+   _docEdit.invalidate();
+   _FindProcessCancelled = false;
+   _searchCancel.reset();
+   _cancelPollWatch.restart();
+   _findDlg.setPleaseWaitRange(0, resultList.size());
+   _findDlg.activatePleaseWait();
+
+   // the regular expressions are compiled here, the thread only uses them
+   pRun->list = resultList;
+   tclResultList::const_iterator iResult = pRun->list.begin();
+   for (; iResult != pRun->list.end(); ++iResult) {
+      try {
+         pRun->list.getPattern(iResult.getPatId()).getCompiled(SC_CP_UTF8).getRegex();
+      } catch (const std::runtime_error&) {
+         // reported by the analyser
+      }
+   }
+   pRun->analyser.setCancelToken(&_searchCancel);
+   _pDiskRun.swap(pRun);
+   _searchRun.bActive = true;
+   _searchRun.bCopying = false;
+   _searchRun.bScanTask = true;
+   _searchRun.bScanDone = false;
+   _searchRun.bDiskFile = true;
+   _searchRun.id = ++_searchRunCount;
+   _searchRun.pList = &resultList;
+   _searchRun.pDoc = 0;
+   _searchRun.commentWidth = resultList.getCommentWidth();
+   _searchRun.iNext = resultList.begin();
+   _searchRun.patIndex = 1;
+   _searchRun.engineResults.clear();
+   _searchRun.bBulkUpdate = false;
+   HWND hFindDlg = _findDlg.getHSelf();
+   unsigned id = _searchRun.id;
+   tstDiskRun* pDiskRun = _pDiskRun.get();
+   _searchTask.start([pDiskRun]() { 
+         pDiskRun->analyser.analyseFile(pDiskRun->list, pDiskRun->pDoc, pDiskRun->length, pDiskRun->file); 
+      }, [hFindDlg, id]() {
+         ::PostMessage(hFindDlg, WM_COMMAND, IDC_DO_SEARCH_STEP, (LPARAM)id);
+      });
+   return TRUE;
+}
+
+void AnalysePlugin::continueDiskSearch()
+{
+   tclResultList& resultList = *_searchRun.pList;
+   tstDiskRun& run = *_pDiskRun;
+   if (!_searchRun.bScanDone) {
+      _searchTask.wait();
+      _searchRun.bScanDone = true;
+      if (_searchTask.getFailed() || run.analyser.getCanceled()) {
+         DBG0("continueDiskSearch() cancelled");
+         finishDiskSearch(true);
+         return;
+      }
+      // the results found for the patterns still in the list
+      tclResultList::iterator iResult = resultList.begin();
+      for (; iResult != resultList.end(); ++iResult) {
+         tclResultList::iterator iFound = run.list.begin();
+         while (iFound != run.list.end() && iFound.getPatId() != iResult.getPatId()) {
+            ++iFound;
+         }
+         if (iFound != run.list.end()) {
+            iResult.refResult().swap(iFound.refResult());
+         }
+      }
+      _findResult.setLineNumColSize(getLineNumColSize(run.analyser.getLineIndex().getLineCount()));
+      _searchRun.bBulkUpdate = _findResult.beginBulkUpdate();
+   }
+   const tclLineIndex& lineIndex = run.analyser.getLineIndex();
+   tclStopWatch stepWatch;
+   while (_searchRun.iNext != resultList.end() && !_searchCancel.getIsCanceled() && 
+          stepWatch.getMs() < AP_SEARCH_STEP_MS) 
+   {
+      tclResultList::iterator iResult = _searchRun.iNext++;
+      int iPatIndex = _searchRun.patIndex++;
+      tclResult& result = iResult.refResult();
+      if (result.getIsDirty() || result.size() == 0) {
+         continue;
+      }
+      _findDlg.setPleaseWaitProgress(iPatIndex);
+      tclStopWatch insertWatch;
+      _findResult.reserve(result.size());
+      result.refStats().lines = insertResultLines(iResult.getPatId(), resultList.getPattern(iResult.getPatId()), result, 0,
+                                                  lineIndex, SC_CP_UTF8, _searchRun.commentWidth);
+      result.refStats().insertMs = insertWatch.getMs();
+      if (isSearchCanceled()) {
+         break;
+      }
+   }
+   if (_searchCancel.getIsCanceled() || _searchRun.iNext == resultList.end()) {
+      finishDiskSearch(_searchCancel.getIsCanceled());
+      return;
+   }
+   if (_searchRun.bBulkUpdate) {
+      _findResult.updateWindow();
+   }
+   ::PostMessage(_findDlg.getHSelf(), WM_COMMAND, IDC_DO_SEARCH_STEP, (LPARAM)_searchRun.id);
+}
+
+void AnalysePlugin::finishDiskSearch(bool bCancelled)
+{
+   DBG1("finishDiskSearch() cancelled %d", (int)bCancelled);
+   _searchRun.bActive = false;
+   _searchRun.bDiskFile = false;
+   _searchRun.pList = 0;
+   if (bCancelled) {
+      _FindProcessCancelled = true;
+   }
+   if (_searchRun.bBulkUpdate) {
+      _findResult.endBulkUpdate();
+      _searchRun.bBulkUpdate = false;
+   }
+   _findResult.updateDockingDlg();
+   _findDlg.activatePleaseWait(false);
+   // the lines are copied into the result window, the file is not needed anymore
+   std::unique_ptr<tstDiskRun> pRun;
+   pRun.swap(_pDiskRun);
+   if (pRun && pRun->analyser.getErrors().size() > 0) {
+      generic_string msg;
+      for (size_t i = 0; i < pRun->analyser.getErrors().size(); ++i) {
+         msg += pRun->analyser.getErrors()[i] + TEXT("\n");
+      }
+      ::MessageBox(_nppData._nppHandle, msg.c_str(), TEXT("Analyse Plugin - Patterns not searched"), MB_OK);
+   }
+   _findDlg.showSearchStats();
 }
 
 BOOL AnalysePlugin::doFindTestCaseFromDb(tclResultList& resultList) 
@@ -730,17 +1405,56 @@ void AnalysePlugin::beNotified(SCNotification *notification)
    case SCN_SAVEPOINTREACHED:DBG0("beNotified() SCN_SAVEPOINTREACHED");break;
    case NPPN_FILEBEFOREOPEN:DBG0("beNotified() NPPN_FILEBEFOREOPEN");break;
    case NPPN_FILEOPENED:DBG0("beNotified() NPPN_FILEOPENED");break;
-   case NPPN_BUFFERACTIVATED:DBG1("beNotified() NPPN_BUFFERACTIVATED BufferID = %p", notification->nmhdr.idFrom);break;
+   case NPPN_BUFFERACTIVATED:
+      {
+         DBG1("beNotified() NPPN_BUFFERACTIVATED BufferID = %p", notification->nmhdr.idFrom);
+         bufferActivated(notification->nmhdr.idFrom);
+         break;
+      }
+   case NPPN_FILEBEFORECLOSE:
+      {
+         // the scan must not read the buffer freed after closing
+         DBG1("beNotified() NPPN_FILEBEFORECLOSE BufferID = %p", notification->nmhdr.idFrom);
+         cancelSearch();
+         break;
+      }
+   case NPPN_FILECLOSED:
+      {
+         DBG1("beNotified() NPPN_FILECLOSED BufferID = %p", notification->nmhdr.idFrom);
+         eraseSession(notification->nmhdr.idFrom);
+         if (notification->nmhdr.idFrom == _resultBufferId) {
+            // the result stays visible but belongs to no document anymore
+            _resultBufferId = 0;
+         }
+         break;
+      }
+   case NPPN_FILERENAMED:
+      {
+         if (notification->nmhdr.idFrom == _resultBufferId) {
+            setSearchFileName(getBufferFileName(_resultBufferId));
+         }
+         tllSession::iterator iSession = _sessions.begin();
+         for (; iSession != _sessions.end(); ++iSession) {
+            if (iSession->bufferId == notification->nmhdr.idFrom) {
+               iSession->fileName = getBufferFileName(iSession->bufferId);
+            }
+         }
+         break;
+      }
    case SCN_UPDATEUI:
       {
          if (((notification->updated & SC_UPDATE_V_SCROLL) != 0) && _configDlg.getIsSyncScroll() ) {
-            generic_string currFile;
-            if (bCheckLastFileNameSame(currFile)) {
+            if (getIsResultOfActiveDoc()) {
                int currTopLine = (int)execute(teNppWindows::scnActiveHandle, SCI_GETFIRSTVISIBLELINE);
                DBG1("beNotified() SCN_UPDATEUI: Scrolled to currTopLine=%d", currTopLine);
                _findResult.updateViewScrollState(currTopLine, true);
             }
          }
+         // the hits get coloured when they are scrolled into the main window
+         if (((notification->updated & SC_UPDATE_V_SCROLL) != 0) && getIsResultOfActiveDoc() &&
+             notification->nmhdr.hwndFrom == getCurrentHScintilla(teNppWindows::scnActiveHandle)) {
+            _findResult.highlightMainView();
+         }
          if(_bIgnoreBufferModify) {
             DBG0("beNotified() SCN_UPDATEUI _bIgnoreBufferModify = false");
             _bIgnoreBufferModify = false;
@@ -802,6 +1516,10 @@ void AnalysePlugin::beNotified(SCNotification *notification)
 #endif // SCN_STYLENEEDED
    case SCN_MODIFIED:
       {
+         if ((notification->modificationType & (SC_MOD_BEFOREINSERT | SC_MOD_BEFOREDELETE)) != 0) {
+            // the search runs on the unmodified buffer
+            cancelSearch();
+         }
          if((notification->modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT))!= 0) {
             if (notification->length < 100) {
             DBG4("AnalysePlugin: SCN_MODIFIED(text) linesAdded %d, position %d, length %d, text '%s'",
@@ -815,14 +1533,24 @@ void AnalysePlugin::beNotified(SCNotification *notification)
                   notification->position,
                   notification->length);
             }
+            // a cloned document reports its modifications in both views
+            if (notification->nmhdr.hwndFrom == getCurrentHScintilla(teNppWindows::scnActiveHandle) &&
+                getIsResultOfActiveDoc()) 
+            {
+               // modifications not announced before leave the copy searched behind
+               cancelSearch();
+               bool bInsert = (notification->modificationType & SC_MOD_INSERTTEXT) != 0;
+               _docEdit.addModification(notification->position, notification->length, bInsert, notification->linesAdded);
+               _resultDocLength += bInsert ? notification->length : -notification->length;
+               _bResultDocHash = false;
+            }
             if (!_bIgnoreBufferModify && _findDlg.isVisible() && _configDlg.getOnAutoUpdate()) {
-               generic_string currentfile;
-               if(bCheckLastFileNameSame(currentfile)){
+               if(getIsResultOfActiveDoc()){
                   // set the modification flag which will become activated after timer has elapsed
                   DBG0("AnalysePlugin: SCN_MODIFIED(text) setting SetModified()");
                   _findDlg.SetModified();
                } else {
-                  DBG1("AnalysePlugin: SCN_MODIFIED(text) for different file %s", currentfile.c_str());
+                  DBG0("AnalysePlugin: SCN_MODIFIED(text) for a document without result");
                }
             }
          }
@@ -855,7 +1583,9 @@ void AnalysePlugin::beNotified(SCNotification *notification)
       {
          DBG0("NPPN_READY");
          _nppReady = true;
+         _activeBufferId = (UINT_PTR)execute(teNppWindows::nppHandle, NPPM_GETCURRENTBUFFERID);
          loadSettings();
+         _findResult.allocateIndicators();
 
             ::SendMessage(_nppData._nppHandle, NPPM_SETMENUITEMCHECK, _funcItem[SHOWFINDDLG]._cmdID, (LPARAM)_bPluginVisible);
          showFindDlg();
@@ -865,7 +1595,11 @@ void AnalysePlugin::beNotified(SCNotification *notification)
    case NPPN_SHUTDOWN:
       {
          DBG0("NPPN_SHUTDOWN");
+         cancelSearch();
          saveSettings();
+         while (_sessions.size() > 0) {
+            eraseSession(_sessions.begin());
+         }
          break;
       }
    default:
@@ -1002,38 +1736,175 @@ bool AnalysePlugin::readBase(const generic_string& str, int /*curPos*/, int * va
 }
 
 
-int AnalysePlugin::doFindPattern(const tclPattern& pattern, tclResult& result)
+std::string AnalysePlugin::getCharsOfClass(int sciMsg)
+{
+   int len = (int)execute(teNppWindows::scnActiveHandle, sciMsg, 0, 0);
+   std::string chars(len + 1, '\0');
+   execute(teNppWindows::scnActiveHandle, sciMsg, 0, (LPARAM)&chars[0]);
+   chars.resize(len);
+   return chars;
+}
+
+bool AnalysePlugin::getIsRangeSearchable(const tclResultList& resultList) const
+{
+   tclResultList::const_iterator iResult = resultList.begin();
+   for (; iResult != resultList.end(); ++iResult) {
+      const tclPattern& pattern = resultList.getPattern(iResult.getPatId());
+      if (iResult.getResult().getIsDirty() && pattern.getDoSearch() && 
+          !tclSearchEngine::isLineBound(pattern)) {
+         DBGW1("getIsRangeSearchable() pattern %s may match across lines", pattern.getSearchText().c_str());
+         return false;
+      }
+   }
+   return true;
+}
+
+void AnalysePlugin::shiftResults(tclResultList& resultList, tiLine from, tiLine to)
+{
+   const tclLineIndex& lineIndex = _searchEngine.getLineIndex();
+   const tiLine delta = _docEdit.getDelta();
+   const tiLine linesAdded = _docEdit.getLinesAdded();
+   // first line behind the modified range in the former document
+   tiLine toLine = (to < lineIndex.getLength()) ? lineIndex.lineFromPosition(to) : lineIndex.getLineCount();
+   tiLine oldToLine = toLine - linesAdded;
+   tclResultList::iterator iResult = resultList.begin();
+   for (; iResult != resultList.end(); ++iResult) {
+      tclResult& result = iResult.refResult();
+      tclResult removed;
+      tclResult tail;
+      result.splitAt(from, removed);
+      removed.splitAt(to - delta, tail);
+      if (removed.size() > 0) {
+         _findResult.removeUnusedResultLines(iResult.getPatId(), removed, result);
+      }
+      tail.shift(delta, linesAdded);
+      result.append(tail);
+      // searched completely again if the search gets cancelled
+      result.setDirty();
+   }
+   _findResult.shiftLines(oldToLine, linesAdded);
+}
+
+void AnalysePlugin::prepareSearchEngine(bool bTextModified)
+{
+   _searchEngine.setCodePage((unsigned)execute(teNppWindows::scnActiveHandle, SCI_GETCODEPAGE));
+   _searchEngine.setCharClasses(getCharsOfClass(SCI_GETWORDCHARS),
+                                getCharsOfClass(SCI_GETWHITESPACECHARS),
+                                getCharsOfClass(SCI_GETPUNCTUATIONCHARS));
+   // the pointer is valid as long as the document is not modified
+   tiLine len = (tiLine)execute(teNppWindows::scnActiveHandle, SCI_GETLENGTH);
+   const char* pDoc = (const char*)execute(teNppWindows::scnActiveHandle, SCI_GETCHARACTERPOINTER);
+   if (bTextModified) {
+      _searchEngine.updateDocument(pDoc, len, _docEdit);
+   } else {
+      _searchEngine.setDocument(pDoc, len);
+   }
+}
+
+void AnalysePlugin::releaseSearchCopy()
+{
+   if (_searchCopy.empty()) {
+      return;
+   }
+   tiLine len = (tiLine)execute(teNppWindows::scnActiveHandle, SCI_GETLENGTH);
+   const char* pDoc = (const char*)execute(teNppWindows::scnActiveHandle, SCI_GETCHARACTERPOINTER);
+   if (len == _searchEngine.getDocLength() && pDoc == _searchRun.pDoc) {
+      // the hits and the line index fit to the buffer as well; a text
+      // modified meanwhile has cancelled the search already
+      _searchEngine.moveDocument(pDoc);
+   } else {
+      DBG0("releaseSearchCopy() document changed during the scan");
+      _searchEngine.setDocument(pDoc, len);
+      _FindProcessCancelled = true;
+   }
+   std::vector<char>().swap(_searchCopy);
+}
+
+void AnalysePlugin::showEngineErrors()
+{
+   tclSearchEngine::tlvError errors;
+   _searchEngine.takeErrors(errors);
+   tclSearchEngine::tlvError::const_iterator it = errors.begin();
+   for (; it != errors.end(); ++it) {
+      const tclPattern& pattern = _searchRun.pList->getPattern(it->first);
+#ifdef UNICODE
+      generic_string what(WcharMbcsConvertor::getInstance().char2wchar(it->second.c_str(), CP_ACP));
+#else
+      generic_string what(it->second);
+#endif
+      _findDlg.activatePleaseWait(false);
+      generic_string serr = TEXT("Error in pattern [") + pattern.getSearchText() + TEXT("]");
+      ::MessageBox(getCurrentHScintilla(teNppWindows::scnActiveHandle), what.c_str(), serr.c_str(), MB_ICONERROR | MB_OK);
+   }
+}
+
+bool AnalysePlugin::isRangeWord(tiLine start, tiLine end)
+{
+   return execute(teNppWindows::scnActiveHandle, SCI_ISRANGEWORD, (WPARAM)start, (LPARAM)end) != 0;
+}
+
+bool AnalysePlugin::isSearchCanceled()
+{
+   // asking the please wait dialog peeks into the message queue
+   if (!_searchCancel.getIsCanceled() && _cancelPollWatch.getMs() >= AP_CANCEL_POLL_MS) {
+      _cancelPollWatch.restart();
+      if (_findDlg.getPleaseWaitCanceled()) {
+         _searchCancel.cancel();
+      }
+   }
+   return _searchCancel.getIsCanceled();
+}
+
+int AnalysePlugin::doFindPattern(const tclPattern& pattern, tclResult& result, tiLine startRange, tiLine endRange)
 {
    DBGW1("doFindPattern() %s", pattern.getSearchText().c_str());
    if(pattern.getDoSearch() == false) {
       DBG0("doFindPattern() don't search: mDoSearch==false.");
       result.clear();
       result.setDirty(false); // once through we mark the list as ready
+      result.setSearchedLength(_searchEngine.getLineIndex().getLength());
       return 0;
    }
    // when finding an entry add it to the result and set the result to not dirty 
    // initial range definition
-   int startRange = 0; // from very begin
-   int endRange = (int)execute(teNppWindows::scnActiveHandle, SCI_GETLENGTH);
-   if (endRange < 1) {
+   const tclLineIndex& lineIndex = _searchEngine.getLineIndex();
+   const tiLine docLength = lineIndex.getLength();
+   if (endRange < 0 || endRange > docLength) {
+      endRange = docLength;
+   } else if (endRange < docLength) {
+      if (endRange <= startRange) {
+         DBG0("doFindPattern() don't search: range is empty.");
+         result.setDirty(false); // once through we mark the list as ready
+         result.setSearchedLength(docLength);
+         return 0;
+      }
+      // a range ending at a line start must not let $ match there
+      const char* pDoc = lineIndex.getDocument();
+      if (pDoc[endRange - 1] == '\n') {
+         --endRange;
+      }
+      if (endRange > startRange && pDoc[endRange - 1] == '\r') {
+         --endRange;
+      }
+   }
+   if (docLength < 1) {
       DBG0("doFindPattern() don't search: document is empty.");
       // nothing to do because that means the document is empty
       return 0; 
    } 
    // flags for the search 
    int flags =0;
-   generic_string text;
    if(pattern.getSearchType()== tclPattern::regex) {
       flags |= (SCFIND_REGEXP|SCFIND_POSIX);
-      text = pattern.getSearchText(); // text to be searched
    } else if(pattern.getSearchType()== tclPattern::rgx_multiline) {
       flags |= (SCFIND_REGEXP|SCFIND_POSIX|SCFIND_REGEXP_DOTMATCHESNL);
-      text = pattern.getSearchText(); // text to be searched
-   } else if(pattern.getSearchType()== tclPattern::escaped) {
-      text = convertExtendedToString(pattern.getSearchText());
-   } else {
-      text = pattern.getSearchText(); // text to be searched
    }
+   // text to be searched; escapes resolved and converted into the code page
+   // only once, the pattern keeps it for the next searches
+   unsigned int cp = (unsigned int)execute(teNppWindows::scnActiveHandle, SCI_GETCODEPAGE);
+   const tclCompiledPattern& compiled = pattern.getCompiled(cp);
+   const std::string& text = compiled.getText();
+   const char *text2FindA = text.c_str();
    
    flags |= pattern.getIsMatchCase()?SCFIND_MATCHCASE:0;
    flags |= pattern.getIsWholeWord()?SCFIND_WHOLEWORD:0;
@@ -1054,39 +1925,35 @@ int AnalysePlugin::doFindPattern(const tclPattern& pattern, tclResult& result)
       }
    }
 #endif
-   //Initial range for searching
-   execute(teNppWindows::scnActiveHandle, SCI_SETTARGETSTART, startRange);
-   execute(teNppWindows::scnActiveHandle, SCI_SETTARGETEND, endRange);
    execute(teNppWindows::scnActiveHandle, SCI_SETSEARCHFLAGS, flags);
    DBG2("doFindPattern() initial tstart %d, tend %d.", startRange, endRange);
 
 
-   int targetStart = 0; // position of actual finding
-   int targetEnd = 0;   // position of actual finding
+   tiLine targetStart = 0; // position of actual finding
+   tiLine targetEnd = 0;   // position of actual finding
    int nbProcessed = 0; // number of findings
 
    if(text.length()==0) {
       // empty string is found "every where" so we return directly with 0 
       DBG0("doFindPattern() don't search: empty search string.");
       result.setDirty(false); // once through we mark the list as ready
+      result.setSearchedLength(docLength);
       return nbProcessed;
    }
-#ifdef UNICODE
-    WcharMbcsConvertor *wmc = &WcharMbcsConvertor::getInstance();
-    unsigned int cp = (unsigned int)execute(teNppWindows::scnActiveHandle, SCI_GETCODEPAGE);
-    const char *text2FindA = wmc->wchar2char(text.c_str(), cp);
-    size_t text2FindALen = strlen(text2FindA);
-    targetStart = (int)execute(teNppWindows::scnActiveHandle, SCI_SEARCHINTARGET,
-      (WPARAM)text2FindALen, 
-      (LPARAM)text2FindA);
-#else
-   targetStart = (int)execute(scnActiveHandle, SCI_SEARCHINTARGET, 
-      (WPARAM)text.size(), 
-      (LPARAM)text.c_str());
-#endif
+   // a regex containing a literal can't match where the literal is missing;
+   // if it matches within one line only the lines with the literal are searched
+   const tclLiteralFinder* pLiteral = compiled.getRequiredLiteral();
+   const tclLiteralFinder* pLineLiteral = compiled.getIsLineBound() ? pLiteral : 0;
+   if (pLiteral && _searchEngine.findLiteral(*pLiteral, startRange, endRange) == 0) {
+      DBG0("doFindPattern() required literal not found.");
+      result.setDirty(false); // once through we mark the list as ready
+      result.setSearchedLength(docLength);
+      return nbProcessed;
+   }
+   targetStart = searchInTarget(text, pLineLiteral, startRange, endRange);
    while (targetStart >= 0) // something has been found
    {   
-      if(_findDlg.getPleaseWaitCanceled()) {
+      if(isSearchCanceled()) {
          // please wait dialog indicates stopping
          DBG1("doFindPattern() cancelled! Return with %d results",nbProcessed);
          _FindProcessCancelled = true;
@@ -1110,14 +1977,14 @@ int AnalysePlugin::doFindPattern(const tclPattern& pattern, tclResult& result)
             break;
          }
       }
-      targetStart = (int)execute(teNppWindows::scnActiveHandle, SCI_GETTARGETSTART);
-      targetEnd = (int)execute(teNppWindows::scnActiveHandle, SCI_GETTARGETEND);
+      // the start is the return value of SCI_SEARCHINTARGET
+      targetEnd = (tiLine)execute(teNppWindows::scnActiveHandle, SCI_GETTARGETEND);
       if (targetEnd > endRange) {   
          // we found a result but outside our range, therefore we do not process it
          // in fact that should not happen, because we set the range before
          break;
       }
-      int foundTextLen = targetEnd - targetStart;
+      tiLine foundTextLen = targetEnd - targetStart;
 #ifdef TAGGED_MARKUP
       // TODO TAGGED_MARKUP startRange = targetStart + foundTextLen ;   //search from result onwards
       //if((flags & SCFIND_REGEXP) != 0) 
@@ -1167,31 +2034,20 @@ int AnalysePlugin::doFindPattern(const tclPattern& pattern, tclResult& result)
          }
       }
 #endif // TAGGED_MARKUP
-      int lineNumberStart = (int)execute(teNppWindows::scnActiveHandle, SCI_LINEFROMPOSITION, targetStart);
-      int lineNumberEnd = (int)execute(teNppWindows::scnActiveHandle, SCI_LINEFROMPOSITION, targetEnd);
-      int lineCount = lineNumberEnd - lineNumberStart;
-      int thisLineIndex = 0;
+      tiLine lineNumberStart = lineIndex.lineFromPosition(targetStart);
+      tiLine lineNumberEnd = lineIndex.lineFromPosition(targetEnd);
+      tiLine lineCount = lineNumberEnd - lineNumberStart;
+      tiLine thisLineIndex = 0;
       while (thisLineIndex <= lineCount) {
          DBG3("doFindPattern() found: start %d end %d line %d.", targetStart, targetEnd, lineNumberStart+thisLineIndex);
          result.push_back(targetStart, targetEnd, lineNumberStart+thisLineIndex/*, pLine*/);
          ++thisLineIndex;
       }
       startRange = targetStart + foundTextLen ;   //search from result onwards
-      execute(teNppWindows::scnActiveHandle, SCI_SETTARGETSTART, startRange);
-      // end needs to be set because search did use it to signal found selection
-      execute(teNppWindows::scnActiveHandle, SCI_SETTARGETEND, endRange);
       //DBG2("doFindPattern() tstart %d, tend %d.", startRange, endRange);
       nbProcessed++;
       // do next search
-#ifdef UNICODE
-       targetStart = (int)execute(teNppWindows::scnActiveHandle, SCI_SEARCHINTARGET,
-         (WPARAM)text2FindALen, 
-         (LPARAM)text2FindA);
-#else
-      targetStart = (int)execute(scnActiveHandle, SCI_SEARCHINTARGET, 
-         (WPARAM)text.size(), 
-         (LPARAM)text.c_str());
-#endif
+      targetStart = searchInTarget(text, pLineLiteral, startRange, endRange);
    } // while
    if(targetStart == -2) {
       _findDlg.activatePleaseWait(false);
@@ -1199,6 +2055,7 @@ int AnalysePlugin::doFindPattern(const tclPattern& pattern, tclResult& result)
       ::MessageBox(getCurrentHScintilla(teNppWindows::scnActiveHandle), TEXT("Invalid regular expression") ,serr.c_str() , MB_ICONERROR | MB_OK);
    }
    result.setDirty(false); // once through we mark the list as ready
+   result.setSearchedLength(docLength);
    if(nbProcessed == 0) {
       DBG0("doFindPattern() didn't find anything.");
    } else {
@@ -1207,6 +2064,37 @@ int AnalysePlugin::doFindPattern(const tclPattern& pattern, tclResult& result)
    return nbProcessed;
 }
 
+tiLine AnalysePlugin::searchInTarget(const std::string& text, const tclLiteralFinder* pLineLiteral, tiLine startRange, tiLine endRange)
+{
+   if (pLineLiteral == 0) {
+      // end needs to be set because search did use it to signal found selection
+      execute(teNppWindows::scnActiveHandle, SCI_SETTARGETRANGE, startRange, endRange);
+      return (tiLine)execute(teNppWindows::scnActiveHandle, SCI_SEARCHINTARGET, (WPARAM)text.size(), (LPARAM)text.c_str());
+   }
+   const tclLineIndex& lineIndex = _searchEngine.getLineIndex();
+   const char* pDoc = lineIndex.getDocument();
+   while (startRange < endRange) {
+      const char* pHit = _searchEngine.findLiteral(*pLineLiteral, startRange, endRange);
+      if (pHit == 0) {
+         break;
+      }
+      tiLine line = lineIndex.lineFromPosition((tiLine)(pHit - pDoc));
+      startRange = (std::max)(startRange, lineIndex.positionFromLine(line));
+      tiLine lineEnd = (std::min)(endRange, lineIndex.lineEndPosition(line));
+      execute(teNppWindows::scnActiveHandle, SCI_SETTARGETRANGE, startRange, lineEnd);
+      tiLine found = (tiLine)execute(teNppWindows::scnActiveHandle, SCI_SEARCHINTARGET, (WPARAM)text.size(), (LPARAM)text.c_str());
+      if (found != -1) {
+         // a match or -2 for an invalid expression
+         return found;
+      }
+      if (line + 1 >= lineIndex.getLineCount()) {
+         break;
+      }
+      startRange = lineIndex.positionFromLine(line + 1);
+   }
+   return -1;
+}
+
 //void AnalysePlugin::doStyleFormating(HWND hCurrentEditView, int /*startPos*/, int /*endPos*/) 
 //{
 //   // get the result list, including all positions 
@@ -29,7 +29,12 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "DockingFeature/FindDlg.h"
 #include "tclFindResultDoc.h"
 #include "tclFindResultDlg.h"
+#include "tclSearchEngine.h"
+#include "tclBatchAnalyser.h"
+#include "tclSearchTask.h"
 #include <string.h>
+#include <list>
+#include <vector>
 #include "MyPlugin.h"
 #include "HelpDialog.h"
 #include "ScintillaSearchView.h"
@@ -46,6 +51,16 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #define NUM_CUSTOM_COLORS 16
 // allow longer paths as old winnt coding 
 #define AP_MAX_PATH 1024
+// memory the results of the buffers not shown may take until the least
+// recently used ones are dropped
+#define AP_SESSION_MEMORY_BUDGET (256*1024*1024)
+// a search step on the UI thread ends after the pattern being searched
+// when it took that long, so the editor gets its messages in between
+#define AP_SEARCH_STEP_MS 50
+// bytes of the document copied for the search thread per step
+#define AP_SEARCH_COPY_SLICE (32*1024*1024)
+// the please wait dialog is asked that often whether to cancel the search
+#define AP_CANCEL_POLL_MS 100
 
 #define vstr(a) __vstr(a)
 #define __vstr(a) #a
@@ -58,6 +73,7 @@ enum tePluginFuncId {
    SEP1,
    ADDSELTOPATT,
    RUNSEARCH,
+   ANALYSEDISKFILE,
    SEP2,
 #ifdef CONFIG_DIALOG
    SHOWCNFGDLG,
@@ -69,7 +85,7 @@ enum tePluginFuncId {
 /**
  * this is the plugin interface to notepad 
  */
-class AnalysePlugin : public MyPlugin
+class AnalysePlugin : public MyPlugin, public tclSearchHost
 {
 public:
 
@@ -84,6 +100,13 @@ public:
       , _maxNbCharAllocated(0)
       ,_FindProcessCancelled(false)
       ,_bIgnoreBufferModify(false)
+      , _activeBufferId(0)
+      , _resultBufferId(0)
+      , _resultDocLength(0)
+      , _resultDocHash(0)
+      , _bResultDocHash(false)
+      , _sessionMemSize(0)
+      , _searchRunCount(0)
 //      , mResultFontSize(0)
       , _nppBookmarkId(MARK_BOOKMARK_OLD)
    
@@ -93,6 +116,8 @@ public:
       memset(_szPluginFileName, 0, sizeof(_szPluginFileName));
       _findDlg.setParent(this);
       _findResult.setParent(this);
+      _searchEngine.setHost(this);
+      _searchEngine.setCancelToken(&_searchCancel);
 
       _VersionString = TEXT("Analyse Plugin ");
       _VersionString += TEXT(vstr(VER_FILEVERSION_MAYOR));
@@ -114,6 +139,9 @@ public:
    }
 
    virtual ~AnalysePlugin() {
+      // the scan still running stops before the members it uses are gone
+      _searchCancel.cancel();
+      _searchTask.wait();
       if (_line) {
          delete [] _line;
          _line = 0;
@@ -130,6 +158,8 @@ public:
    void showConfigDialog();
    void addSelectionToPatterns();
    void runSearch();
+   /** ask for a file and search it on disk without loading it */
+   void analyseDiskFile();
 
    bool isVisible() const {
       return _findDlg.isVisible();
@@ -176,8 +206,19 @@ public:
    virtual void moveResult(tPatId oldPattId, tPatId newPattId);
 
    virtual BOOL doSearch(tclResultList& resultList);
+   virtual void continueSearch(unsigned id);
+   virtual void cancelSearch();
+   /**
+   * search the file without loading it into the editor; the result window
+   * gets the found lines and a double click opens the file. the file is
+   * searched on _searchTask, the found lines are put into the result
+   * window in steps of continueSearch() afterwards
+   */
+   BOOL doSearchDiskFile(tclResultList& resultList, const generic_string& fileName);
    virtual BOOL doFindTestCaseFromDb(tclResultList& resultList);
-   virtual bool bCheckLastFileNameSame(generic_string& file);
+   virtual bool getIsResultOfActiveDoc() const {
+      return (_resultBufferId != 0) && (_resultBufferId == _activeBufferId);
+   }
 
    virtual void visibleChanged(bool isVisible);
    virtual teOnEnterAction getOnEnterAction() const;
@@ -221,6 +262,7 @@ public:
    // whenever the search patterns have been changed we want to update the find dialog
    void updateSearchPatterns()
    {
+      cancelSearch();
       _findResult.setSearchPatterns(_findDlg.getPatternList());
    }
 
@@ -263,7 +305,171 @@ protected:
    generic_string getCustomColorsStr();
    generic_string convertExtendedToString(const generic_string& query);
    bool readBase(const generic_string& str, int curPos, int * value, int base, int size) ;
-   int doFindPattern(const tclPattern& pattern, tclResult& result);
+   /**
+   * search one pattern with scintilla; the matches between startRange
+   * and endRange are appended to result. endRange < 0 is the document end
+   */
+   int doFindPattern(const tclPattern& pattern, tclResult& result, tiLine startRange = 0, tiLine endRange = -1);
+
+   /**
+   * SCI_SEARCHINTARGET from startRange to endRange. with pLineLiteral only
+   * the lines containing the literal are searched; the pattern must not
+   * match across lines then.
+   */
+   tiLine searchInTarget(const std::string& text, const tclLiteralFinder* pLineLiteral, tiLine startRange, tiLine endRange);
+
+   /**
+   * hand over the actual document and its word settings to the search engine
+   * bTextModified is set if the modifications since last search are known
+   */
+   void prepareSearchEngine(bool bTextModified = false);
+
+   /**
+   * copy the next slice of the document into _searchCopy and start the scan
+   * after the last one; the search is cancelled if the document has been
+   * modified or switched in between
+   */
+   void copySearchSlice();
+
+   /** put the dirty patterns found by the search engine so far into the result window */
+   void insertEngineResults();
+
+   /**
+   * the search engine gets the document back from _searchCopy once the scan
+   * is done; the search is cancelled if the buffer has changed meanwhile
+   */
+   void releaseSearchCopy();
+
+   /** report the regular expressions the search engine failed with */
+   void showEngineErrors();
+
+   /**
+   * put the positions of result from index first on into the result window
+   * with their line texts out of the document of lineIndex.
+   * returns the count of lines added to the result window
+   */
+   unsigned insertResultLines(tPatId patId, const tclPattern& pattern, const tclResult& result, unsigned first,
+                          const tclLineIndex& lineIndex, unsigned cp, unsigned commentWidth);
+
+   /** width of the line number column for the count of lines */
+   static int getLineNumColSize(tiLine iNumLines);
+
+   /**
+   * true if all dirty patterns only match inside a line, so that only
+   * the modified lines have to be searched again
+   */
+   bool getIsRangeSearchable(const tclResultList& resultList) const;
+
+   /**
+   * remove the results between from and to of the modified document and
+   * move those behind to by the modification in _docEdit
+   */
+   void shiftResults(tclResultList& resultList, tiLine from, tiLine to);
+
+   /**
+   * the search started by doSearch(). the literals and regular expressions
+   * are scanned on _searchTask while the editor goes on; the other patterns
+   * and the result window are done on the UI thread in steps of 
+   * continueSearch(), the patterns scanned completely already during the scan
+   */
+   struct tstSearchRun {
+      tstSearchRun()
+         : bActive(false), bInStep(false), bCopying(false), bScanTask(false), bScanDone(false), bDiskFile(false)
+         , id(0), pList(0), pDoc(0), docHash(0), bDocHash(false)
+         , from(0), to(-1), commentWidth(0), bBulkUpdate(false), patIndex(0)
+      {}
+      bool bActive;
+      bool bInStep;           // continueSearch() is running
+      bool bCopying;          // _searchCopy is being taken
+      bool bScanTask;         // the scan runs on _searchTask
+      bool bScanDone;         // engineResults are collected
+      bool bDiskFile;         // a file on disk is searched, see _pDiskRun
+      unsigned id;            // of the step messages; those of former runs are dropped
+      tclResultList* pList;
+      const char* pDoc;       // buffer of the document searched
+      uint64_t docHash;       // of the copy, taken on _searchTask after the scan
+      bool bDocHash;
+      tiLine from;            // range searched
+      tiLine to;
+      unsigned commentWidth;
+      bool bBulkUpdate;
+      tclResultList::iterator iNext; // next pattern to search
+      int patIndex;           // of iNext, 1 based as the progress
+      tclResultList::tlmResult engineResults;
+   };
+
+   /**
+   * the file searched on disk by _searchTask with copies of the patterns, 
+   * so the result list may be changed meanwhile
+   */
+   struct tstDiskRun {
+      tclMappedFile file;
+      const char* pDoc;       // behind the byte order mark
+      tiLine length;
+      tclResultList list;
+      tclBatchAnalyser analyser;
+   };
+
+   /** search the dirty pattern of iResult and put its lines into the result window */
+   void searchPattern(tclResultList::iterator iResult);
+
+   /** a step of doSearchDiskFile() after the file has been searched */
+   void continueDiskSearch();
+
+   /** the same as finishSearch() for doSearchDiskFile() */
+   void finishDiskSearch(bool bCancelled);
+
+   /** update the result window and the state of the search after the last step */
+   void finishSearch(bool bCancelled);
+   std::string getCharsOfClass(int sciMsg);
+
+   /**
+   * the result of an editor buffer put aside while another one is shown.
+   * it is valid as long as the patterns search the same and the document
+   * has the same content as when it was searched
+   */
+   struct tstSession {
+      UINT_PTR bufferId;
+      generic_string fileName;
+      tiLine docLength;
+      uint64_t docHash;       // see _resultDocHash
+      bool bDocHash;
+      tclPatternList patterns;
+      tclResultList::tlmResult results;
+      tclFindResultDlg::tstResultView view;
+      size_t memSize;
+   };
+   typedef std::list<tstSession> tllSession;
+
+   /** the active buffer became another one */
+   void bufferActivated(UINT_PTR bufferId);
+
+   /**
+   * put the result shown for _resultBufferId aside as a session and empty
+   * the result window. returns false if the result belongs to no buffer
+   * and stays in the window
+   */
+   bool saveSession();
+
+   /** show the session of bufferId if there is a valid one */
+   bool restoreSession(UINT_PTR bufferId);
+
+   /** remove the session of bufferId */
+   void eraseSession(UINT_PTR bufferId);
+   void eraseSession(tllSession::iterator iSession);
+
+   /** true if the session still fits to the document and the patterns */
+   bool getIsSessionValid(const tstSession& session) const;
+
+   /** content hash of the document in the active view */
+   uint64_t getActiveDocHash() const;
+
+   /** full path of the buffer as shown in the result headline */
+   generic_string getBufferFileName(UINT_PTR bufferId) const;
+
+   // tclSearchHost interface used by _searchEngine
+   virtual bool isRangeWord(tiLine start, tiLine end);
+   virtual bool isSearchCanceled();
 
    /**
    * return the actually marked line
@@ -312,6 +518,7 @@ protected:
    static const TCHAR KEYCUSTOMCOLORS[];
    static const TCHAR KEYORDERNUMHIDECOLWIDTH[];
    static const TCHAR KEYWARNFOROLDNPPVERDONE[];
+   static const TCHAR KEYHIGHLIGHTINEDITOR[];
    static const TCHAR SECTIONNAME[];
    static const TCHAR LOCALCONFFILE[];
    static const TCHAR ANALYSE_INIFILE[];
@@ -339,6 +546,11 @@ protected:
    /** demo dialog */
    //GoToLineDlg _goToLineDlg;
    tclFindResultDlg _findResult;
+   tclCancelToken _searchCancel;    // stops the search running
+   tclSearchEngine _searchEngine;
+   tclSearchTask _searchTask;       // scans with _searchEngine, so it is stopped before
+   std::vector<char> _searchCopy;   // document scanned by _searchTask
+   std::unique_ptr<tstDiskRun> _pDiskRun; // file searched by _searchTask
    HelpDlg _helpDlg;
    ConfigDialog _configDlg;
 
@@ -367,6 +579,17 @@ protected:
    size_t _maxNbCharAllocated;
    bool _FindProcessCancelled;
    bool _bIgnoreBufferModify;
+   tclEditRange _docEdit; // text modifications since last search
+   UINT_PTR _activeBufferId;  // buffer in the active editor view
+   UINT_PTR _resultBufferId;  // buffer of the shown result or 0
+   tiLine _resultDocLength;   // length of the document of _resultBufferId
+   uint64_t _resultDocHash;   // content hash of that document at the end of its search
+   bool _bResultDocHash;      // false after modifications not searched yet
+   tllSession _sessions;      // most recently used first
+   size_t _sessionMemSize;    // memory of all _sessions
+   tstSearchRun _searchRun;   // the search started by doSearch()
+   unsigned _searchRunCount;  // ids of the search runs
+   tclStopWatch _cancelPollWatch; // since the please wait dialog was asked last
    // LexAnalyseResult mLex;
    static COLORREF _acrCustClr[NUM_CUSTOM_COLORS];
 //   HWND mCurScnHandle = NULL;
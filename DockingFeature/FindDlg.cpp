@@ -161,16 +161,17 @@ void FindDlg::doSearch() {
          }
       };
    }
-   // start search
-   _pParent->doSearch(mResultList);
-   mTableView.setHitsRowVisible(true, mResultList);
-   // set the modification notification for this window if not already on
+   // set the modification notification for this window if not already on;
+   // the search gets cancelled before the text is modified
+   const int modMask = SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT | SC_MOD_BEFOREINSERT | SC_MOD_BEFOREDELETE;
    int mode = (int)_pParent->execute(teNppWindows::scnActiveHandle,SCI_GETMODEVENTMASK);
-   if ((mode & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT)) != (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT)) {
+   if ((mode & modMask) != modMask) {
       DBG1("FindDlg: editor notification mode was not ok: mode=%d add insert text and delete text", mode);
-      mode |= (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT);
+      mode |= modMask;
       _pParent->execute(teNppWindows::scnActiveHandle,SCI_SETMODEVENTMASK, mode);
    }
+   // start search; the hits are shown in the table when it is done
+   _pParent->doSearch(mResultList);
 }
 
 void FindDlg::handleDropped(HDROP hDropInfo) {
@@ -297,10 +298,21 @@ INT_PTR CALLBACK FindDlg::run_dlgProc(UINT message, WPARAM wParam, LPARAM lParam
          setNumOfCfgFiles((unsigned int)wParam);
          break;
       }
+   case APN_MSG_CANCEL_FIND:
+      {
+         // cancel pressed in the please wait dialog between two search steps
+         _pParent->cancelSearch();
+         return TRUE;
+      }
    case WM_COMMAND : 
       {
          switch (wParam)
          {
+         case IDC_DO_SEARCH_STEP:
+            {
+               _pParent->continueSearch((unsigned)lParam);
+               return TRUE;
+            }
          case IDCANCEL:
          {
             DBG0("ESCAPE");
@@ -345,7 +357,8 @@ INT_PTR CALLBACK FindDlg::run_dlgProc(UINT message, WPARAM wParam, LPARAM lParam
          case IDC_DO_RESEARCH :
             {
                DBG0("IDC_DO_RESEARCH");
-               setAllDirty();
+               // plugin decides in doSearch() if the kept range is still valid
+               setAllDirty(true);
                doSearch();
                // finally set focus to editor window
                ::SetFocus(_pParent->getCurrentHScintilla(teNppWindows::scnActiveHandle));
@@ -154,12 +154,20 @@ public :
    void setAllDoSearch(bool bOn) ;
    void setGroupDoSearch(const generic_string& group, bool bEnable);
 
-   void setAllDirty() 
+   /**
+   * bTextModified keeps the searched range of the results, used when
+   * only the text of the document has been modified
+   */
+   void setAllDirty(bool bTextModified = false) 
    {
       // make sure found patterns become rechecked
       tclResultList::iterator iResult = mResultList.begin();
       for (; iResult != mResultList.end(); ++iResult) {
-         iResult.refResult().setDirty();
+         if (bTextModified) {
+            iResult.refResult().setTextDirty();
+         } else {
+            iResult.refResult().setDirty();
+         }
       }
    }
 
@@ -256,6 +264,14 @@ public :
    tclPatternList& refPatternList() {
       return mResultList;
    }
+   tclResultList& refResultList() {
+      return mResultList;
+   }
+
+   /** show hits and search times of the last search in the table */
+   void showSearchStats() {
+      mTableView.setHitsRowVisible(true, mResultList);
+   }
    
    /**
    * same as moveResult() but for the patterns
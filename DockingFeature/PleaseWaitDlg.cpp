@@ -25,7 +25,6 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 //#include "../PowerEditor/src/resource.h"
 //#define NOTEPADPLUS_USER_INTERNAL     (WM_USER + 0000)
 //#define NPPM_INTERNAL_CANCEL_FIND_IN_FILES		(NOTEPADPLUS_USER_INTERNAL + 24)
-#define APN_MSG_CANCEL_FIND WM_USER + 24
 
 DWORD WINAPI AsyncPleaseWaitFunc(LPVOID phWnd) {
    ::Sleep(1000); // wait a bit before showing the popup 
@@ -33,7 +32,7 @@ DWORD WINAPI AsyncPleaseWaitFunc(LPVOID phWnd) {
    TaskDialog(NULL, NULL,
       TEXT("Analyse Plugin"),
       TEXT("Finding patterns ..."),
-      TEXT("Press [cancel] to stop search at next pattern."),
+      TEXT("Press [cancel] to stop the search."),
       TDCBF_CANCEL_BUTTON,
       TD_INFORMATION_ICON,
       &nButtonPressed);
@@ -22,6 +22,9 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "windows.h"
 
+// posted to the window of the dialog when the search shall stop
+#define APN_MSG_CANCEL_FIND WM_USER + 24
+
 class PleaseWaitDlg {
 public:
    PleaseWaitDlg(HWND hSelf);
@@ -130,7 +130,9 @@
 #define IDC_SHOW_OPTIONS                3015
 #define IDC_DO_SAVCFG_HITS              3016
 #define IDC_RESET_TABLE_COLS            3017
+#define IDS_ANALYSEDISKFILE             3018
 #define IDC_DO_UPDATE_SCROLL            5003
+#define IDC_DO_SEARCH_STEP              5004
 #define IDC_RADIO_DIRUP                 20405
 #define IDC_RADIO_DIRDOWN               20406
 #define IDC_COUNT                       20408
@@ -141,8 +143,8 @@
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
-#define _APS_NEXT_RESOURCE_VALUE        3018
-#define _APS_NEXT_COMMAND_VALUE         5004
+#define _APS_NEXT_RESOURCE_VALUE        3019
+#define _APS_NEXT_COMMAND_VALUE         5005
 #define _APS_NEXT_CONTROL_VALUE         1123
 #define _APS_NEXT_SYMED_VALUE           6003
 #endif
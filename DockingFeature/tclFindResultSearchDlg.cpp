@@ -31,14 +31,15 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "myDebug.h"
 
 
-void tclFindResultSearchDlg::init(HINSTANCE hInst, HWND hPere, ScintillaSearchView* pSearchResultView) 
+void tclFindResultSearchDlg::init(HINSTANCE hInst, HWND hPere, ScintillaSearchView* pSearchResultView, tclResultPager* pPager) 
 {
    Window::init(hInst, hPere);
-   if (!pSearchResultView){
+   if (!pSearchResultView || !pPager){
       MessageBox( NULL, TEXT("System Error no scintilla pointer"), TEXT("tclFindResultSearchDlg ERROR : "), MB_OK | MB_ICONSTOP);
       throw int(9900);
    }
    _pSearchResultView = pSearchResultView;
+   _pPager = pPager;
 }
 
 void tclFindResultSearchDlg::create(int dialogID, bool isRTL) 
@@ -109,21 +110,17 @@ void tclFindResultSearchDlg::updatePatternList() {
    }
 }
 
-int tclFindResultSearchDlg::doFindText(int start, int end/*, bool bDownWards*/) {
-   if(_pSearchResultView==0) {
-      DBG0("doFindText() ERROR no searchresult window");
-      return -1;
-   }
+bool tclFindResultSearchDlg::setFindText() {
    tclPattern p;
    p.setWholeWord(BST_CHECKED==::SendDlgItemMessage(_hSelf, IDC_CHK_WHOLE_WORD, BM_GETCHECK, 0, 0));
    p.setMatchCase(BST_CHECKED==::SendDlgItemMessage(_hSelf, IDC_CHK_MATCH_CASE, BM_GETCHECK, 0, 0));
    p.setSearchText(_CmbSearchText.getTextFromCombo(false));
    p.setSearchTypeStr(_CmbSearchType.getTextFromCombo(false));
    if(p.getSearchText().length()==0) {
-      // empty string is found "every where" so we return directly with 0 
-      DBG0("doFindText() don't search: empty search string.");
+      // empty string is found "every where" so we return directly
+      DBG0("setFindText() don't search: empty search string.");
       ::MessageBox(_hSelf, TEXT("Search string empty!"), TEXT("Find in Result"), MB_OK);
-      return -1;
+      return false;
    }
    // add text to history
    _CmbSearchText.addText2Combo(_CmbSearchText.getTextFromCombo(false).c_str(), false);
@@ -135,25 +132,32 @@ int tclFindResultSearchDlg::doFindText(int start, int end/*, bool bDownWards*/)
    flags |= p.getIsMatchCase()?SCFIND_MATCHCASE:0;
    flags |= p.getIsWholeWord()?SCFIND_WHOLEWORD:0;
    _pSearchResultView->execute(SCI_SETSEARCHFLAGS, flags);
-   // set search area
-   _pSearchResultView->execute(SCI_SETTARGETSTART, start);
-   _pSearchResultView->execute(SCI_SETTARGETEND, end);
-
-   int targetStart=-1;
 #ifdef UNICODE
    WcharMbcsConvertor *wmc = &WcharMbcsConvertor::getInstance();
    unsigned int cp = (unsigned int)_pSearchResultView->execute(SCI_GETCODEPAGE); 
-   const char *text2FindA = wmc->wchar2char(p.getSearchText().c_str(), cp);
-   size_t text2FindALen = strlen(text2FindA);
-   targetStart = (int)_pSearchResultView->execute(SCI_SEARCHINTARGET, 
-      (WPARAM)text2FindALen, 
-      (LPARAM)text2FindA);
+   mFindText = wmc->wchar2char(p.getSearchText().c_str(), cp);
 #else
-   targetStart = (int)_pSearchResultView->execute(SCI_SEARCHINTARGET, 
-      (WPARAM)p.getSearchText().size(), 
-      (LPARAM)p.getSearchText().c_str());
+   mFindText = p.getSearchText();
 #endif
-   return targetStart;
+   return true;
+}
+
+int tclFindResultSearchDlg::doFindText(int start, int end/*, bool bDownWards*/) {
+   if(_pSearchResultView==0) {
+      DBG0("doFindText() ERROR no searchresult window");
+      return -1;
+   }
+   // set search area, the flags are set by setFindText()
+   _pSearchResultView->execute(SCI_SETTARGETSTART, start);
+   _pSearchResultView->execute(SCI_SETTARGETEND, end);
+   return (int)_pSearchResultView->execute(SCI_SEARCHINTARGET, 
+      (WPARAM)mFindText.size(), 
+      (LPARAM)mFindText.c_str());
+}
+
+int tclFindResultSearchDlg::doFindInPage(bool bSearchDown) {
+   int length = (int)_pSearchResultView->execute(SCI_GETLENGTH);
+   return bSearchDown ? doFindText(0, length) : doFindText(length-1, 0);
 }
 
 void tclFindResultSearchDlg::doFindFirst() {
@@ -162,19 +166,23 @@ void tclFindResultSearchDlg::doFindFirst() {
       DBG0("doFindFirst() ERROR no searchresult window");
       return;
    }
-   int startRange = 0; // from very begin
-   int endRange = (int)_pSearchResultView->execute(SCI_GETLENGTH);
-   if (endRange < 1) {
+   if (_pSearchResultView->execute(SCI_GETLENGTH) < 1) {
       DBG0("doFindFirst() don't search: document is empty.");
       ::MessageBox(_hSelf, TEXT("Result window empty!"), TEXT("Find in Result"), MB_OK);
       // nothing to do because that means the document is empty
       return; 
    } 
-   //Initial range for searching
-   DBG2("doFindFirst() initial tstart %d, tend %d.", startRange, endRange);
-
-   // search the pattern
-   startRange = doFindText(startRange, endRange);
+   if (!setFindText()) {
+      return;
+   }
+   // search the pattern from the very begin page by page
+   _pPager->beginPageSearch();
+   _pPager->showFirstPage(true);
+   int startRange = doFindInPage(true);
+   while (startRange == -1 && _pPager->showNextPage(true)) {
+      startRange = doFindInPage(true);
+   }
+   _pPager->endPageSearch(startRange != -1);
    if(startRange != -1) {
       int targetEnd = (int)_pSearchResultView->execute(SCI_GETTARGETEND);
       markFoundText(startRange, targetEnd);
@@ -223,20 +231,27 @@ void tclFindResultSearchDlg::doFindNext(bool bSearchDown, bool bDoWrap) {
       // nothing to do because that means the document is empty
       return; 
    } 
+   if (!setFindText()) {
+      return;
+   }
    int startRange = bSearchDown ? anchor : anchor-1; // up has to search backw. so start before last char
    int endRange = bSearchDown ? length:0;
    //Initial range for searching
    DBG2("doFindNext() with tstart %d, tend %d.", startRange, endRange);
-   // search the pattern
+   // search the pattern in the window and then in the pages behind it
+   _pPager->beginPageSearch();
    startRange = doFindText(startRange, endRange);
+   while (startRange == -1 && _pPager->showNextPage(bSearchDown)) {
+      startRange = doFindInPage(bSearchDown);
+   }
    if((startRange == -1) && bDoWrap) {
-      if(bSearchDown) {
-         startRange = 0;
-      } else {
-         startRange = length-1;
+      _pPager->showFirstPage(bSearchDown);
+      startRange = doFindInPage(bSearchDown);
+      while (startRange == -1 && _pPager->showNextPage(bSearchDown)) {
+         startRange = doFindInPage(bSearchDown);
       }
-      startRange = doFindText(startRange, endRange);
    }
+   _pPager->endPageSearch(startRange != -1);
    if(startRange != -1) {
       int targetEnd = (int)_pSearchResultView->execute(SCI_GETTARGETEND);
       markFoundText(startRange, targetEnd);
@@ -255,19 +270,24 @@ void tclFindResultSearchDlg::doCount() {
       DBG0("doCount() ERROR no searchresult window");
       return;
    }
-   int startRange = 0; // from very begin
-   int endRange = (int)_pSearchResultView->execute(SCI_GETLENGTH);
-   if (endRange < 1) {
+   if (_pSearchResultView->execute(SCI_GETLENGTH) < 1) {
       DBG0("doCount() don't search: document is empty.");
       // nothing to do because that means the document is empty
-   } else {
-      while (startRange >= 0) {
-         startRange = doFindText(startRange, endRange);
-         if (startRange >= 0){
-            startRange = (int)_pSearchResultView->execute(SCI_GETTARGETEND);
-            iCount++;
-         }
-      } // while
+   } else if (setFindText()) {
+      _pPager->beginPageSearch();
+      _pPager->showFirstPage(true);
+      do {
+         int startRange = 0; // from very begin of the page
+         int endRange = (int)_pSearchResultView->execute(SCI_GETLENGTH);
+         while (startRange >= 0) {
+            startRange = doFindText(startRange, endRange);
+            if (startRange >= 0){
+               startRange = (int)_pSearchResultView->execute(SCI_GETTARGETEND);
+               iCount++;
+            }
+         } // while
+      } while (_pPager->showNextPage(true));
+      _pPager->endPageSearch(false);
    }
    TCHAR* text = TEXT(" instances found.");
    TCHAR msg[100];
@@ -29,12 +29,33 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 //#include <string>
 #include "tclPatternList.h"
 
+// lines put into the result window at once while searching through it
+#define FNDRESDLG_SEARCH_PAGE_LINES 10000
+
+/**
+* the result window only holds the visible part of the result; for searching
+* through all of it the lines are put into the window page by page
+*/
+class tclResultPager {
+public:
+   virtual ~tclResultPager() {}
+   /** remember the view to go back to if nothing is found */
+   virtual void beginPageSearch() = 0;
+   /** show the first page, or the last one when searching upwards */
+   virtual void showFirstPage(bool bDown) = 0;
+   /** show the page following the window; false at the end of the result */
+   virtual bool showNextPage(bool bDown) = 0;
+   /** the found text stays in the window, otherwise the view is restored */
+   virtual void endPageSearch(bool bFound) = 0;
+};
+
 class tclFindResultSearchDlg : public StaticDialog
 {
 public :
    tclFindResultSearchDlg() 
       : StaticDialog()
       ,_pSearchResultView(0)
+      ,_pPager(0)
       ,_bSearchDown(true)
       ,_bDoWrap(true)
       ,mhlvPatterns(0)
@@ -42,7 +63,7 @@ public :
       ,mpPattDist(POINT())
    {}
 
-   void init(HINSTANCE hInst, HWND hPere, ScintillaSearchView* pSearchResultView);
+   void init(HINSTANCE hInst, HWND hPere, ScintillaSearchView* pSearchResultView, tclResultPager* pPager);
 
    virtual void create(int dialogID, bool isRTL = false);
 
@@ -55,8 +76,14 @@ public :
 
    void updatePatternList() ;
    
+   /** take the search settings of the dialog; false if there is no text */
+   bool setFindText() ;
+
    int doFindText(int start, int end/*, bool bDownWards*/) ;
 
+   /** search the whole text in the window */
+   int doFindInPage(bool bSearchDown) ;
+
    void doFindFirst() ;
 
    void markFoundText(int targetStart, int targetEnd) ;
@@ -76,6 +103,8 @@ protected :
    tclComboBoxCtrl _CmbSearchType;
    tclComboBoxCtrl _CmbSearchDir;
    ScintillaSearchView* _pSearchResultView;
+   tclResultPager* _pPager;
+   std::string mFindText; // in the code page of the result window
    bool _bSearchDown;
    bool _bDoWrap;
    HWND mhlvPatterns;
@@ -23,29 +23,6 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "tclPattern.h"
 
-#define FNDDOC_XMLNS TEXT("xmlns:xsi")
-#define FNDDOC_XMLNS_VALUE TEXT("http://www.w3.org/2001/XMLSchema-instance") 
-#define FNDDOC_XSD_LOCATION TEXT("xsi:noNamespaceSchemaLocation")
-#define FNDDOC_XSD_LOCATION_VALUE TEXT("./AnalyseDoc.xsd")
-#define FNDDOC_ANALYSE_DOC TEXT("AnalyseDoc")
-#define FNDDOC_HEADLINE TEXT("Headline")  // on even w/o FEATURE_HEADLINE to be able to read the doc
-#define FNDDOC_SEARCH_TEXT TEXT("SearchText")
-#define FNDDOC_SEARCH_TYPE TEXT("searchType")
-#define FNDDOC_DO_SEARCH TEXT("doSearch")
-#define FNDDOC_MATCHCASE TEXT("matchCase") 
-#define FNDDOC_WHOLEWORD TEXT("wholeWord") 
-#define FNDDOC_SELECT TEXT("select")
-#define FNDDOC_HIDE TEXT("hide")
-#define FNDDOC_BOLD TEXT("bold")
-#define FNDDOC_ITALIC TEXT("italic")
-#define FNDDOC_UNDERLINED TEXT("underlined")
-#define FNDDOC_COLOR TEXT("color")
-#define FNDDOC_BGCOLOR TEXT("bgColor")
-#define FNDDOC_COMMENT TEXT("comment")
-#define FNDDOC_GROUP TEXT("group")
-#define FNDDOC_HITS TEXT("hits")
-#define FNDDOC_ORDER_NUM TEXT("orderNum")
-
 FindConfigDoc::FindConfigDoc(const TCHAR * filename)
    : mDoc(0)
 {
@@ -292,6 +269,16 @@ bool FindConfigDoc::writePatternHitsList(tclResultList& rl) {
             e = n->ToElement();
             bRet2 = true;
             e->SetAttribute(FNDDOC_HITS, u);
+            // costs of the last search, times in ms
+            const tstSearchStats& stats = rr.getStats();
+            TCHAR num[40];
+            generic_sprintf(num, TEXT("%.3f"), stats.searchMs);
+            e->SetAttribute(FNDDOC_SEARCH_TIME, num);
+            generic_sprintf(num, TEXT("%.3f"), stats.insertMs);
+            e->SetAttribute(FNDDOC_INSERT_TIME, num);
+            generic_sprintf(num, TEXT("%.0f"), (double)stats.bytes);
+            e->SetAttribute(FNDDOC_SEARCHED_BYTES, num);
+            e->SetAttribute(FNDDOC_RESULT_LINES, (int)stats.lines);
             n = n->NextSiblingElement();
          }
       }
@@ -24,6 +24,34 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "chardefines.h"
 
 
+// element and attribute names of the configuration file
+#define FNDDOC_XMLNS TEXT("xmlns:xsi")
+#define FNDDOC_XMLNS_VALUE TEXT("http://www.w3.org/2001/XMLSchema-instance") 
+#define FNDDOC_XSD_LOCATION TEXT("xsi:noNamespaceSchemaLocation")
+#define FNDDOC_XSD_LOCATION_VALUE TEXT("./AnalyseDoc.xsd")
+#define FNDDOC_ANALYSE_DOC TEXT("AnalyseDoc")
+#define FNDDOC_HEADLINE TEXT("Headline")  // on even w/o FEATURE_HEADLINE to be able to read the doc
+#define FNDDOC_SEARCH_TEXT TEXT("SearchText")
+#define FNDDOC_SEARCH_TYPE TEXT("searchType")
+#define FNDDOC_DO_SEARCH TEXT("doSearch")
+#define FNDDOC_MATCHCASE TEXT("matchCase") 
+#define FNDDOC_WHOLEWORD TEXT("wholeWord") 
+#define FNDDOC_SELECT TEXT("select")
+#define FNDDOC_HIDE TEXT("hide")
+#define FNDDOC_BOLD TEXT("bold")
+#define FNDDOC_ITALIC TEXT("italic")
+#define FNDDOC_UNDERLINED TEXT("underlined")
+#define FNDDOC_COLOR TEXT("color")
+#define FNDDOC_BGCOLOR TEXT("bgColor")
+#define FNDDOC_COMMENT TEXT("comment")
+#define FNDDOC_GROUP TEXT("group")
+#define FNDDOC_HITS TEXT("hits")
+#define FNDDOC_SEARCH_TIME TEXT("searchTime")
+#define FNDDOC_INSERT_TIME TEXT("insertTime")
+#define FNDDOC_SEARCHED_BYTES TEXT("searchedBytes")
+#define FNDDOC_RESULT_LINES TEXT("resultLines")
+#define FNDDOC_ORDER_NUM TEXT("orderNum")
+
 class TiXmlDocument;
 class TiXmlDocumentA;
 
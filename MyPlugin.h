@@ -26,11 +26,11 @@ interface for my plugin known to the dock window
 #include <string>
 #include "chardefines.h"
 #include "Common.h"
+#include "tclPosInfo.h"
 
 class tclResultList;
 class tclResult;
 //typedef int tiIndex; // index of the pattern applied
-typedef double tPatId;// new id of the pattern applied
 // typedef int tiLine;  // number of the line of the found entry start in main window
 enum teOnEnterAction;
 
@@ -107,8 +107,18 @@ public:
    * activates the search on the given result list.
    * this will cause the plugin to check which patterns in the resultlist have to 
    * be updated and activates the repaint of the different windows.
+   * it returns before the search is done, see continueSearch().
    */
    virtual BOOL doSearch(tclResultList& resultList) =0;
+
+   /**
+   * the search started by doSearch() goes on in steps; each step is
+   * triggered by an IDC_DO_SEARCH_STEP command with the id of the search
+   */
+   virtual void continueSearch(unsigned id) =0;
+
+   /** stop the search started by doSearch() if it still runs */
+   virtual void cancelSearch() =0;
    virtual BOOL doFindTestCaseFromDb(tclResultList& resultList) = 0;
    
    virtual void runSearch() = 0;
@@ -123,9 +133,10 @@ public:
    virtual void setSearchFileName(const generic_string& file) =0;
 
    /**
-   * report if file name changed in meantime
+   * true if the result window shows the result of the document active
+   * in the editor
    */
-   virtual bool bCheckLastFileNameSame(generic_string& file) =0;
+   virtual bool getIsResultOfActiveDoc() const =0;
 
    /**
    * function is called as notification that the plugin has been switched off by
@@ -24,14 +24,6 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <vector>
 #include "ScintillaEditView.h"
 
-#define RTF_COLTAG_RED "\n\\red" // red
-#define RTF_COLTAG_GREEN "\\green" // green
-#define RTF_COLTAG_BLUE "\\blue"  // blue
-#define RTF_COLTAG_END ";" 
-#define RTF_COL_R(r) ((BYTE)(r)) // mask char
-#define RTF_COL_G(g) ((BYTE)(g>>8)) // mask short
-#define RTF_COL_B(b) ((BYTE)(b>>16)) // mask third byte
-
 #define MY_STYLE_MASK 0xff  // 8 bits https://www.scintilla.org/ScintillaDoc.html#StyleDefinition
 #define MY_STYLE_BITS 8    
 
@@ -49,6 +41,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #define FNDRESDLG_SHOW_OPTIONS             (FNDRESDLG_BASE + 7)
 #define FNDRESDLG_SHOW_CONTEXTMENU         (FNDRESDLG_BASE + 8)
 #define FNDRESDLG_ACTIVATE_PATTERN_LIST    (FNDRESDLG_BASE + 9)
+#define FNDRESDLG_SCINTILLAFINFER_SAVE_HTML (FNDRESDLG_BASE + 10)
+#define FNDRESDLG_SCINTILLAFINFER_SAVE_CSV (FNDRESDLG_BASE + 11)
 #define FNDRESDLG_ACTIVATE_PATTERN_BASE    (FNDRESDLG_BASE + 0x0100)
 #define FNDRESDLG_ACTIVATE_PATTERN_END     (FNDRESDLG_BASE + 0x01ff)
 
@@ -67,43 +61,29 @@ public:
    }
 
    virtual void init(HINSTANCE hInst, HWND hPere);
-   void startRtfColorTable(unsigned defColor, unsigned bgColor);
-   void addRtfColor2Table(unsigned color, unsigned bgColor);
-   void finalizeRtfColorTable();
-   bool doRichTextCopy(const TCHAR* filename=NULL);
+   /** add rtf to the clipboard next to the text copied before */
+   bool setRichTextClip(const std::string& rtf);
    void setWrapMode(bool bOn);
    bool getWrapMode() const;
    std::vector<MenuItemUnit> getContextMenu() const;
-   void updateLineNumberWidth(bool lineNumbersShown);
+   /** lineCount is the count of lines numbered, -1 for the lines in the view */
+   void updateLineNumberWidth(bool lineNumbersShown, intptr_t lineCount = -1);
    void setLineNumbersInResult(bool bOn) {
       _bLineNumbersInResult = bOn;
    }
    bool getLineNumbersInResult() const {
       return _bLineNumbersInResult;
    }
-   void doSaveRichtext();
    static long NppVersion; // required for incompatible pointer size change in v8.3++
    static unsigned WarnForOldNppVersionDone; // ensure warning comes only once
 
 protected:
-   static const int transStylePosTab[MY_STYLE_MASK+1];
-   int transStylePos(unsigned char stid) const;
-   int countColorChanges(const char* lpstrText, intptr_t cpMin, intptr_t cpMax);
-   int countLinefeeds(const char* lpstrText, intptr_t cpMin, intptr_t cpMax);
-   int countEscapeChars(const char* lpstrText, intptr_t cpMin, intptr_t cpMax);
-   bool prepareRtfClip(char *pGlobalText, int& iClipLength, char* lpSelText, int iSelTextLength);
-
-   std::string _RtfHeader;
-   std::string _RtfFooter;
-   std::string _RtfColTbl; // intermediate build up of color table
-
    // override to do specialised things and finally call parent directly 
    virtual LRESULT scintillaNew_Proc(HWND hwnd, UINT Message, WPARAM wParam, LPARAM lParam);
 
 
     int _oemCodepage = 0;
     bool _bLineNumbersInResult = true;
-    generic_string _lastRtfFilename;
 
 };
 
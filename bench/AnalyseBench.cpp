@@ -0,0 +1,454 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+AnalyseBench times the hot paths of searching and of the result store on
+a synthetic log and writes the timings as JSON, so that releases can be
+compared. Each scenario is run several times after one warm up run; the
+preparation of a run is not timed.
+*/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "tclLogGenerator.h"
+#include "tclBatchAnalyser.h"
+#include "tclSearchEngine.h"
+#include "tclFindResultDoc.h"
+#include "tclResultExport.h"
+#include "tclByteScanner.h"
+
+struct tstTiming {
+   std::string name;
+   std::vector<double> ms;
+   double items;     // processed items per run, e.g. positions or lines
+   double bytes;     // processed bytes per run or 0
+};
+
+static void usage(const char* prog) {
+   std::cerr << "usage: " << prog << " [options]\n"
+      << "  -s <MB>      size of the log (default 32)\n"
+      << "  -l <chars>   average line length (default 120)\n"
+      << "  -d <part>    part of the lines with a hit (default 0.01)\n"
+      << "  -p <count>   count of patterns (default 20)\n"
+      << "  -r <part>    part of regular expressions (default 0.2)\n"
+      << "  -i <count>   runs per scenario (default 5)\n"
+      << "  -t <count>   search threads, 0 = one per core (default 0)\n"
+      << "  -S <seed>    seed of the generator (default 1)\n"
+      << "  -k <kernel>  scalar, sse2 or avx2 for skipping text (default: best of the cpu)\n"
+      << "  -f <name>    run only scenarios containing name\n"
+      << "  -o <file>    write the JSON into file instead of stdout\n";
+}
+
+/** time run() iterations times; setup() is called untimed before each run */
+static tstTiming measure(const char* name, unsigned iterations,
+                         const std::function<void()>& setup, const std::function<double()>& run)
+{
+   tstTiming t;
+   t.name = name;
+   t.bytes = 0;
+   setup();
+   t.items = run(); // warm up
+   for (unsigned i = 0; i < iterations; ++i) {
+      setup();
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      t.items = run();
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+      t.ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+   }
+   std::cerr << name << ": " << *std::min_element(t.ms.begin(), t.ms.end()) << " ms\n";
+   return t;
+}
+
+/** stream buffer only counting the bytes written, so exports are timed without the disk */
+class tclCountingBuf : public std::streambuf {
+public:
+   tclCountingBuf() : mCount(0) {}
+   std::streamsize getCount() const {
+      return mCount;
+   }
+protected:
+   virtual std::streamsize xsputn(const char*, std::streamsize n) {
+      mCount += n;
+      return n;
+   }
+   virtual int_type overflow(int_type c) {
+      ++mCount;
+      return traits_type::not_eof(c);
+   }
+   std::streamsize mCount;
+};
+
+static void setAllDirty(tclResultList& list) {
+   tclResultList::iterator it = list.begin();
+   for (; it != list.end(); ++it) {
+      it.refResult().clear();
+      it.refResult().setDirty();
+   }
+}
+
+static double countPositions(const tclResultList::tlmResult& found) {
+   double count = 0;
+   for (tclResultList::tlmResult::const_iterator it = found.begin(); it != found.end(); ++it) {
+      count += it->second.size();
+   }
+   return count;
+}
+
+/** fill doc like AnalysePlugin::insertResultLines() does */
+static double fillResultDoc(tclFindResultDoc& doc, const tclResultList& list, const tclLineIndex& lineIndex) {
+   double count = 0;
+   const char* pDoc = lineIndex.getDocument();
+   std::string text;
+   tclResultList::const_iterator iResult = list.begin();
+   for (; iResult != list.end(); ++iResult) {
+      const tclResult::tlvPosInfo& positions = iResult.getResult().getPositions();
+      doc.reserve((unsigned)positions.size());
+      tclResult::tlvPosInfo::const_iterator it = positions.begin();
+      for (; it != positions.end(); ++it) {
+         tclPosInfo pos = *it;
+         tiLine start = lineIndex.positionFromLine(it->line);
+         pos.start -= start;
+         pos.end -= start;
+         doc.insertPosInfo(iResult.getPatId(), it->line, pos);
+      }
+      for (it = positions.begin(); it != positions.end(); ++it) {
+         if (!doc.getLineAvail(it->line)) {
+            tiLine start = lineIndex.positionFromLine(it->line);
+            text.assign(pDoc + start, lineIndex.lineEndPosition(it->line) - start);
+            text += "\r\n";
+            doc.setLineText(it->line, text);
+         }
+      }
+      count += positions.size();
+   }
+   return count;
+}
+
+static void writeJson(std::ostream& os, const tclLogGenerator::tstSettings& settings, unsigned iterations,
+                      size_t lines, size_t hitLines, const std::vector<tstTiming>& timings)
+{
+   os << "{\n  \"benchmark\": \"AnalyseBench\",\n  \"config\": {\n"
+      << "    \"doc_bytes\": " << settings.docSize << ",\n"
+      << "    \"doc_lines\": " << lines << ",\n"
+      << "    \"line_length\": " << settings.lineLength << ",\n"
+      << "    \"hit_density\": " << settings.hitDensity << ",\n"
+      << "    \"hit_lines\": " << hitLines << ",\n"
+      << "    \"patterns\": " << settings.patterns << ",\n"
+      << "    \"regex_mix\": " << settings.regexMix << ",\n"
+      << "    \"seed\": " << settings.seed << ",\n"
+      << "    \"kernel\": \"" << tclByteScanner::getKernelName(tclByteScanner::getKernel()) << "\",\n"
+      << "    \"iterations\": " << iterations << "\n  },\n  \"results\": [";
+   for (size_t i = 0; i < timings.size(); ++i) {
+      const tstTiming& t = timings[i];
+      std::vector<double> ms(t.ms);
+      std::sort(ms.begin(), ms.end());
+      double sum = 0;
+      for (size_t j = 0; j < ms.size(); ++j) {
+         sum += ms[j];
+      }
+      double median = (ms.size() % 2) ? ms[ms.size() / 2] : (ms[ms.size() / 2 - 1] + ms[ms.size() / 2]) / 2;
+      os << (i ? ",\n" : "\n") << "    { \"name\": \"" << t.name << "\""
+         << ", \"min_ms\": " << ms.front()
+         << ", \"median_ms\": " << median
+         << ", \"mean_ms\": " << sum / ms.size()
+         << ", \"max_ms\": " << ms.back()
+         << ", \"items\": " << (unsigned long long)t.items;
+      if (t.bytes > 0) {
+         os << ", \"mb_per_s\": " << (t.bytes / (1024.0 * 1024.0)) / (ms.front() / 1000.0);
+      }
+      os << " }";
+   }
+   os << "\n  ]\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+   tclLogGenerator::tstSettings settings;
+   settings.docSize = 32 * 1024 * 1024;
+   settings.lineLength = 120;
+   settings.hitDensity = 0.01;
+   settings.patterns = 20;
+   settings.regexMix = 0.2;
+   settings.seed = 1;
+   unsigned iterations = 5;
+   unsigned threads = 0;
+   const char* outName = 0;
+   std::string filter;
+   for (int arg = 1; arg < argc; ++arg) {
+      const char* opt = argv[arg];
+      const char* val = (arg + 1 < argc) ? argv[arg + 1] : 0;
+      if (opt[0] != '-' || strlen(opt) != 2 || val == 0) {
+         usage(argv[0]);
+         return 2;
+      }
+      switch (opt[1]) {
+      case 's': settings.docSize = (size_t)(atof(val) * 1024 * 1024); break;
+      case 'l': settings.lineLength = (unsigned)strtoul(val, 0, 10); break;
+      case 'd': settings.hitDensity = atof(val); break;
+      case 'p': settings.patterns = (unsigned)strtoul(val, 0, 10); break;
+      case 'r': settings.regexMix = atof(val); break;
+      case 'i': iterations = (unsigned)strtoul(val, 0, 10); break;
+      case 't': threads = (unsigned)strtoul(val, 0, 10); break;
+      case 'S': settings.seed = (uint32_t)strtoul(val, 0, 10); break;
+      case 'f': filter = val; break;
+      case 'o': outName = val; break;
+      case 'k':
+         if (strcmp(val, "scalar") == 0) {
+            tclByteScanner::setKernel(tclByteScanner::kernelScalar);
+         } else if (strcmp(val, "sse2") == 0) {
+            tclByteScanner::setKernel(tclByteScanner::kernelSse2);
+         } else if (strcmp(val, "avx2") != 0) {
+            usage(argv[0]);
+            return 2;
+         }
+         break;
+      default:
+         usage(argv[0]);
+         return 2;
+      }
+      ++arg;
+   }
+   if (iterations < 1 || settings.lineLength < 8) {
+      usage(argv[0]);
+      return 2;
+   }
+
+   tclLogGenerator generator(settings);
+   tclResultList list;
+   std::string doc;
+   generator.createPatterns(list);
+   generator.createDocument(doc);
+   const size_t hitLines = generator.getHitLines();
+   // a new line in the middle and a block of lines at the end
+   std::string line = generator.createLine(true);
+   std::string appended;
+   while (appended.size() < 64 * 1024) {
+      appended += generator.createLine();
+   }
+   const tiLine length = (tiLine)doc.size();
+
+   tclBatchAnalyser analyser;
+   analyser.setMaxThreads(threads);
+   analyser.analyse(list, doc.data(), length);
+   const tclLineIndex& lineIndex = analyser.getLineIndex();
+   const size_t lineCount = (size_t)lineIndex.getLineCount();
+
+   tiLine editPos = lineIndex.positionFromLine(lineIndex.getLineCount() / 2);
+   std::string edited(doc);
+   edited.insert((size_t)editPos, line);
+   tclEditRange edit;
+   edit.reset();
+   edit.addModification(editPos, (tiLine)line.size(), true, 1);
+   std::string grown(doc);
+   grown += appended;
+   tclEditRange growth;
+   growth.reset();
+   growth.addModification(length, (tiLine)appended.size(), true, 1);
+
+   std::vector<tstTiming> timings;
+   tclSearchEngine engine;
+   engine.setMaxThreads(threads);
+   tclResultList::tlmResult found;
+   tclResultList work(list);
+   auto selected = [&filter](const char* name) {
+      return filter.size() == 0 || strstr(name, filter.c_str()) != 0;
+   };
+
+   if (selected("search_literal")) {
+      timings.push_back(measure("search_literal", iterations,
+         [&]() { setAllDirty(work); found.clear(); },
+         [&]() {
+            engine.setDocument(doc.data(), length);
+            engine.search(work, found);
+            return countPositions(found);
+         }));
+      timings.back().bytes = (double)length;
+   }
+   if (selected("search_full")) {
+      tclBatchAnalyser full;
+      full.setMaxThreads(threads);
+      timings.push_back(measure("search_full", iterations,
+         [&]() {},
+         [&]() {
+            full.analyse(work, doc.data(), length);
+            double count = 0;
+            for (tclResultList::const_iterator it = work.begin(); it != work.end(); ++it) {
+               count += it.getResult().size();
+            }
+            return count;
+         }));
+      timings.back().bytes = (double)length;
+   }
+   if (selected("search_incremental_edit")) {
+      timings.push_back(measure("search_incremental_edit", iterations,
+         [&]() {
+            engine.setDocument(doc.data(), length);
+            engine.getLineIndex();
+            setAllDirty(work);
+            found.clear();
+         },
+         [&]() {
+            engine.updateDocument(edited.data(), (tiLine)edited.size(), edit);
+            const tclLineIndex& index = engine.getLineIndex();
+            tiLine line = index.lineFromPosition(edit.getStart());
+            engine.search(work, found, index.positionFromLine(line), index.positionFromLine(line + 1));
+            return countPositions(found);
+         }));
+   }
+   if (selected("search_incremental_append")) {
+      timings.push_back(measure("search_incremental_append", iterations,
+         [&]() {
+            engine.setDocument(doc.data(), length);
+            engine.getLineIndex();
+            setAllDirty(work);
+            found.clear();
+         },
+         [&]() {
+            engine.updateDocument(grown.data(), (tiLine)grown.size(), growth);
+            const tclLineIndex& index = engine.getLineIndex();
+            engine.search(work, found, index.positionFromLine(index.lineFromPosition(length)));
+            return countPositions(found);
+         }));
+      timings.back().bytes = (double)appended.size();
+   }
+
+   tclFindResultDoc* pResultDoc = 0;
+   auto newResultDoc = [&pResultDoc]() {
+      delete pResultDoc;
+      pResultDoc = new tclFindResultDoc();
+   };
+   if (selected("result_insert")) {
+      timings.push_back(measure("result_insert", iterations,
+         newResultDoc,
+         [&]() {
+            double count = fillResultDoc(*pResultDoc, list, lineIndex);
+            pResultDoc->size(); // merges the pending hits
+            return count;
+         }));
+   }
+   if (selected("result_remove")) {
+      // every second pattern gets disabled
+      timings.push_back(measure("result_remove", iterations,
+         [&]() {
+            newResultDoc();
+            fillResultDoc(*pResultDoc, list, lineIndex);
+            pResultDoc->size();
+         },
+         [&]() {
+            double count = 0;
+            unsigned i = 0;
+            for (tclResultList::const_iterator it = list.begin(); it != list.end(); ++it, ++i) {
+               if (i % 2) {
+                  continue;
+               }
+               tlvLine lines;
+               tlvLine emptyLines;
+               const tclResult::tlvPosInfo& positions = it.getResult().getPositions();
+               for (tclResult::tlvPosInfo::const_iterator iPos = positions.begin(); iPos != positions.end(); ++iPos) {
+                  if (lines.size() == 0 || lines.back() != iPos->line) {
+                     lines.push_back(iPos->line);
+                  }
+               }
+               pResultDoc->removePosInfos(it.getPatId(), lines, emptyLines);
+               pResultDoc->eraseLines(emptyLines);
+               count += emptyLines.size();
+            }
+            pResultDoc->size();
+            return count;
+         }));
+   }
+   if (selected("result_style")) {
+      // the style bytes of all result lines as tclFindResultDlg::doStyle() builds them
+      // after the styles changed, so the style runs get resolved again each time
+      tclFindResultDoc styleDoc;
+      fillResultDoc(styleDoc, list, lineIndex);
+      std::string styles;
+      timings.push_back(measure("result_style", iterations,
+         [&]() {
+            unsigned char style = 1;
+            tclResultList::const_iterator it = list.begin();
+            for (; it != list.end(); ++it, ++style) {
+               bool bWholeLine = (list.getPattern(it.getPatId()).getSelectionType() == tclPattern::line);
+               styleDoc.setPatternStyle(it.getPatId(), 0, bWholeLine);
+               styleDoc.setPatternStyle(it.getPatId(), style, bWholeLine);
+            }
+         },
+         [&]() {
+            tiLine size = styleDoc.size();
+            styles.clear();
+            for (tiLine resLine = 0; resLine < size; ++resLine) {
+               unsigned length = 0;
+               styleDoc.getLineTextAtRes(resLine, length);
+               size_t textBegin = styles.size();
+               styles.append(length, (char)0);
+               unsigned count = 0;
+               const tclFindResultDoc::tstStyleRun* pRun = styleDoc.getStyleRunsAtRes(resLine, count);
+               for (unsigned r = 0; r < count; ++r, ++pRun) {
+                  styles.replace(textBegin + pRun->start, pRun->length, pRun->length, (char)pRun->style);
+               }
+            }
+            return styles.size() > 0 ? (double)size : 0.0;
+         }));
+   }
+   if (selected("result_export")) {
+      // all result lines as rtf in one pass like "Save once as Richtext..."
+      tclFindResultDoc exportDoc;
+      fillResultDoc(exportDoc, list, lineIndex);
+      tclResultExport exporter(exportDoc);
+      unsigned char style = 1;
+      tclResultList::const_iterator it = list.begin();
+      for (; it != list.end(); ++it, ++style) {
+         const tclPattern& pattern = list.getPattern(it.getPatId());
+         exportDoc.setPatternStyle(it.getPatId(), style, pattern.getSelectionType() == tclPattern::line);
+         tclResultExport::tstStyle exportStyle;
+         exportStyle.color = pattern.getColorNum();
+         exportStyle.bgColor = pattern.getBgColorNum();
+         exporter.addStyle(style, exportStyle);
+      }
+      exporter.setLineHead([&](std::string& s, tiLine resLine) {
+         char num[24];
+         snprintf(num, sizeof(num), "%8lld: ", (long long)exportDoc.getLineNoAtMain(resLine) + 1);
+         s += num;
+      });
+      timings.push_back(measure("result_export", iterations,
+         []() {},
+         [&]() {
+            tclCountingBuf buf;
+            std::ostream os(&buf);
+            exporter.write(os, tclResultExport::fmtRtf);
+            return buf.getCount() > 0 ? (double)exportDoc.size() : 0.0;
+         }));
+   }
+   delete pResultDoc;
+
+   if (outName != 0) {
+      std::ofstream out(outName, std::ios::out | std::ios::trunc);
+      if (!out) {
+         std::cerr << "could not open " << outName << "\n";
+         return 1;
+      }
+      writeJson(out, settings, iterations, lineCount, hitLines, timings);
+   } else {
+      writeJson(std::cout, settings, iterations, lineCount, hitLines, timings);
+   }
+   return 0;
+}
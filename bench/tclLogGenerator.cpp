@@ -0,0 +1,122 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclLogGenerator creates a synthetic log and a matching pattern list
+*/
+#include "tclLogGenerator.h"
+#include <stdio.h>
+
+// filler words; none of them contains the '_' of the key words
+static const char* const gFiller[] = {
+   "request", "response", "value", "timeout", "connection", "client", "server",
+   "handler", "queue", "buffer", "state", "changed", "from", "to", "user", "session",
+   "started", "stopped", "received", "sent", "bytes", "retry", "cache", "miss", "hit",
+   "config", "loaded", "thread", "pool", "task", "done", "pending", "id", "ok"
+};
+static const char* const gLevel[] = { "INFO ", "DEBUG", "WARN ", "TRACE" };
+
+tclLogGenerator::tclLogGenerator(const tstSettings& settings)
+   : mSettings(settings)
+   , mState(settings.seed ? settings.seed : 1)
+   , mHitLines(0)
+   , mLineNo(0)
+{}
+
+uint32_t tclLogGenerator::next()
+{
+   mState ^= mState << 13;
+   mState ^= mState >> 17;
+   mState ^= mState << 5;
+   return mState;
+}
+
+std::string tclLogGenerator::getKeyWord(unsigned i)
+{
+   std::string s("EVT_");
+   do {
+      s += (char)('A' + i % 26);
+      i /= 26;
+   } while (i > 0);
+   return s;
+}
+
+void tclLogGenerator::createPatterns(tclResultList& list)
+{
+   unsigned regexCount = (unsigned)(mSettings.patterns * mSettings.regexMix + 0.5);
+   for (unsigned i = 0; i < mSettings.patterns; ++i) {
+      tclPattern p;
+      std::string key = getKeyWord(i);
+      // regular expressions are spread over the list
+      if (regexCount > 0 && (i * regexCount) / mSettings.patterns != ((i + 1) * regexCount) / mSettings.patterns) {
+         p.setSearchType(tclPattern::regex);
+         p.setSearchText(key + "=[0-9]+");
+         p.setMatchCase(true);
+      } else {
+         p.setSearchType(tclPattern::normal);
+         p.setSearchText(key);
+         p.setMatchCase(false);
+         p.setWholeWord((i % 4) == 3);
+      }
+      p.setComment(key);
+      list.push_back(p);
+   }
+}
+
+std::string tclLogGenerator::createLine(bool bHit)
+{
+   char head[64];
+   size_t ms = mLineNo * 7;
+   int len = snprintf(head, sizeof(head), "%02u:%02u:%02u.%03u %s ",
+      (unsigned)(ms / 3600000 % 24), (unsigned)(ms / 60000 % 60), (unsigned)(ms / 1000 % 60),
+      (unsigned)(ms % 1000), gLevel[nextBelow(4)]);
+   ++mLineNo;
+   std::string line(head, len);
+   unsigned length = mSettings.lineLength / 2 + nextBelow(mSettings.lineLength + 1);
+   size_t hitAt = std::string::npos;
+   if (mSettings.patterns > 0 && (next() < (uint32_t)(mSettings.hitDensity * 4294967295.0) || bHit)) {
+      hitAt = (length > line.size()) ? line.size() + nextBelow(length - (unsigned)line.size()) : line.size();
+      ++mHitLines;
+   }
+   const size_t fillerCount = sizeof(gFiller) / sizeof(gFiller[0]);
+   while (line.size() < length || hitAt != std::string::npos) {
+      if (hitAt != std::string::npos && line.size() >= hitAt) {
+         // the key word matches its literal and its regular expression
+         unsigned i = nextBelow(mSettings.patterns);
+         line += getKeyWord(i);
+         line += '=';
+         line += (char)('0' + nextBelow(10));
+         line += (char)('0' + nextBelow(10));
+         line += ' ';
+         hitAt = std::string::npos;
+         continue;
+      }
+      line += gFiller[nextBelow((uint32_t)fillerCount)];
+      line += ' ';
+   }
+   line[line.size() - 1] = '\n';
+   return line;
+}
+
+void tclLogGenerator::createDocument(std::string& doc)
+{
+   doc.clear();
+   doc.reserve(mSettings.docSize + mSettings.lineLength * 2);
+   while (doc.size() < mSettings.docSize) {
+      doc += createLine();
+   }
+}
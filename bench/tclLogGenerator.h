@@ -0,0 +1,78 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclLogGenerator creates a synthetic log and a matching pattern list for
+the benchmarks. The same settings and seed always give the same text, on
+every platform, so timings of different builds can be compared.
+*/
+
+#ifndef TCLLOGGENERATOR_H
+#define TCLLOGGENERATOR_H
+
+#include <string>
+#include <stdint.h>
+#include "tclResultList.h"
+
+class tclLogGenerator {
+public:
+   struct tstSettings {
+      size_t docSize;      // size of the log in bytes
+      unsigned lineLength; // average length of a line
+      double hitDensity;   // part of the lines containing a hit
+      unsigned patterns;   // count of patterns
+      double regexMix;     // part of the patterns being regular expressions
+      uint32_t seed;
+   };
+
+   tclLogGenerator(const tstSettings& settings);
+
+   /** the patterns; literals are case insensitive, every 4th whole word */
+   void createPatterns(tclResultList& list);
+
+   /** the log with LF line ends */
+   void createDocument(std::string& doc);
+
+   /** count of lines written into a hit by createDocument() */
+   size_t getHitLines() const {
+      return mHitLines;
+   }
+
+   /**
+   * one line as in the document, e.g. for inserting into it;
+   * bHit forces a hit into the line
+   */
+   std::string createLine(bool bHit = false);
+
+protected:
+   /** xorshift32; std distributions differ between libraries */
+   uint32_t next();
+
+   /** random number in [0, range) */
+   uint32_t nextBelow(uint32_t range) {
+      return (uint32_t)(((uint64_t)next() * range) >> 32);
+   }
+
+   /** key word of pattern i; upper case letters never used by the filler */
+   static std::string getKeyWord(unsigned i);
+
+   tstSettings mSettings;
+   uint32_t mState;
+   size_t mHitLines;
+   size_t mLineNo;
+};
+#endif //TCLLOGGENERATOR_H
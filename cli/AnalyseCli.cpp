@@ -0,0 +1,137 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+AnalyseCli searches log files with the patterns of an AnalyseDoc
+configuration and writes the found lines as the result window of the
+plugin shows them.
+*/
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string.h>
+#include <stdlib.h>
+#include "tclConfigReader.h"
+#include "tclBatchAnalyser.h"
+#include "tclMappedFile.h"
+
+static void usage(const char* prog) {
+   std::cerr << "usage: " << prog << " [options] <config.xml> <file> [<file>...]\n"
+      << "  -o <file>  write the result into file instead of stdout\n"
+      << "  -n         no line numbers\n"
+      << "  -c         show the comments of the patterns\n"
+      << "  -t <count> maximum count of search threads (0 = one per core)\n"
+      << "  -v         print statistics and the costs of each pattern to stderr\n"
+      << "  -x         no index files (.apidx, .apngr) beside files of 64 MB and more\n"
+      << "  -h         this help\n";
+}
+
+int main(int argc, char* argv[]) {
+   tclBatchAnalyser analyser;
+   const char* outName = 0;
+   bool bVerbose = false;
+   bool bLineIndexFile = true;
+   int arg = 1;
+   for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] != 0; ++arg) {
+      const char* opt = argv[arg];
+      if (strcmp(opt, "-o") == 0 && arg + 1 < argc) {
+         outName = argv[++arg];
+      } else if (strcmp(opt, "-n") == 0) {
+         analyser.setDisplayLineNo(false);
+      } else if (strcmp(opt, "-c") == 0) {
+         analyser.setDisplayComment(true);
+      } else if (strcmp(opt, "-t") == 0 && arg + 1 < argc) {
+         analyser.setMaxThreads((unsigned)strtoul(argv[++arg], 0, 10));
+      } else if (strcmp(opt, "-v") == 0) {
+         bVerbose = true;
+      } else if (strcmp(opt, "-x") == 0) {
+         bLineIndexFile = false;
+      } else if (strcmp(opt, "-h") == 0) {
+         usage(argv[0]);
+         return 0;
+      } else {
+         std::cerr << "unknown option " << opt << "\n";
+         usage(argv[0]);
+         return 2;
+      }
+   }
+   if (argc - arg < 2) {
+      usage(argv[0]);
+      return 2;
+   }
+   tclResultList list;
+   tclConfigReader reader(argv[arg]);
+   generic_string msg;
+   if (reader.getError(msg)) {
+      std::cerr << argv[arg] << ": " << msg << "\n";
+      return 1;
+   }
+   if (!reader.readPatternList(list)) {
+      std::cerr << argv[arg] << ": no AnalyseDoc configuration\n";
+      return 1;
+   }
+   ++arg;
+
+   std::ofstream outFile;
+   if (outName != 0) {
+      outFile.open(outName, std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!outFile) {
+         std::cerr << "could not open " << outName << "\n";
+         return 1;
+      }
+   }
+   std::ostream& os = (outName != 0) ? outFile : std::cout;
+   bool bMultipleFiles = (argc - arg > 1);
+   int ret = 0;
+   tclMappedFile file;
+   for (; arg < argc; ++arg) {
+      // the file is mapped, so only the found lines need memory
+      if (!file.open(argv[arg])) {
+         std::cerr << "could not read " << argv[arg] << "\n";
+         ret = 1;
+         continue;
+      }
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      unsigned found = bLineIndexFile ? analyser.analyseFile(list, file.getData(), file.getLength(), file)
+                                      : analyser.analyse(list, file.getData(), file.getLength());
+      std::chrono::steady_clock::time_point searched = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < analyser.getErrors().size(); ++i) {
+         std::cerr << argv[arg] << ": " << analyser.getErrors()[i] << "\n";
+         ret = 1;
+      }
+      if (bMultipleFiles) {
+         os << "==> " << argv[arg] << " <==\n";
+      }
+      tiLine lines = analyser.writeResult(os, list);
+      if (bVerbose) {
+         std::chrono::steady_clock::time_point written = std::chrono::steady_clock::now();
+         std::cerr << argv[arg] << ": " << file.getLength() << " bytes, "
+            << list.size() << " patterns, " << found << " positions in "
+            << lines << " lines; search "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(searched - start).count() << " ms, write "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(written - searched).count() << " ms\n";
+         // literals are searched in one pass and share its time
+         for (tclResultList::const_iterator it = list.begin(); it != list.end(); ++it) {
+            const tstSearchStats& stats = it.getResult().getStats();
+            std::cerr << "  " << (stats.bShared ? "~" : "") << stats.searchMs << " ms, "
+               << stats.hits << " hits: " << list.getPattern(it.getPatId()).getSearchText() << "\n";
+         }
+      }
+   }
+   os.flush();
+   return ret;
+}
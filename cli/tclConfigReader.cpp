@@ -0,0 +1,290 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclConfigReader reads the search patterns out of an AnalyseDoc configuration
+file without the tinyxml of notepad++
+*/
+#include "tclConfigReader.h"
+#include "FindConfigDoc.h"
+#include <fstream>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#define MDBG_COMP "CfgRd:"
+#include "myDebug.h"
+
+#define CFGRD_WHITESPACE " \t\r\n"
+
+tclConfigReader::tclConfigReader(const char* filename)
+   : mbAnalyseDoc(false)
+{
+   std::ifstream file(filename, std::ios::in | std::ios::binary);
+   if (!file) {
+      mError = generic_string(TEXT("file not found: ")) + filename;
+      return;
+   }
+   std::stringstream ss;
+   ss << file.rdbuf();
+   parse(ss.str());
+}
+
+bool tclConfigReader::getError(generic_string& msg) const {
+   msg = mError;
+   return mError.size() > 0;
+}
+
+bool tclConfigReader::setError(const std::string& doc, size_t pos, const char* msg) {
+   size_t line = 1;
+   for (size_t i = 0; i < pos && i < doc.size(); ++i) {
+      if (doc[i] == '\n') {
+         ++line;
+      }
+   }
+   std::ostringstream os;
+   os << msg << " in line " << line << " ";
+   mError = os.str();
+   return false;
+}
+
+bool tclConfigReader::parseAttributes(const std::string& doc, size_t& pos, tlmAttribute& attributes, bool& bEmpty) {
+   for (;;) {
+      pos = doc.find_first_not_of(CFGRD_WHITESPACE, pos);
+      if (pos == std::string::npos) {
+         return setError(doc, doc.size(), "Tag not closed");
+      }
+      if (doc[pos] == '>') {
+         bEmpty = false;
+         ++pos;
+         return true;
+      }
+      if (doc.compare(pos, 2, "/>") == 0) {
+         bEmpty = true;
+         pos += 2;
+         return true;
+      }
+      size_t nameEnd = doc.find_first_of(CFGRD_WHITESPACE "=/>", pos);
+      if (nameEnd == std::string::npos || nameEnd == pos) {
+         return setError(doc, pos, "Error reading Attributes.");
+      }
+      std::string name(doc, pos, nameEnd - pos);
+      pos = doc.find_first_not_of(CFGRD_WHITESPACE, nameEnd);
+      if (pos == std::string::npos || doc[pos] != '=') {
+         return setError(doc, nameEnd, "Error reading Attributes.");
+      }
+      pos = doc.find_first_not_of(CFGRD_WHITESPACE, pos + 1);
+      if (pos == std::string::npos || (doc[pos] != '"' && doc[pos] != '\'')) {
+         return setError(doc, nameEnd, "Error reading Attributes.");
+      }
+      size_t valueEnd = doc.find(doc[pos], pos + 1);
+      if (valueEnd == std::string::npos) {
+         return setError(doc, pos, "Error reading Attributes.");
+      }
+      attributes[name] = decode(doc.substr(pos + 1, valueEnd - pos - 1));
+      pos = valueEnd + 1;
+   }
+}
+
+bool tclConfigReader::parse(const std::string& doc) {
+   size_t pos = 0;
+   if (doc.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+      pos = 3; // utf-8 byte order mark
+   }
+   std::vector<std::string> open;  // names of the open elements
+   size_t current = (size_t)-1;    // SearchText element being read
+   while (pos < doc.size()) {
+      size_t tag = doc.find('<', pos);
+      if (tag == std::string::npos) {
+         tag = doc.size();
+      }
+      if (current != (size_t)-1 && open.size() == 2 && tag > pos) {
+         mvSearchText[current].text += decode(doc.substr(pos, tag - pos));
+         mvSearchText[current].bHasText = true;
+      }
+      if (tag == doc.size()) {
+         break;
+      }
+      size_t end;
+      if (doc.compare(tag, 4, "<!--") == 0) {
+         end = doc.find("-->", tag);
+         if (end == std::string::npos) {
+            return setError(doc, tag, "Error parsing Comment.");
+         }
+         pos = end + 3;
+      } else if (doc.compare(tag, 9, "<![CDATA[") == 0) {
+         end = doc.find("]]>", tag);
+         if (end == std::string::npos) {
+            return setError(doc, tag, "Error parsing CDATA.");
+         }
+         if (current != (size_t)-1 && open.size() == 2) {
+            mvSearchText[current].text += doc.substr(tag + 9, end - tag - 9);
+            mvSearchText[current].bHasText = true;
+         }
+         pos = end + 3;
+      } else if (doc.compare(tag, 2, "<?") == 0 || doc.compare(tag, 2, "<!") == 0) {
+         // declaration or document type
+         end = doc.find('>', tag);
+         if (end == std::string::npos) {
+            return setError(doc, tag, "Error parsing Declaration.");
+         }
+         pos = end + 1;
+      } else if (doc.compare(tag, 2, "</") == 0) {
+         end = doc.find('>', tag);
+         if (end == std::string::npos) {
+            return setError(doc, tag, "Error reading end tag.");
+         }
+         size_t nameEnd = doc.find_last_not_of(CFGRD_WHITESPACE, end - 1) + 1;
+         std::string name(doc, tag + 2, nameEnd - tag - 2);
+         if (open.size() == 0 || open.back() != name) {
+            return setError(doc, tag, "Error reading end tag.");
+         }
+         open.pop_back();
+         if (open.size() < 2) {
+            current = (size_t)-1;
+         }
+         pos = end + 1;
+      } else {
+         size_t nameEnd = doc.find_first_of(CFGRD_WHITESPACE "/>", tag + 1);
+         if (nameEnd == std::string::npos || nameEnd == tag + 1) {
+            return setError(doc, tag, "Error parsing Element.");
+         }
+         std::string name(doc, tag + 1, nameEnd - tag - 1);
+         tlmAttribute attributes;
+         bool bEmpty = false;
+         pos = nameEnd;
+         if (!parseAttributes(doc, pos, attributes, bEmpty)) {
+            return false;
+         }
+         if (open.size() == 0) {
+            mbAnalyseDoc = (name == FNDDOC_ANALYSE_DOC);
+         } else if (open.size() == 1 && mbAnalyseDoc && name == FNDDOC_SEARCH_TEXT) {
+            tstElement e;
+            e.attributes.swap(attributes);
+            e.bHasText = false;
+            mvSearchText.push_back(e);
+            current = bEmpty ? (size_t)-1 : mvSearchText.size() - 1;
+         }
+         if (!bEmpty) {
+            open.push_back(name);
+         }
+      }
+   }
+   if (open.size() > 0) {
+      return setError(doc, doc.size(), "Error reading end tag.");
+   }
+   DBG1("parse() %d patterns read.", (int)mvSearchText.size());
+   return true;
+}
+
+std::string tclConfigReader::decode(const std::string& text) {
+   static const struct {
+      const char* entity;
+      char c;
+   } entities[] = {
+      { "&amp;", '&' }, { "&lt;", '<' }, { "&gt;", '>' }, { "&quot;", '"' }, { "&apos;", '\'' }
+   };
+   if (text.find('&') == std::string::npos) {
+      return text;
+   }
+   std::string s;
+   s.reserve(text.size());
+   for (size_t i = 0; i < text.size(); ++i) {
+      if (text[i] != '&') {
+         s += text[i];
+         continue;
+      }
+      bool bFound = false;
+      for (size_t e = 0; e < sizeof(entities) / sizeof(entities[0]) && !bFound; ++e) {
+         size_t len = strlen(entities[e].entity);
+         if (text.compare(i, len, entities[e].entity) == 0) {
+            s += entities[e].c;
+            i += len - 1;
+            bFound = true;
+         }
+      }
+      size_t semicolon = text.find(';', i);
+      if (!bFound && text.compare(i, 2, "&#") == 0 && semicolon != std::string::npos) {
+         // character reference encoded as utf-8
+         bool bHex = (text.compare(i, 3, "&#x") == 0);
+         unsigned long c = strtoul(text.c_str() + i + (bHex ? 3 : 2), 0, bHex ? 16 : 10);
+         if (c < 0x80) {
+            s += (char)c;
+         } else if (c < 0x800) {
+            s += (char)(0xC0 | (c >> 6));
+            s += (char)(0x80 | (c & 0x3F));
+         } else if (c < 0x10000) {
+            s += (char)(0xE0 | (c >> 12));
+            s += (char)(0x80 | ((c >> 6) & 0x3F));
+            s += (char)(0x80 | (c & 0x3F));
+         } else {
+            s += (char)(0xF0 | (c >> 18));
+            s += (char)(0x80 | ((c >> 12) & 0x3F));
+            s += (char)(0x80 | ((c >> 6) & 0x3F));
+            s += (char)(0x80 | (c & 0x3F));
+         }
+         i = semicolon;
+         bFound = true;
+      }
+      if (!bFound) {
+         s += text[i];
+      }
+   }
+   return s;
+}
+
+bool tclConfigReader::readPatternList(tclPatternList& pl) const {
+   // same attributes as FindConfigDoc::readPatternList()
+   typedef void (tclPattern::*tSetter)(const generic_string&);
+   static const struct {
+      const TCHAR* name;
+      tSetter setter;
+   } setters[] = {
+      { FNDDOC_ORDER_NUM, &tclPattern::setOrderNumStr },
+      { FNDDOC_DO_SEARCH, &tclPattern::setDoSearchStr },
+      { FNDDOC_SEARCH_TYPE, &tclPattern::setSearchTypeStr },
+      { FNDDOC_MATCHCASE, &tclPattern::setMatchCaseStr },
+      { FNDDOC_WHOLEWORD, &tclPattern::setWholeWordStr },
+      { FNDDOC_SELECT, &tclPattern::setSelectionTypeStr },
+      { FNDDOC_HIDE, &tclPattern::setHideTextStr },
+      { FNDDOC_BOLD, &tclPattern::setBoldStr },
+      { FNDDOC_ITALIC, &tclPattern::setItalicStr },
+      { FNDDOC_UNDERLINED, &tclPattern::setUnderlinedStr },
+      { FNDDOC_COLOR, &tclPattern::setColorStr },
+      { FNDDOC_BGCOLOR, &tclPattern::setBgColorStr },
+      { FNDDOC_COMMENT, &tclPattern::setComment },
+      { FNDDOC_GROUP, &tclPattern::setGroup }
+   };
+   if (!mbAnalyseDoc) {
+      return false;
+   }
+   std::vector<tstElement>::const_iterator it = mvSearchText.begin();
+   for (; it != mvSearchText.end(); ++it) {
+      if (!it->bHasText || it->text.size() == 0) {
+         continue;
+      }
+      tclPattern p;
+      p.setSearchText(it->text);
+      for (size_t i = 0; i < sizeof(setters) / sizeof(setters[0]); ++i) {
+         tlmAttribute::const_iterator iAttr = it->attributes.find(setters[i].name);
+         if (iAttr != it->attributes.end() && iAttr->second.size() > 0) {
+            (p.*setters[i].setter)(iAttr->second);
+         }
+      }
+      pl.push_back(p);
+   }
+   return true;
+}
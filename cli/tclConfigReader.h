@@ -0,0 +1,73 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclConfigReader reads the search patterns out of an AnalyseDoc configuration
+file without the tinyxml of notepad++, so that the patterns can be used
+outside of the editor. Only reading is supported, writing stays with
+FindConfigDoc.
+*/
+
+#ifndef TCLCONFIGREADER_H
+#define TCLCONFIGREADER_H
+
+#include <string>
+#include <map>
+#include "tclPatternList.h"
+
+class tclConfigReader {
+public:
+   /**
+   * the file is read and parsed completely; see getError()
+   */
+   tclConfigReader(const char* filename);
+
+   /** returns true and the reason in msg if the file could not be read */
+   bool getError(generic_string& msg) const;
+
+   /**
+   * append the patterns of the file to pl in their order
+   * @return true if the file is an AnalyseDoc
+   */
+   bool readPatternList(tclPatternList& pl) const;
+
+protected:
+   typedef std::map<generic_string, generic_string> tlmAttribute;
+
+   struct tstElement {
+      tlmAttribute attributes;
+      generic_string text;
+      bool bHasText;
+   };
+
+   /** parse the whole document and collect all SearchText elements */
+   bool parse(const std::string& doc);
+
+   /** read the attributes of a start tag up to its end at pos */
+   bool parseAttributes(const std::string& doc, size_t& pos, tlmAttribute& attributes, bool& bEmpty);
+
+   /** replace the entity references in text */
+   static std::string decode(const std::string& text);
+
+   /** set the error message with the line of pos */
+   bool setError(const std::string& doc, size_t pos, const char* msg);
+
+   std::vector<tstElement> mvSearchText;
+   bool mbAnalyseDoc;
+   generic_string mError;
+};
+#endif //TCLCONFIGREADER_H
@@ -0,0 +1,64 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (C) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+platform.h is included by the classes of the analysis core (patterns,
+results and search engine) instead of windows.h and Common.h.
+On windows it takes both, everywhere else it defines the few types and
+functions of them being used in the core with char as TCHAR.
+*/
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#ifdef _WIN32
+#include <windows.h>
+#include "Common.h"
+#else // _WIN32
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+typedef char TCHAR;
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef unsigned long DWORD;
+typedef DWORD COLORREF;
+
+#define TEXT(quote) quote
+#define RGB(r,g,b) ((COLORREF)(((BYTE)(r)|((WORD)((BYTE)(g))<<8))|(((DWORD)(BYTE)(b))<<16)))
+
+typedef std::basic_string<TCHAR> generic_string;
+
+#define generic_strtol strtol
+
+/**
+same as _itoa of the microsoft runtime for radix 10 and 16; the size of
+the buffer is taken from its array type, a longer number is cut
+*/
+template <size_t size>
+inline char* generic_itoa(long value, char (&buffer)[size], int radix) {
+   if (radix == 16) {
+      snprintf(buffer, size, "%lx", (unsigned long)value);
+   } else {
+      snprintf(buffer, size, "%ld", value);
+   }
+   return buffer;
+}
+#endif // _WIN32
+
+#endif // PLATFORM_H
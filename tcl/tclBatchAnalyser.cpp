@@ -0,0 +1,337 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclBatchAnalyser searches a result list in a document buffer without any
+editor and writes the found lines as the result window shows them.
+*/
+#include "tclBatchAnalyser.h"
+#include "tclCompiledPattern.h"
+#include "tclLineIndexFile.h"
+#include "tclNgramIndex.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string.h>
+#include <ctype.h>
+#include "Scintilla.h"
+#define MDBG_COMP "Batch:"
+#include "myDebug.h"
+
+// same as in tclFindResultDlg
+#define BATCH_LINE_HEAD ""
+#define BATCH_LINE_COLON ": "
+#define BATCH_LINE_HYPHEN "| "
+// written in pieces of this size
+#define BATCH_WRITE_BUFFER (64*1024)
+
+tclBatchAnalyser::tclBatchAnalyser()
+   : mpHost(0)
+   , mpCancel(0)
+   , mbCanceled(false)
+   , mpDoc(0)
+   , mDocLength(0)
+   , mbDisplayLineNo(true)
+   , mbDisplayComment(false)
+{
+   mEngine.setCodePage(SC_CP_UTF8);
+   mEngine.setHost(this);
+}
+
+bool tclBatchAnalyser::isRangeWord(tiLine start, tiLine end)
+{
+   return isWordAt(start, end);
+}
+
+bool tclBatchAnalyser::isSearchCanceled()
+{
+   if (!mbCanceled && mpCancel != 0) {
+      mbCanceled = mpCancel->getIsCanceled();
+   }
+   if (!mbCanceled && mpHost != 0) {
+      mbCanceled = mpHost->isSearchCanceled();
+   }
+   return mbCanceled;
+}
+
+unsigned tclBatchAnalyser::analyse(tclResultList& list, const char* pDoc, tiLine length)
+{
+   setDocument(pDoc, length);
+   return searchList(list);
+}
+
+unsigned tclBatchAnalyser::analyseFile(tclResultList& list, const char* pDoc, tiLine length, const tclMappedFile& file)
+{
+   setDocument(pDoc, length);
+   if (length < LINEINDEXFILE_MIN_SIZE) {
+      return searchList(list);
+   }
+   tclLineIndexFile sidecar(file.getFileName(), file.getModified());
+   tclLineIndex index;
+   tclLineIndexFile::teState state = sidecar.load(pDoc, length, index);
+   if (state != tclLineIndexFile::stateMissing) {
+      // the search doesn't need to collect the lines
+      mEngine.takeLineIndex(index);
+   }
+   // analysing the file again only scans the blocks containing the literals
+   tclNgramIndex ngrams;
+   const bool bNgramsLoaded = (length >= NGRAMINDEX_MIN_SIZE) &&
+                              ngrams.load(file.getFileName(), file.getModified(), pDoc, length) &&
+                              mEngine.takeNgramIndex(ngrams);
+   unsigned count = searchList(list);
+   if (state != tclLineIndexFile::stateCurrent && !mbCanceled) {
+      sidecar.save(mEngine.getLineIndex());
+   }
+   if (!bNgramsLoaded && length >= NGRAMINDEX_MIN_SIZE && !mbCanceled) {
+      mEngine.buildNgramIndex();
+      mEngine.getNgramIndex()->save(file.getFileName(), file.getModified());
+   }
+   return count;
+}
+
+void tclBatchAnalyser::setDocument(const char* pDoc, tiLine length)
+{
+   mpDoc = pDoc;
+   mDocLength = length;
+   mvErrors.clear();
+   mbCanceled = false;
+   mEngine.setDocument(pDoc, length);
+}
+
+unsigned tclBatchAnalyser::searchList(tclResultList& list)
+{
+   tclResultList::iterator iResult = list.begin();
+   for (; iResult != list.end(); ++iResult) {
+      iResult.refResult().clear();
+      iResult.refResult().setDirty();
+   }
+   // all literal patterns are searched together in one pass, the regular
+   // expressions at the same time
+   tclResultList::tlmResult found;
+   mEngine.search(list, found);
+   tclSearchEngine::tlvError errors;
+   mEngine.takeErrors(errors);
+   for (tclSearchEngine::tlvError::const_iterator it = errors.begin(); it != errors.end(); ++it) {
+      addError(list.getPattern(it->first), it->second);
+   }
+   unsigned count = 0;
+   for (iResult = list.begin(); iResult != list.end() && !isSearchCanceled(); ++iResult) {
+      tclResult& result = iResult.refResult();
+      tclResultList::tlmResult::iterator iFound = found.find(iResult.getPatId());
+      if (iFound != found.end()) {
+         result.swap(iFound->second);
+         result.setDirty(false);
+      } else {
+         tclStopWatch watch;
+         findPattern(list.getPattern(iResult.getPatId()), result);
+         if (list.getPattern(iResult.getPatId()).getDoSearch()) {
+            result.refStats().searchMs = watch.getMs();
+            result.refStats().bytes = mDocLength;
+         }
+         result.refStats().hits = result.size();
+      }
+      count += result.size();
+   }
+   return count;
+}
+
+std::string tclBatchAnalyser::getDocText(const generic_string& text)
+{
+#ifdef UNICODE
+   WcharMbcsConvertor& wmc = WcharMbcsConvertor::getInstance();
+   // the converter reuses its buffer, so copy immediately
+   return std::string(wmc.wchar2char(text.c_str(), SC_CP_UTF8));
+#else
+   return std::string(text.c_str());
+#endif
+}
+
+tclSearchEngine::teCharClass tclBatchAnalyser::getCharClass(unsigned char c)
+{
+   if (c == '\r' || c == '\n') {
+      return tclSearchEngine::ccNewLine;
+   } else if (c < 0x20 || c == ' ') {
+      return tclSearchEngine::ccSpace;
+   } else if (c >= 0x80 || isalnum(c) || c == '_') {
+      return tclSearchEngine::ccWord;
+   }
+   return tclSearchEngine::ccPunctuation;
+}
+
+bool tclBatchAnalyser::isWordAt(tiLine start, tiLine end) const
+{
+   tclSearchEngine::teCharClass ccStart = getCharClass(mpDoc[start]);
+   tclSearchEngine::teCharClass ccEnd = getCharClass(mpDoc[end - 1]);
+   tclSearchEngine::teCharClass ccBefore = (start > 0) ? getCharClass(mpDoc[start - 1]) : tclSearchEngine::ccSpace;
+   tclSearchEngine::teCharClass ccBehind = (end < mDocLength) ? getCharClass(mpDoc[end]) : tclSearchEngine::ccSpace;
+   // same as Document::IsWordEdge()
+   bool bStart = (ccStart != ccBefore) && (ccStart == tclSearchEngine::ccWord || ccStart == tclSearchEngine::ccPunctuation);
+   bool bEnd = (ccEnd != ccBehind) && (ccEnd == tclSearchEngine::ccWord || ccEnd == tclSearchEngine::ccPunctuation);
+   return (start < end) && bStart && bEnd;
+}
+
+unsigned tclBatchAnalyser::findPattern(const tclPattern& pattern, tclResult& result)
+{
+   result.clear();
+   result.setDirty(false);
+   result.setSearchedLength(mDocLength);
+   if (pattern.getDoSearch() == false || mDocLength < 1) {
+      return 0;
+   }
+   const tclCompiledPattern& compiled = pattern.getCompiled(SC_CP_UTF8);
+   if (compiled.getText().size() == 0) {
+      // empty string is found "every where" so nothing is found
+      return 0;
+   }
+   // scintilla ignores whole word for regular expressions
+   bool bWholeWord = pattern.getIsWholeWord() &&
+                     pattern.getSearchType() != tclPattern::regex &&
+                     pattern.getSearchType() != tclPattern::rgx_multiline;
+   const tclLineIndex& lineIndex = mEngine.getLineIndex();
+   // a regex containing a literal only needs to run where the literal is
+   const tclLiteralFinder* pLiteral = compiled.getRequiredLiteral();
+   bool bLinewise = (pLiteral != 0) && compiled.getIsLineBound();
+   unsigned count = 0;
+   try {
+      // compiled once and kept by the pattern
+      const tclRegex& rx = compiled.getRegex();
+      if (pLiteral && mEngine.findLiteral(*pLiteral, 0, mDocLength) == 0) {
+         return 0;
+      }
+      tiLine pos = 0;
+      tiLine rangeEnd = mDocLength;
+      while (pos <= mDocLength && !isSearchCanceled()) {
+         if (bLinewise) {
+            // next line containing the literal; the match is inside it
+            const char* pHit = (pos < mDocLength) ? mEngine.findLiteral(*pLiteral, pos, mDocLength) : 0;
+            if (pHit == 0) {
+               break;
+            }
+            tiLine line = lineIndex.lineFromPosition((tiLine)(pHit - mpDoc));
+            pos = std::max(pos, lineIndex.positionFromLine(line));
+            rangeEnd = lineIndex.lineEndPosition(line);
+         }
+         tiLine targetStart;
+         tiLine targetEnd;
+         if (!rx.find(mpDoc, mDocLength, pos, rangeEnd, targetStart, targetEnd)) {
+            if (!bLinewise || rangeEnd >= mDocLength) {
+               break;
+            }
+            // behind the line end
+            pos = lineIndex.positionFromLine(lineIndex.lineFromPosition(rangeEnd) + 1);
+            continue;
+         }
+         if (bWholeWord && !isWordAt(targetStart, targetEnd)) {
+            pos = rx.getNextChar(mpDoc, mDocLength, targetStart);
+            continue;
+         }
+         tiLine lineNumberStart = lineIndex.lineFromPosition(targetStart);
+         tiLine lineNumberEnd = lineIndex.lineFromPosition(targetEnd);
+         for (tiLine line = lineNumberStart; line <= lineNumberEnd; ++line) {
+            result.push_back(targetStart, targetEnd, line);
+         }
+         ++count;
+         // empty matches continue behind
+         pos = (targetEnd > targetStart) ? targetEnd : rx.getNextChar(mpDoc, mDocLength, targetEnd);
+      }
+   } catch (const std::runtime_error& e) {
+      // an invalid expression or one too complex for the text
+      addError(pattern, e.what());
+   }
+   return count;
+}
+
+void tclBatchAnalyser::addError(const tclPattern& pattern, const std::string& message)
+{
+#ifdef UNICODE
+   generic_string what(WcharMbcsConvertor::getInstance().char2wchar(message.c_str(), CP_ACP));
+#else
+   generic_string what(message);
+#endif
+   mvErrors.push_back(generic_string(TEXT("Error in pattern [")) + pattern.getSearchText() + TEXT("] ") + what);
+}
+
+tiLine tclBatchAnalyser::writeResult(std::ostream& os, const tclResultList& list)
+{
+   // line and index of the first pattern found in it
+   std::vector<std::pair<tiLine, unsigned> > lines;
+   std::vector<std::string> comments;
+   unsigned iPat = 0;
+   tclResultList::const_iterator iResult = list.begin();
+   for (; iResult != list.end(); ++iResult, ++iPat) {
+      comments.push_back(getDocText(list.getPattern(iResult.getPatId()).getComment()));
+      const tclResult::tlvPosInfo& positions = iResult.getResult().getPositions();
+      tclResult::tlvPosInfo::const_iterator it = positions.begin();
+      for (; it != positions.end(); ++it) {
+         if (lines.size() == 0 || lines.back().first != it->line || lines.back().second != iPat) {
+            lines.push_back(std::make_pair(it->line, iPat));
+         }
+      }
+   }
+   std::stable_sort(lines.begin(), lines.end(),
+      [](const std::pair<tiLine, unsigned>& left, const std::pair<tiLine, unsigned>& right) {
+         return left.first < right.first;
+      });
+   const tclLineIndex& lineIndex = mEngine.getLineIndex();
+   // same column size as in the result window
+   tiLine lineCount = lineIndex.getLineCount();
+   size_t lineNumColSize = 1;
+   for (tiLine i = lineCount; i >= 10; i /= 10) {
+      ++lineNumColSize;
+   }
+   unsigned commentWidth = list.getCommentWidth();
+   std::string s;
+   s.reserve(BATCH_WRITE_BUFFER * 2);
+   tiLine written = 0;
+   char conv[24];
+   for (size_t i = 0; i < lines.size(); ++i) {
+      tiLine line = lines[i].first;
+      if ((i > 0 && lines[i - 1].first == line) || line >= lineCount) {
+         continue;
+      }
+      s.append(BATCH_LINE_HEAD);
+      if (mbDisplayLineNo) {
+         size_t len = (size_t)sprintf(conv, "%lld", (long long)line + 1);
+         if (len < lineNumColSize) {
+            s.append(lineNumColSize - len, ' ');
+         }
+         s.append(conv, len);
+         s.append(BATCH_LINE_COLON);
+      }
+      if (mbDisplayComment) {
+         const std::string& comment = comments[lines[i].second];
+         s.append(comment);
+         if (comment.size() < commentWidth) {
+            s.append(commentWidth - comment.size(), ' ');
+         }
+         s.append(BATCH_LINE_HYPHEN);
+      }
+      tiLine start = lineIndex.positionFromLine(line);
+      tiLine end = lineIndex.lineEndPosition(line);
+      size_t textBegin = s.size();
+      s.append(mpDoc + start, end - start);
+      // zero bytes are shown as spaces like in the result window
+      std::replace(s.begin() + textBegin, s.end(), '\0', ' ');
+      s += '\n';
+      ++written;
+      if (s.size() >= BATCH_WRITE_BUFFER) {
+         os.write(s.data(), s.size());
+         s.clear();
+      }
+   }
+   os.write(s.data(), s.size());
+   return written;
+}
@@ -0,0 +1,144 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclBatchAnalyser searches a result list in a document buffer without any
+editor and writes the found lines as the result window shows them.
+The patterns are searched by tclSearchEngine as in the plugin, those it
+doesn't take with tclRegex, which uses boost as notepad++ does.
+It is used by the command line tool and for files searched on disk.
+*/
+
+#ifndef TCLBATCHANALYSER_H
+#define TCLBATCHANALYSER_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include "tclResultList.h"
+#include "tclSearchEngine.h"
+#include "tclMappedFile.h"
+
+class tclBatchAnalyser : public tclSearchHost {
+public:
+   tclBatchAnalyser();
+
+   /** the host is only asked whether the search is canceled */
+   void setHost(tclSearchHost* pHost) {
+      mpHost = pHost;
+   }
+
+   /**
+   * token checked instead of asking the host, e.g. when analysing on
+   * another thread than the one of the host
+   */
+   void setCancelToken(const tclCancelToken* pToken) {
+      mpCancel = pToken;
+      mEngine.setCancelToken(pToken);
+   }
+
+   /** true if the last analyse() was canceled by the host or the token */
+   bool getCanceled() const {
+      return mbCanceled;
+   }
+
+   /** maximum count of threads used for searching; 0 means one per core */
+   void setMaxThreads(unsigned count) {
+      mEngine.setMaxThreads(count);
+   }
+
+   /** show the line number in front of each line; default on */
+   void setDisplayLineNo(bool bOn) {
+      mbDisplayLineNo = bOn;
+   }
+
+   /** show the comment of the pattern in front of each line; default off */
+   void setDisplayComment(bool bOn) {
+      mbDisplayComment = bOn;
+   }
+
+   /**
+   * search all patterns of list in the utf-8 document. the buffer is not
+   * copied and has to stay valid until the result is written.
+   * @return the count of all found positions
+   */
+   unsigned analyse(tclResultList& list, const char* pDoc, tiLine length);
+
+   /**
+   * same as analyse() for the content of file, pDoc may skip a byte order
+   * mark. the line index of a large file is read from its sidecar, see
+   * tclLineIndexFile, or written into it; the same for its tclNgramIndex.
+   */
+   unsigned analyseFile(tclResultList& list, const char* pDoc, tiLine length, const tclMappedFile& file);
+
+   /**
+   * write every line with at least one position of list once, with the
+   * comment of the first pattern found in it.
+   * @return the count of written lines
+   */
+   tiLine writeResult(std::ostream& os, const tclResultList& list);
+
+   /** line index of the last analysed document */
+   const tclLineIndex& getLineIndex() {
+      return mEngine.getLineIndex();
+   }
+
+   /** messages of patterns which could not be searched */
+   const std::vector<generic_string>& getErrors() const {
+      return mvErrors;
+   }
+
+   // tclSearchHost interface used by mEngine
+   virtual bool isRangeWord(tiLine start, tiLine end);
+   virtual bool isSearchCanceled();
+
+protected:
+   /** start analysing the document */
+   void setDocument(const char* pDoc, tiLine length);
+
+   /** search all patterns of list in the document */
+   unsigned searchList(tclResultList& list);
+
+   /**
+   * search pattern with tclRegex; does the same as
+   * AnalysePlugin::doFindPattern() with scintilla
+   */
+   unsigned findPattern(const tclPattern& pattern, tclResult& result);
+
+   /** keep the message of a regular expression failed for getErrors() */
+   void addError(const tclPattern& pattern, const std::string& message);
+
+   /** text in the utf-8 encoding of the document */
+   static std::string getDocText(const generic_string& text);
+
+   /** scintilla character class as in tclSearchEngine without host */
+   static tclSearchEngine::teCharClass getCharClass(unsigned char c);
+
+   /** true if [start, end) starts and ends at a word edge */
+   bool isWordAt(tiLine start, tiLine end) const;
+
+   tclSearchEngine mEngine;
+   tclSearchHost* mpHost;
+   const tclCancelToken* mpCancel;
+   bool mbCanceled;
+   const char* mpDoc;
+   tiLine mDocLength;
+   bool mbDisplayLineNo;
+   bool mbDisplayComment;
+   std::vector<generic_string> mvErrors;
+};
+#endif //TCLBATCHANALYSER_H
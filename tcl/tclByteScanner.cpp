@@ -0,0 +1,344 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclByteScanner finds the next byte out of a small set in a text, or the
+next pair of bytes out of a larger one
+*/
+#include "tclByteScanner.h"
+#include <string.h>
+#define MDBG_COMP "BytScn:"
+#include "myDebug.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BYTESCANNER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// msvc allows all intrinsics in every function
+#define BYTESCANNER_TARGET_SSE2
+#define BYTESCANNER_TARGET_AVX2
+#else
+// the rest of the build may not assume these instruction sets
+#define BYTESCANNER_TARGET_SSE2 __attribute__((target("sse2")))
+#define BYTESCANNER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+static inline bool isPair(const unsigned* pairBits, const unsigned char* p)
+{
+   const unsigned pair = ((unsigned)p[0] << 8) | p[1];
+   return (pairBits[pair >> 5] & (1u << (pair & 31))) != 0;
+}
+
+#ifdef BYTESCANNER_X86
+static inline unsigned firstBit(unsigned mask)
+{
+#ifdef _MSC_VER
+   unsigned long index;
+   _BitScanForward(&index, mask);
+   return (unsigned)index;
+#else
+   return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+/** first byte equal to one of the N bytes in whole 16 byte blocks of [p, end) */
+template <unsigned N>
+static BYTESCANNER_TARGET_SSE2 const unsigned char* findSse2(const unsigned char* bytes, const unsigned char* p, const unsigned char* end)
+{
+   __m128i needle[N];
+   for (unsigned k = 0; k < N; ++k) {
+      needle[k] = _mm_set1_epi8((char)bytes[k]);
+   }
+   for (; end - p >= 16; p += 16) {
+      const __m128i block = _mm_loadu_si128((const __m128i*)p);
+      __m128i equal = _mm_cmpeq_epi8(block, needle[0]);
+      for (unsigned k = 1; k < N; ++k) {
+         equal = _mm_or_si128(equal, _mm_cmpeq_epi8(block, needle[k]));
+      }
+      const unsigned mask = (unsigned)_mm_movemask_epi8(equal);
+      if (mask != 0) {
+         return p + firstBit(mask);
+      }
+   }
+   return p;
+}
+
+/** same as findSse2() with 32 byte blocks */
+template <unsigned N>
+static BYTESCANNER_TARGET_AVX2 const unsigned char* findAvx2(const unsigned char* bytes, const unsigned char* p, const unsigned char* end)
+{
+   __m256i needle[N];
+   for (unsigned k = 0; k < N; ++k) {
+      needle[k] = _mm256_set1_epi8((char)bytes[k]);
+   }
+   for (; end - p >= 32; p += 32) {
+      const __m256i block = _mm256_loadu_si256((const __m256i*)p);
+      __m256i equal = _mm256_cmpeq_epi8(block, needle[0]);
+      for (unsigned k = 1; k < N; ++k) {
+         equal = _mm256_or_si256(equal, _mm256_cmpeq_epi8(block, needle[k]));
+      }
+      const unsigned mask = (unsigned)_mm256_movemask_epi8(equal);
+      if (mask != 0) {
+         return p + firstBit(mask);
+      }
+   }
+   return p;
+}
+
+/**
+* first pair of pairBits in whole 32 byte blocks of [p, end) followed by
+* one more byte. a byte is in a bucket if both of its nibbles are; a
+* position is a candidate if both bytes of the pair share a bucket.
+*/
+static BYTESCANNER_TARGET_AVX2 const unsigned char* findPairsAvx2(const unsigned char masks[4][16], const unsigned* pairBits,
+                                                                  const unsigned char* p, const unsigned char* end)
+{
+   const __m256i low1 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)masks[0]));
+   const __m256i high1 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)masks[1]));
+   const __m256i low2 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)masks[2]));
+   const __m256i high2 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)masks[3]));
+   const __m256i nibble = _mm256_set1_epi8(0x0F);
+   const __m256i zero = _mm256_setzero_si256();
+   for (; end - p > 32; p += 32) {
+      const __m256i first = _mm256_loadu_si256((const __m256i*)p);
+      const __m256i second = _mm256_loadu_si256((const __m256i*)(p + 1));
+      __m256i buckets = _mm256_and_si256(_mm256_shuffle_epi8(low1, _mm256_and_si256(first, nibble)),
+                                         _mm256_shuffle_epi8(high1, _mm256_and_si256(_mm256_srli_epi16(first, 4), nibble)));
+      buckets = _mm256_and_si256(buckets, _mm256_shuffle_epi8(low2, _mm256_and_si256(second, nibble)));
+      buckets = _mm256_and_si256(buckets, _mm256_shuffle_epi8(high2, _mm256_and_si256(_mm256_srli_epi16(second, 4), nibble)));
+      unsigned mask = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(buckets, zero));
+      // buckets share their nibbles, so the candidates are checked
+      while (mask != 0) {
+         const unsigned i = firstBit(mask);
+         if (isPair(pairBits, p + i)) {
+            return p + i;
+         }
+         mask &= mask - 1;
+      }
+   }
+   return p;
+}
+#endif
+
+static tclByteScanner::teKernel detectKernel()
+{
+#if defined(BYTESCANNER_X86) && defined(_MSC_VER)
+   int info[4];
+   __cpuid(info, 0);
+   const int maxLeaf = info[0];
+   __cpuid(info, 1);
+   const bool bSse2 = (info[3] & (1 << 26)) != 0;
+   // AVX registers have to be saved by the operating system too
+   const bool bAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+                     (_xgetbv(0) & 6) == 6;
+   bool bAvx2 = false;
+   if (bAvx && maxLeaf >= 7) {
+      __cpuidex(info, 7, 0);
+      bAvx2 = (info[1] & (1 << 5)) != 0;
+   }
+   return bAvx2 ? tclByteScanner::kernelAvx2 : bSse2 ? tclByteScanner::kernelSse2 : tclByteScanner::kernelScalar;
+#elif defined(BYTESCANNER_X86)
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2")) {
+      return tclByteScanner::kernelAvx2;
+   }
+   if (__builtin_cpu_supports("sse2")) {
+      return tclByteScanner::kernelSse2;
+   }
+   return tclByteScanner::kernelScalar;
+#else
+   return tclByteScanner::kernelScalar;
+#endif
+}
+
+static tclByteScanner::teKernel gKernel = tclByteScanner::getSupportedKernel();
+
+tclByteScanner::tclByteScanner()
+   : mCount(0)
+   , mWidth(1)
+{
+   memset(mBytes, 0, sizeof(mBytes));
+   memset(mIsInSet, 0, sizeof(mIsInSet));
+   memset(mPairMasks, 0, sizeof(mPairMasks));
+}
+
+bool tclByteScanner::setBytes(const unsigned char* bytes, unsigned count)
+{
+   memset(mIsInSet, 0, sizeof(mIsInSet));
+   mvPairBits.clear();
+   mCount = 0;
+   for (unsigned i = 0; i < count; ++i) {
+      if (!mIsInSet[bytes[i]]) {
+         mIsInSet[bytes[i]] = true;
+         if (mCount < BYTESCANNER_MAX_BYTES) {
+            mBytes[mCount] = bytes[i];
+         }
+         ++mCount;
+      }
+   }
+   if (mCount > BYTESCANNER_MAX_BYTES) {
+      return false;
+   }
+   // the kernels compare a fixed count of bytes
+   mWidth = (mCount <= 1) ? 1 : (mCount <= 2) ? 2 : (mCount <= 4) ? 4 : 8;
+   for (unsigned i = mCount; i < BYTESCANNER_MAX_BYTES; ++i) {
+      mBytes[i] = mBytes[0];
+   }
+   return true;
+}
+
+void tclByteScanner::setPairs(const std::vector<bool>& pairs)
+{
+   memset(mIsInSet, 0, sizeof(mIsInSet));
+   memset(mPairMasks, 0, sizeof(mPairMasks));
+   mvPairBits.assign(BYTESCANNER_PAIRS / 32, 0);
+   mCount = 0;
+   mWidth = 1;
+   // a first byte followed by any byte gets the last bucket, which matches
+   // every follower; the others are spread over the rest, the cases of a
+   // letter together as they only differ in the high nibble
+   unsigned char bucketOf[256];
+   unsigned nextBucket = 0;
+   for (unsigned first = 0; first < 256; ++first) {
+      unsigned followers = 0;
+      for (unsigned second = 0; second < 256; ++second) {
+         followers += pairs[first * 256 + second] ? 1 : 0;
+      }
+      if (followers == 0) {
+         continue;
+      }
+      mIsInSet[first] = true;
+      ++mCount;
+      if (followers == 256) {
+         bucketOf[first] = 7;
+      } else if (first >= 'a' && first <= 'z' && mIsInSet[first - 'a' + 'A'] && bucketOf[first - 'a' + 'A'] != 7) {
+         bucketOf[first] = bucketOf[first - 'a' + 'A'];
+      } else {
+         bucketOf[first] = (unsigned char)(nextBucket++ % 7);
+      }
+   }
+   for (unsigned pair = 0; pair < BYTESCANNER_PAIRS; ++pair) {
+      if (!pairs[pair]) {
+         continue;
+      }
+      mvPairBits[pair >> 5] |= 1u << (pair & 31);
+      const unsigned char bit = (unsigned char)(1 << bucketOf[pair >> 8]);
+      mPairMasks[0][(pair >> 8) & 0x0F] |= bit;
+      mPairMasks[1][pair >> 12] |= bit;
+      mPairMasks[2][pair & 0x0F] |= bit;
+      mPairMasks[3][(pair >> 4) & 0x0F] |= bit;
+   }
+}
+
+const unsigned char* tclByteScanner::find(const unsigned char* p, const unsigned char* end) const
+{
+   if (!mvPairBits.empty()) {
+      if (mCount == 0 || p >= end) {
+         return end;
+      }
+#ifdef BYTESCANNER_X86
+      if (gKernel == kernelAvx2) {
+         p = findPairsAvx2(mPairMasks, &mvPairBits[0], p, end);
+      }
+#endif
+      return findPairsScalar(p, end);
+   }
+   if (mCount == 0 || p >= end) {
+      return end;
+   }
+   if (mCount > BYTESCANNER_MAX_BYTES) {
+      return p;
+   }
+   if (mCount == 1) {
+      // the C library has its own vectorised search
+      const void* hit = memchr(p, mBytes[0], end - p);
+      return hit ? (const unsigned char*)hit : end;
+   }
+   switch (gKernel) {
+#ifdef BYTESCANNER_X86
+   case kernelAvx2:
+      p = (mWidth == 2) ? findAvx2<2>(mBytes, p, end) :
+          (mWidth == 4) ? findAvx2<4>(mBytes, p, end) : findAvx2<8>(mBytes, p, end);
+      if (end - p >= 32) {
+         return p;
+      }
+      break;
+   case kernelSse2:
+      p = (mWidth == 2) ? findSse2<2>(mBytes, p, end) :
+          (mWidth == 4) ? findSse2<4>(mBytes, p, end) : findSse2<8>(mBytes, p, end);
+      if (end - p >= 16) {
+         return p;
+      }
+      break;
+#endif
+   default:
+      break;
+   }
+   // the rest behind the last whole block
+   return findScalar(p, end);
+}
+
+const unsigned char* tclByteScanner::findScalar(const unsigned char* p, const unsigned char* end) const
+{
+   while (p < end && !mIsInSet[*p]) {
+      ++p;
+   }
+   return p;
+}
+
+const unsigned char* tclByteScanner::findPairsScalar(const unsigned char* p, const unsigned char* end) const
+{
+   const unsigned* pairBits = &mvPairBits[0];
+   for (; end - p > 1; ++p) {
+      if (isPair(pairBits, p)) {
+         return p;
+      }
+   }
+   // the follower of the last byte is unknown
+   return (p < end && mIsInSet[*p]) ? p : end;
+}
+
+tclByteScanner::teKernel tclByteScanner::getKernel()
+{
+   return gKernel;
+}
+
+void tclByteScanner::setKernel(teKernel kernel)
+{
+   gKernel = (kernel < getSupportedKernel()) ? kernel : getSupportedKernel();
+   DBGA1("setKernel() %s", getKernelName(gKernel));
+}
+
+tclByteScanner::teKernel tclByteScanner::getSupportedKernel()
+{
+   static const teKernel supported = detectKernel();
+   return supported;
+}
+
+const char* tclByteScanner::getKernelName(teKernel kernel)
+{
+   switch (kernel) {
+   case kernelAvx2:
+      return "avx2";
+   case kernelSse2:
+      return "sse2";
+   default:
+      return "scalar";
+   }
+}
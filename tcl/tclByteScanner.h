@@ -0,0 +1,96 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclByteScanner finds the next byte out of a small set in a text. It
+compares 16 (SSE2) or 32 (AVX2) bytes at once; the instruction set is
+chosen once at run time from what the processor supports. Used to skip
+the text in front of a possible literal start.
+More different bytes are looked for as pairs of a byte and its follower,
+e.g. the first two bytes of many literals. AVX2 finds the candidates by
+nibble masks of eight buckets of pairs, all kernels check them in a
+bitmap of all pairs.
+*/
+
+#ifndef TCLBYTESCANNER_H
+#define TCLBYTESCANNER_H
+
+#include <vector>
+
+// more bytes are not worth comparing one after the other
+#define BYTESCANNER_MAX_BYTES 8
+// count of pairs of a byte and its follower
+#define BYTESCANNER_PAIRS (256*256)
+
+class tclByteScanner {
+public:
+   enum teKernel {
+      kernelScalar = 0,
+      kernelSse2,
+      kernelAvx2
+   };
+
+   tclByteScanner();
+
+   /**
+   * the bytes to look for, duplicates are ignored. returns false if there
+   * are more than BYTESCANNER_MAX_BYTES; find() then stops at every byte.
+   */
+   bool setBytes(const unsigned char* bytes, unsigned count);
+
+   /**
+   * look for pairs of a byte and its follower instead; pairs has
+   * BYTESCANNER_PAIRS flags indexed by first byte * 256 + follower.
+   * the last byte of a range is found if any pair starts with it.
+   */
+   void setPairs(const std::vector<bool>& pairs);
+
+   unsigned getCount() const {
+      return mCount;
+   }
+
+   /** true if find() skips bytes, i.e. not with too many single bytes */
+   bool getIsSkipping() const {
+      return mCount <= BYTESCANNER_MAX_BYTES || !mvPairBits.empty();
+   }
+
+   /** first byte of the set or of a pair in [p, end), end if there is none */
+   const unsigned char* find(const unsigned char* p, const unsigned char* end) const;
+
+   /** kernel used by all scanners; the best one of the processor by default */
+   static teKernel getKernel();
+
+   /** use another kernel, e.g. for comparing them; limited to the supported ones */
+   static void setKernel(teKernel kernel);
+
+   /** best kernel supported by the processor, detected once */
+   static teKernel getSupportedKernel();
+
+   static const char* getKernelName(teKernel kernel);
+
+protected:
+   const unsigned char* findScalar(const unsigned char* p, const unsigned char* end) const;
+   const unsigned char* findPairsScalar(const unsigned char* p, const unsigned char* end) const;
+
+   unsigned char mBytes[BYTESCANNER_MAX_BYTES]; // padded with the first one
+   unsigned mCount;
+   unsigned mWidth;           // 1, 2, 4 or 8 compares per block
+   bool mIsInSet[256];        // or the first byte of a pair
+   std::vector<unsigned> mvPairBits; // one bit per pair, empty without pairs
+   unsigned char mPairMasks[4][16]; // buckets of the low and high nibbles of both bytes
+};
+#endif //TCLBYTESCANNER_H
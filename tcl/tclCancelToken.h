@@ -0,0 +1,49 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclCancelToken tells a running search to stop. Setting and polling it is
+one atomic access, so every scanning thread may poll it as often as it
+likes and any thread may cancel.
+*/
+
+#ifndef TCLCANCELTOKEN_H
+#define TCLCANCELTOKEN_H
+
+#include <atomic>
+
+class tclCancelToken {
+public:
+   tclCancelToken() : mbCanceled(false) {}
+
+   void cancel() {
+      mbCanceled.store(true, std::memory_order_relaxed);
+   }
+
+   /** only while no search polls it */
+   void reset() {
+      mbCanceled.store(false, std::memory_order_relaxed);
+   }
+
+   bool getIsCanceled() const {
+      return mbCanceled.load(std::memory_order_relaxed);
+   }
+
+protected:
+   std::atomic<bool> mbCanceled;
+};
+#endif //TCLCANCELTOKEN_H
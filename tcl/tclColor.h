@@ -21,9 +21,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #ifndef TCL_COLOUR_H
 #define TCL_COLOUR_H
 
-#include <windows.h>
 #include <assert.h>
-#include "Common.h"
+#include "platform.h"
 
 
 typedef unsigned long tColor; // allows to store all RGB values between ffffff an 000000
@@ -0,0 +1,291 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclCompiledPattern is the search text of a tclPattern prepared for one
+document code page
+*/
+#include "tclCompiledPattern.h"
+#include "tclSearchEngine.h"
+#include <string.h>
+#include <stdlib.h>
+#include "Scintilla.h"
+#define MDBG_COMP "CmpPat:"
+#include "myDebug.h"
+
+tclCompiledPattern::tclCompiledPattern(const tclPattern& pattern, unsigned codePage)
+   : mSearchText(pattern.getSearchText())
+   , mSearchType(pattern.getSearchType())
+   , mbMatchCase(pattern.getIsMatchCase())
+   , mbWholeWord(pattern.getIsWholeWord())
+   , mCodePage(codePage)
+   , mbLineBound(tclSearchEngine::isLineBound(pattern))
+{
+   generic_string text = pattern.getSearchTextConverted();
+#ifdef UNICODE
+   WcharMbcsConvertor& wmc = WcharMbcsConvertor::getInstance();
+   // the converter reuses its buffer, so copy immediately
+   mText = wmc.wchar2char(text.c_str(), codePage);
+#else
+   // up to the terminator convertExtendedToString() appends for escaped texts
+   mText = text.c_str();
+#endif
+   if (mSearchType == tclPattern::regex || mSearchType == tclPattern::rgx_multiline) {
+      std::string literal = getRequiredLiteralText(getRegexText(mSearchType, mText));
+      if (!mbMatchCase && codePage == SC_CP_UTF8) {
+         // boost folds the kelvin sign to k and the capital I with dot above
+         // to i, so the literal is the longest part without these letters
+         std::string part;
+         size_t begin = 0;
+         while (begin <= literal.size()) {
+            size_t end = literal.find_first_of("kKiI", begin);
+            if (end == std::string::npos) {
+               end = literal.size();
+            }
+            if (end - begin > part.size()) {
+               part = literal.substr(begin, end - begin);
+            }
+            begin = end + 1;
+         }
+         literal.swap(part);
+      }
+      // regex engines fold the case of other characters too
+      bool bAscii = true;
+      for (size_t i = 0; i < literal.size(); ++i) {
+         bAscii = bAscii && ((unsigned char)literal[i] < 0x80);
+      }
+      if (literal.size() >= COMPILEDPATTERN_MIN_LITERAL && (mbMatchCase || bAscii)) {
+         DBGA1("tclCompiledPattern() required literal %s", literal.c_str());
+         mpRequiredLiteral.reset(new tclLiteralFinder(literal, mbMatchCase));
+      }
+   }
+}
+
+bool tclCompiledPattern::isFor(const tclPattern& pattern, unsigned codePage) const
+{
+   return (mCodePage == codePage) &&
+          (mSearchType == pattern.getSearchType()) &&
+          (mbMatchCase == pattern.getIsMatchCase()) &&
+          (mbWholeWord == pattern.getIsWholeWord()) &&
+          (mSearchText == pattern.getSearchText());
+}
+
+const tclRegex& tclCompiledPattern::getRegex() const
+{
+   if (!mpRegex) {
+      DBGW1("getRegex() compile %s", mSearchText.c_str());
+      // boost knows the word edges \< and \> of scintilla and lets . match line ends by a flag
+      const bool bRegex = (mSearchType == tclPattern::regex || mSearchType == tclPattern::rgx_multiline);
+      mpRegex.reset(new tclRegex(bRegex ? mText : getRegexText(mSearchType, mText), mCodePage, mbMatchCase,
+                                 mSearchType == tclPattern::rgx_multiline));
+   }
+   return *mpRegex;
+}
+
+std::string tclCompiledPattern::getRegexText(tclPattern::teSearchType searchType, const std::string& text)
+{
+   std::string s;
+   s.reserve(text.size() * 2);
+   if (searchType != tclPattern::regex && searchType != tclPattern::rgx_multiline) {
+      // literal text
+      for (size_t i = 0; i < text.size(); ++i) {
+         if (strchr("\\^$.|?*+()[]{}", text[i]) != 0) {
+            s += '\\';
+         }
+         s += text[i];
+      }
+      return s;
+   }
+   bool bDotMatchesNl = (searchType == tclPattern::rgx_multiline);
+   bool bInClass = false;
+   for (size_t i = 0; i < text.size(); ++i) {
+      char c = text[i];
+      if (c == '\\' && i + 1 < text.size()) {
+         char next = text[++i];
+         if (!bInClass && (next == '<' || next == '>')) {
+            // word start and end of scintilla
+            s += "\\b";
+         } else {
+            s += c;
+            s += next;
+         }
+      } else if (bInClass) {
+         size_t end;
+         if (c == '[' && i + 1 < text.size() && text[i + 1] == ':' &&
+             (end = text.find(":]", i + 2)) != std::string::npos) {
+            // character class name like [:alpha:]
+            s.append(text, i, end + 2 - i);
+            i = end + 1;
+         } else {
+            bInClass = (c != ']');
+            s += c;
+         }
+      } else if (c == '[') {
+         bInClass = true;
+         s += c;
+         // a ] directly behind the opening one belongs to the class
+         if (i + 1 < text.size() && text[i + 1] == '^') {
+            s += text[++i];
+         }
+         if (i + 1 < text.size() && text[i + 1] == ']') {
+            s += text[++i];
+         }
+      } else if (c == '.' && bDotMatchesNl) {
+         s += "[\\s\\S]";
+      } else {
+         s += c;
+      }
+   }
+   return s;
+}
+
+/** end of the group or class starting at i, npos if it is not closed */
+static size_t skipBracket(const std::string& rx, size_t i)
+{
+   if (rx[i] == '[') {
+      size_t j = i + 1;
+      if (j < rx.size() && rx[j] == '^') {
+         ++j;
+      }
+      if (j < rx.size() && rx[j] == ']') {
+         ++j;
+      }
+      for (; j < rx.size(); ++j) {
+         if (rx[j] == '\\') {
+            ++j;
+         } else if (rx[j] == '[' && j + 1 < rx.size() && rx[j + 1] == ':') {
+            size_t end = rx.find(":]", j + 2);
+            if (end == std::string::npos) {
+               return std::string::npos;
+            }
+            j = end + 1;
+         } else if (rx[j] == ']') {
+            return j;
+         }
+      }
+      return std::string::npos;
+   }
+   int depth = 0;
+   for (size_t j = i; j < rx.size(); ++j) {
+      if (rx[j] == '\\') {
+         ++j;
+      } else if (rx[j] == '[') {
+         j = skipBracket(rx, j);
+         if (j == std::string::npos) {
+            return j;
+         }
+      } else if (rx[j] == '(') {
+         ++depth;
+      } else if (rx[j] == ')' && --depth == 0) {
+         return j;
+      }
+   }
+   return std::string::npos;
+}
+
+std::string tclCompiledPattern::getRequiredLiteralText(const std::string& rx)
+{
+   std::string best;
+   std::string run;
+   size_t i = 0;
+   while (i < rx.size()) {
+      // one atom, a literal character or anything else
+      char c = rx[i];
+      bool bLiteral = false;
+      size_t next = i + 1;
+      if (c == '\\') {
+         if (i + 1 >= rx.size()) {
+            return std::string();
+         }
+         char e = rx[i + 1];
+         next = i + 2;
+         if (strchr("\\^$.|?*+()[]{}/-", e) != 0) {
+            bLiteral = true;
+            c = e;
+         } else if (strchr("QEkgNpPX", e) != 0 || (e == 'x' && i + 2 < rx.size() && rx[i + 2] == '{')) {
+            // quoting, named references and unicode properties of boost
+            return std::string();
+         } else if (e == 'x') {
+            next += 2;
+         } else if (e == 'u') {
+            next += 4;
+         } else if (e == 'c') {
+            next += 1;
+         } else {
+            // classes, assertions and back references
+            while (e >= '0' && e <= '9' && next < rx.size() && rx[next] >= '0' && rx[next] <= '9') {
+               ++next;
+            }
+         }
+      } else if (c == '(' && i + 1 < rx.size() && (rx[i + 1] == '?' || rx[i + 1] == '*') &&
+                 rx.compare(i, 3, "(?:") != 0 && rx.compare(i, 3, "(?=") != 0 && rx.compare(i, 3, "(?!") != 0 &&
+                 rx.compare(i, 4, "(?<=") != 0 && rx.compare(i, 4, "(?<!") != 0) {
+         // inline flags like (?i) or (?x) change the meaning of the rest
+         return std::string();
+      } else if (c == '[' || c == '(') {
+         size_t end = skipBracket(rx, i);
+         if (end == std::string::npos) {
+            return std::string();
+         }
+         next = end + 1;
+      } else if (c == '|' || c == ')') {
+         // alternatives of the whole expression have nothing in common
+         return std::string();
+      } else if (c != '.' && c != '^' && c != '$') {
+         bLiteral = true;
+      }
+      // quantifier of the atom
+      bool bOptional = false;
+      bool bRepeated = false;
+      if (next < rx.size()) {
+         char q = rx[next];
+         if (q == '*' || q == '?') {
+            bOptional = true;
+            ++next;
+         } else if (q == '+') {
+            bRepeated = true;
+            ++next;
+         } else if (q == '{') {
+            size_t end = rx.find('}', next);
+            if (end == std::string::npos) {
+               return std::string();
+            }
+            bOptional = (atoi(rx.c_str() + next + 1) == 0);
+            bRepeated = true;
+            next = end + 1;
+         }
+         if ((bOptional || bRepeated) && next < rx.size() && rx[next] == '?') {
+            // lazy
+            ++next;
+         }
+      }
+      if (bLiteral && !bOptional) {
+         run += c;
+      }
+      if (!bLiteral || bOptional || bRepeated) {
+         if (run.size() > best.size()) {
+            best = run;
+         }
+         run.clear();
+      }
+      i = next;
+   }
+   if (run.size() > best.size()) {
+      best = run;
+   }
+   return best;
+}
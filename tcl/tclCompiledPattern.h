@@ -0,0 +1,89 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclCompiledPattern is the search text of a tclPattern prepared for one
+document code page. A pattern keeps it until one of its search relevant
+fields or the code page changes, so searching again after a modification
+or in another document does not convert or compile anything.
+*/
+
+#ifndef TCLCOMPILEDPATTERN_H
+#define TCLCOMPILEDPATTERN_H
+
+#include <string>
+#include <memory>
+#include "tclPattern.h"
+#include "tclLiteralFinder.h"
+#include "tclRegex.h"
+
+// shorter required literals hit too often to skip any text
+#define COMPILEDPATTERN_MIN_LITERAL 2
+
+class tclCompiledPattern {
+public:
+   tclCompiledPattern(const tclPattern& pattern, unsigned codePage);
+
+   /** true if built from the same search fields and code page */
+   bool isFor(const tclPattern& pattern, unsigned codePage) const;
+
+   /** search text with resolved escapes in the code page of the document */
+   const std::string& getText() const {
+      return mText;
+   }
+
+   /**
+   * the search text as tclRegex, a literal one escaped; compiled on first
+   * use. throws std::runtime_error for an invalid expression.
+   */
+   const tclRegex& getRegex() const;
+
+   /**
+   * finder of a literal every match of a regular expression contains,
+   * 0 if there is none or the pattern is no regular expression
+   */
+   const tclLiteralFinder* getRequiredLiteral() const {
+      return mpRequiredLiteral.get();
+   }
+
+   /** true if no match can contain a line end */
+   bool getIsLineBound() const {
+      return mbLineBound;
+   }
+
+   /** convert a search text of the given type into ECMAScript syntax */
+   static std::string getRegexText(tclPattern::teSearchType searchType, const std::string& text);
+
+   /**
+   * the longest literal every match of an ECMAScript expression contains,
+   * empty if there is none. alternatives, groups and classes are skipped;
+   * inline flags and other perl constructs not parsed here give none.
+   */
+   static std::string getRequiredLiteralText(const std::string& regexText);
+
+protected:
+   generic_string mSearchText;
+   tclPattern::teSearchType mSearchType;
+   bool mbMatchCase;
+   bool mbWholeWord;
+   unsigned mCodePage;
+   std::string mText;
+   bool mbLineBound;
+   std::unique_ptr<tclLiteralFinder> mpRequiredLiteral;
+   mutable std::unique_ptr<tclRegex> mpRegex;
+};
+#endif //TCLCOMPILEDPATTERN_H
@@ -0,0 +1,70 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclEditRange merges the text modifications since the last search
+*/
+#include "tclEditRange.h"
+
+tclEditRange::tclEditRange()
+   : mbValid(false)
+   , mbModified(false)
+   , mStart(0)
+   , mOldEnd(0)
+   , mDelta(0)
+   , mLinesAdded(0)
+{}
+
+void tclEditRange::reset()
+{
+   mbValid = true;
+   mbModified = false;
+   mStart = 0;
+   mOldEnd = 0;
+   mDelta = 0;
+   mLinesAdded = 0;
+}
+
+void tclEditRange::invalidate()
+{
+   reset();
+   mbValid = false;
+}
+
+void tclEditRange::addModification(tiLine position, tiLine length, bool bInsert, tiLine linesAdded)
+{
+   if (!mbValid) {
+      return;
+   }
+   // range of the actual document being replaced
+   tiLine end = position + (bInsert ? 0 : length);
+   if (!mbModified) {
+      mStart = position;
+      mOldEnd = end;
+   } else {
+      // the range covers both modifications and the text in between
+      if (end > getNewEnd()) {
+         mOldEnd = end - mDelta;
+      }
+      if (position < mStart) {
+         mStart = position;
+      }
+   }
+   mbModified = true;
+   mDelta += bInsert ? length : -length;
+   mLinesAdded += linesAdded;
+}
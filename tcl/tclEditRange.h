@@ -0,0 +1,89 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclEditRange collects the text modifications of the document since the
+last search into one modified range. Text in front of the range is the
+same as before; text behind it is moved by getDelta() characters and
+getLinesAdded() lines.
+*/
+
+#ifndef TCLEDITRANGE_H
+#define TCLEDITRANGE_H
+
+#include "tclPosInfo.h"
+
+class tclEditRange {
+public:
+   tclEditRange();
+
+   /** document is the same as at the last search */
+   void reset();
+
+   /** modifications are unknown; the next search has to be done completely */
+   void invalidate();
+
+   /**
+   * add a modification as reported by SCN_MODIFIED. position and length
+   * are those of the actual document, linesAdded is negative on deletion
+   */
+   void addModification(tiLine position, tiLine length, bool bInsert, tiLine linesAdded);
+
+   /** true if the modified range is known */
+   bool getIsValid() const {
+      return mbValid;
+   }
+
+   /** true if any text has been modified since reset() */
+   bool getIsModified() const {
+      return mbModified;
+   }
+
+   /** first modified position; same in the former and the actual document */
+   tiLine getStart() const {
+      return mStart;
+   }
+
+   /** end of the modified range in the former document */
+   tiLine getOldEnd() const {
+      return mOldEnd;
+   }
+
+   /** end of the modified range in the actual document */
+   tiLine getNewEnd() const {
+      return mOldEnd + mDelta;
+   }
+
+   /** count of characters the text behind the range has been moved */
+   tiLine getDelta() const {
+      return mDelta;
+   }
+
+   /** count of lines the text behind the range has been moved */
+   tiLine getLinesAdded() const {
+      return mLinesAdded;
+   }
+
+protected:
+   bool mbValid;
+   bool mbModified;
+   tiLine mStart;
+   tiLine mOldEnd;
+   tiLine mDelta;
+   tiLine mLinesAdded;
+};
+#endif //TCLEDITRANGE_H
@@ -18,7 +18,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 /* tclFindResultDlg.cpp 
 This class implements the handling of the search result window 
 it mainly contains the view based on scintilla and maintains parallel stored
-search result string cache
+search result string cache. the view only holds the lines around the visible
+ones, all others are taken out of the cache when they are scrolled in
 */
 //#include "stdafx.h"
 #include "FindDlg.h"
@@ -30,6 +31,10 @@ search result string cache
 #include "tclFindResultDoc.h"
 #include "tclFindResultDlg.h"
 #include <commdlg.h>// For fileopen dialog.
+#include <Shlwapi.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
 #define MDBG_COMP "FRDlg:" 
 #include "myDebug.h"
 #include "resource.h"
@@ -41,14 +46,32 @@ search result string cache
 #define FNDRESDLG_LINE_HYPHEN "| "
 #define FNDRESDLG_DEFAULT_STYLE STYLE_DEFAULT // style number for the default styling
 #define FNDRESDLG_ACTIVATE_SEARCH 0x06
+// posted to move the window after scrolling; scintilla is painting when it
+// notifies the scrolling and the text can't be exchanged in there
+#define FNDRESDLG_UPDATE_WINDOW (FNDRESDLG_BASE + 0x20)
+// lines written at once into the result file
+#define FNDRESDLG_SAVE_CHUNK_LINES 4096
+// indicators colouring the hits in the main window if notepad++ can't
+// allocate them; notepad++ uses 21 to 31
+#define FNDRESDLG_INDIC_FORE 16
+#define FNDRESDLG_INDIC_BACK 17
+#ifndef NPPM_ALLOCATEINDICATOR
+// since notepad++ 8.5.6
+#define NPPM_ALLOCATEINDICATOR (NPPMSG + 113)
+#endif
+// lines above and below the screen coloured in the main window
+#define FNDRESDLG_HIGHLIGHT_MARGIN 50
+
+// files searched on disk from this size on are only opened after asking
+#define FNDRESDLG_OPEN_WARN_SIZE (256LL*1024*1024)
 
 #ifdef UNICODE
-#define filestat _wstat
+#define filestat _wstat64
 #else
-#define filestat _stat
+#define filestat _stat64
 #endif
 // available style id -> sub sequent 0-based index
-// counter definition is ScintillaSearchView::transStylePos for clipboard colors
+// the rtf colour table follows this order, see initExport()
 const int tclFindResultDlg::transStyleIdTab[MY_STYLE_COUNT] = {
         1,  2,  3,  4,  5,  6,  7,  8,  9, // STYLE_DEFAULT is for default color
    10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
@@ -87,7 +110,6 @@ int tclFindResultDlg::transStyleId(unsigned int id) const {
       return STYLE_DEFAULT;
    }
 }
-tlpLinePosInfo tclFindResultDoc::mDefLineInfo = tlpLinePosInfo();
 
 tclFindResultDlg::tclFindResultDlg() 
    : DockingDlgInterface(IDD_FIND_DLG_RESULT)
@@ -104,8 +126,25 @@ tclFindResultDlg::tclFindResultDlg()
 #endif
    , mFromMainWindow(false)
    , mFromFindResult(false)
+   , mbBulkUpdate(false)
+   , mCommentWidth(0)
+   , mbOnDiskMode(false)
+   , mbWindowDirty(false)
+   , mbWindowUpdatePosted(false)
+   , mbPageSearch(false)
+   , mPageSearchTop(0)
+   , mViewTop(0)
+   , mhScrollBar(0)
+   , mViewAnchor(0)
+   , mViewCaret(0)
+   , mbHighlightMain(true)
+   , mHighlightFirst(0)
+   , mHighlightEnd(0)
+   , mIndicFore(FNDRESDLG_INDIC_FORE)
+   , mIndicBack(FNDRESDLG_INDIC_BACK)
 {
    _ResAdditionalInfo[0] = 0;
+   resetSelection();
 }
 
 tclFindResultDlg::~tclFindResultDlg() {
@@ -132,15 +171,17 @@ int tclFindResultDlg::getLineNumColSize() const {
 void tclFindResultDlg::initEdit(const tclPattern& defaultPattern) {
    _scintView.init(_hInst, _hSelf);
    _scintView.display();
-   setFinderReadOnly(true);
-   RECT rect;
-   getClientRect(rect);
-   _scintView.reSizeToWH(rect);
+   // scintilla only knows the lines in the window, so the scroll bar is ours
+   _scintView.execute(SCI_SETVSCROLLBAR, false);
+   mhScrollBar = ::CreateWindowEx(0, TEXT("SCROLLBAR"), NULL, WS_CHILD | WS_VISIBLE | SBS_VERT,
+                                  0, 0, 0, 0, _hSelf, NULL, _hInst, NULL);
+   // the numbers of the result lines are set per line into the margin
+   _scintView.execute(SCI_SETMARGINTYPEN, ScintillaSearchView::_SC_MARGE_LINENUMBER, SC_MARGIN_RTEXT);
+   layoutView();
    //_scintView.execute(SCI_SETCODEPAGE, SC_CP_UTF8);
-   // let window parent (this class) do the styling
-   _scintView.execute(SCI_SETILEXER,SCLEX_CONTAINER);
+   initDocument();
 // deprecated, always 8   _scintView.execute(SCI_SETSTYLEBITS, MY_STYLE_BITS); // maximum possible
-   mFindResultSearchDlg.init(_hInst, _hParent, &_scintView);
+   mFindResultSearchDlg.init(_hInst, _hParent, &_scintView, this);
    mFindResultSearchDlg.setdefaultPattern(defaultPattern);
    mFindResultSearchDlg.create(IDD_FIND_RES_DLG_SEARCH);
 }
@@ -150,72 +191,40 @@ void tclFindResultDlg::removeUnusedResultLines(tPatId pattId, const tclResult& o
 {
    DBG2("removeUnusedResultLines() oldResult.size() %d newResult.size() %d.", 
       oldResult.size(), newResult.size());
+   // lines of the old result, they are sorted because the positions are
+   tlvLine lines;
+   lines.reserve(oldResult.size());
    for(int iResultEntry = 0; iResultEntry < (int)oldResult.size();++iResultEntry)
    {
       tiLine thisLine = oldResult.getPosition(iResultEntry).line;
-      // line not used in this result remove my link in it
-      if(mFindResults.getLineAtMainAvail(thisLine)) {
-         // if line is already removed don't remove it again
-         tclLinePosInfo& l = mFindResults.refLineAtMain(thisLine);
-         l.posInfos().erase(pattId);
-         // lets check if other results use the line and remove if not
-         if(l.posInfos().size() == 0) {
-            tiLine resultLine = mFindResults.getLineNoAtRes(thisLine);
-            if(resultLine >= 0) {
-               if(mUseBookmark){
-                  _pParent->execute(teNppWindows::scnActiveHandle, SCI_MARKERDELETE, thisLine, _pParent->getBookmarkId());
-               }
-               tiLine startL = (tiLine)_scintView.execute(SCI_POSITIONFROMLINE, resultLine);
-               tiLine endL = (tiLine)_scintView.execute(SCI_GETLINEENDPOSITION, resultLine);
-               if (endL+2 <= _scintView.execute(SCI_GETLENGTH)) {
-                  endL += 2;
-               }
-               DBG4("removeUnusedResultLines() removing line %d from %d to %d being main line %d", (int)resultLine, (int)startL, (int)endL, (int)thisLine);
-               if(endL <= startL) {
-                  ::MessageBox(0, TEXT("Line delete in result not correct"), TEXT("Analyse Plugin - Error"), 0);
-               } else {
-                  setFinderReadOnly(false);
-                  _scintView.execute(SCI_SETTARGETSTART, startL);
-                  _scintView.execute(SCI_SETTARGETEND, endL);
-                  //SCI_REPLACETARGET(int length, const char *text)
-                  _scintView.execute(SCI_REPLACETARGET, 0, (LPARAM)"");
-                  DBG2("removeUnusedResultLines() tstart %d, tend %d.", (int)startL, (int)endL);
-                  setFinderReadOnly(true);
-               }
-            } else {
-               TCHAR num[20];
-               ::MessageBox(0, TEXT("The line was not in ?"), generic_i64toa(resultLine, num, 10), MB_OK);
-            }
-            mFindResults.erase(thisLine);
-         } else {
-            DBG2("removeUnusedResultLines() found line %d result not empty size %d", (int)thisLine, (int)l.posInfos().size());
-#ifdef _DEBUG
-            TCHAR num[20];
-            generic_string s;
-            tlmIdxPosInfo::const_iterator i = l.posInfos().begin();
-            wsprintf(num,TEXT("%3.10f"),i->first);
-            s.append(num);
-            for(; i != l.posInfos().end(); ++i) {
-               s.append(TEXT(", "));
-               wsprintf(num,TEXT("%3.10f"),i->first);
-               s.append(num);
-            }
-            DBGW1("removeUnusedResultLines() patterns are: %s.",s.c_str()); 
-#endif
-            //int line = mFindResults.getLineNoAtRes(thisLine);
-            //int startL = (int)_scintView.execute(SCI_POSITIONFROMLINE, line);
-            //int endL = (int)_scintView.execute(SCI_GETLINEENDPOSITION, line);
-            //doStyle(line, startL, endL);
-         }
-      } else {
-         DBG1("removeUnusedResultLines() found line %d already removed", thisLine);
+      if (lines.size() == 0 || lines.back() != thisLine) {
+         lines.push_back(thisLine);
       }
    }
-   // clean markup
-   _scintView.execute(SCI_SETSEL, -1);
-   // update colors
-   _scintView.execute(SCI_COLOURISE, 0, -1);
-   _scintView.redraw();
+   // line not used in this result remove my link in it
+   tlvLine emptyLines;
+   mFindResults.removePosInfos(pattId, lines, emptyLines);
+   if(mUseBookmark && !mbOnDiskMode){
+      for (tlvLine::const_iterator iLine = emptyLines.begin(); iLine != emptyLines.end(); ++iLine) {
+         _pParent->execute(teNppWindows::scnActiveHandle, SCI_MARKERDELETE, *iLine, _pParent->getBookmarkId());
+      }
+   }
+   if (emptyLines.size() == 0) {
+      return;
+   }
+   // the view gets the remaining lines with the next updateWindow()
+   mFindResults.eraseLines(emptyLines);
+   mbWindowDirty = true;
+}
+
+void tclFindResultDlg::colouriseVisible()
+{
+   tiLine firstLine = (tiLine)_scintView.execute(SCI_DOCLINEFROMVISIBLE, _scintView.execute(SCI_GETFIRSTVISIBLELINE));
+   tiLine lastLine = (tiLine)_scintView.execute(SCI_DOCLINEFROMVISIBLE, 
+      _scintView.execute(SCI_GETFIRSTVISIBLELINE) + _scintView.execute(SCI_LINESONSCREEN));
+   tiLine startPos = (tiLine)_scintView.execute(SCI_POSITIONFROMLINE, firstLine);
+   tiLine endPos = (tiLine)_scintView.execute(SCI_GETLINEENDPOSITION, lastLine);
+   _scintView.execute(SCI_COLOURISE, startPos, endPos);
 }
 
 void tclFindResultDlg::create(tTbData * data, bool isRTL)
@@ -242,8 +251,8 @@ void tclFindResultDlg::create(tTbData * data, bool isRTL)
 //   _data = data;
 }
 
-tiLine tclFindResultDlg::insertPosInfo(tPatId patternId, tiLine iResultLine, tclPosInfo pos) {
-   return mFindResults.insertPosInfo(patternId, iResultLine, pos);
+void tclFindResultDlg::insertPosInfo(tPatId patternId, tiLine iResultLine, const tclPosInfo& pos) {
+   mFindResults.insertPosInfo(patternId, iResultLine, pos);
 }
 
 bool tclFindResultDlg::getLineAvail(tiLine foundLine) const {
@@ -254,60 +263,110 @@ tiLine tclFindResultDlg::getNextFoundLine(tiLine iEditorsLine) const {
    return mFindResults.getNextLineNoAtMain(iEditorsLine);
 }
 
-const std::string& tclFindResultDlg::getLineText(tiLine iResultLine) {
+std::string tclFindResultDlg::getLineText(tiLine iResultLine) const {
    return mFindResults.getLineText(iResultLine);
 }
 
-void tclFindResultDlg::setLineText(tiLine iFoundLine, const std::string& text, const std::string& comment, unsigned commentWidth) {
-   bool bNewLine = mFindResults.setLineText(iFoundLine, text);
-   // here we have to distinguish update and insert of lines in search result window
-   tiLine resLine = mFindResults.getLineNoAtRes(iFoundLine);
-   //bool bVisible = mFindResults.getLineAtMain(iFoundLine).visible();
-   tiLine startPos = (tiLine)_scintView.execute(SCI_POSITIONFROMLINE, resLine);
-   if (startPos != -1) {
-      setCurrentMarkedLine(-1);
-      setFinderReadOnly(false);
-      std::string s = FNDRESDLG_LINE_HEAD;
-      s.reserve(text.size() 
-                + (_scintView.getLineNumbersInResult())?(miLineNumColSize + strlen(FNDRESDLG_LINE_COLON)):(0)
-                + (mDisplayComment)?(commentWidth + strlen(FNDRESDLG_LINE_HYPHEN)):(0));
-      char conv[20];
-      if (_scintView.getLineNumbersInResult()) {
-         s.append(miLineNumColSize-strlen(_i64toa(iFoundLine+1, conv, 10)), ' ');
-         s.append(conv);
-         s.append(FNDRESDLG_LINE_COLON);
+void tclFindResultDlg::appendLineHead(std::string& s, tiLine iFoundLine, const std::string& comment, unsigned commentWidth) const {
+   s.append(FNDRESDLG_LINE_HEAD);
+   char conv[20];
+   if (_scintView.getLineNumbersInResult()) {
+      s.append(miLineNumColSize-strlen(_i64toa(iFoundLine+1, conv, 10)), ' ');
+      s.append(conv);
+      s.append(FNDRESDLG_LINE_COLON);
+   }
+   if (mDisplayComment) {
+      s.append(comment);
+      s.append(commentWidth-comment.length(), ' ');
+      s.append(FNDRESDLG_LINE_HYPHEN);
+   }
+}
+
+void tclFindResultDlg::appendResultLine(std::string& s, tiLine resLine) const {
+   unsigned length = 0;
+   const char* text = mFindResults.getLineTextAtRes(resLine, length);
+   appendResultHead(s, resLine);
+   s.append(text, length);
+}
+
+void tclFindResultDlg::appendResultHead(std::string& s, tiLine resLine) const {
+   std::string comment;
+   if (mDisplayComment) {
+      // the comment of the first pattern found in the line
+      tclFindResultDoc::tstLineHits hits = mFindResults.getLineAtRes(resLine);
+      if (hits.begin != hits.end) {
+         tclPatternList::const_iterator iPattern = mPatStyleList.find(mFindResults.getPatId(*hits.begin));
+         if (iPattern != mPatStyleList.end()) {
+            comment = getViewString(iPattern.getPattern().getComment());
+         }
       }
-      if (mDisplayComment) {
-         s.append(comment);
-         s.append(commentWidth-comment.length(), ' ');
-         s.append(FNDRESDLG_LINE_HYPHEN);
+   }
+   appendLineHead(s, mFindResults.getLineNoAtMain(resLine), comment, mCommentWidth);
+}
+
+std::string tclFindResultDlg::getViewString(const generic_string& str) const {
+#ifdef UNICODE
+   unsigned int cp = (unsigned int)_scintView.execute(SCI_GETCODEPAGE);
+   return WcharMbcsConvertor::getInstance().wchar2char(str.c_str(), cp);
+#else
+   return str;
+#endif
+}
+
+void tclFindResultDlg::initExport(tclResultExport& exporter) const {
+   tclResultExport::tstStyle style;
+   const tclPattern& defPat = mFindResultSearchDlg.getdefaultPattern();
+   style.color = defPat.getColorNum();
+   style.bgColor = defPat.getBgColorNum();
+   style.bBold = defPat.getIsBold();
+   style.bItalic = defPat.getIsItalic();
+   style.bUnderlined = defPat.getIsUnderlined();
+   exporter.setDefaultStyle(style);
+   // same order as the styles of the view
+   for (unsigned iPat = 0; iPat < mPatStyleList.size(); ++iPat) {
+      tPatId patId = mPatStyleList.getPatternId(iPat);
+      const tclPattern& rPat = mPatStyleList.getPattern(patId);
+      if (iPat < MY_STYLE_COUNT) {
+         style.color = rPat.getColorNum();
+         style.bgColor = rPat.getBgColorNum();
+         style.bBold = rPat.getIsBold();
+         style.bItalic = rPat.getIsItalic();
+         style.bUnderlined = rPat.getIsUnderlined();
+         exporter.addStyle((unsigned char)transStyleId(iPat), style);
       }
-      s.append(text);
-      DBGA3("setLineText() iFoundLine: %d resLine: %d text: \"%s\"", (int)iFoundLine, (int)resLine, s.c_str());
-      if(bNewLine) {
-         // adding a newline into result -> set bookmark in main window
-         if(mUseBookmark) {
-            _pParent->execute(teNppWindows::scnActiveHandle, SCI_MARKERADD, iFoundLine, _pParent->getBookmarkId());
-         }
-         _scintView.execute(SCI_INSERTTEXT, startPos, (LPARAM)s.c_str());
-         ++_lineCounter;
-      } else {
-         tiLine endPos = (tiLine)_scintView.execute(SCI_GETLINEENDPOSITION, resLine);
-         if (endPos+2 <= _scintView.execute(SCI_GETLENGTH)) {
-            endPos += 2;
-         }
-         // hier text replace from startPos to endPos
-         _scintView.execute(SCI_SETTARGETSTART, startPos);
-         _scintView.execute(SCI_SETTARGETEND, endPos);
-         //SCI_REPLACETARGET(int length, const char *text)
-         _scintView.execute(SCI_REPLACETARGET, -1, (LPARAM)s.c_str());
-         DBG2("setLineText() tstart %d, tend %d.", (int)startPos, (int)endPos);
+      exporter.addPattern(patId, getViewString(mPatStyleList.getPatternIdentification(patId)), 
+                          getViewString(rPat.getComment()));
+   }
+   exporter.setLineHead([this](std::string& s, tiLine resLine) { appendResultHead(s, resLine); });
+   exporter.setUtf8(_scintView.execute(SCI_GETCODEPAGE) == SC_CP_UTF8);
+}
+
+bool tclFindResultDlg::beginBulkUpdate() {
+   mbBulkUpdate = (mFindResults.size() == 0);
+   return mbBulkUpdate;
+}
+
+void tclFindResultDlg::endBulkUpdate() {
+   if (!mbBulkUpdate) {
+      return;
+   }
+   mbBulkUpdate = false;
+   updateWindow();
+}
+
+void tclFindResultDlg::setLineText(tiLine iFoundLine, const std::string& text, const std::string& /*comment*/, unsigned commentWidth) {
+   bool bNewLine = mFindResults.setLineText(iFoundLine, text);
+   DBGA2("setLineText() iFoundLine: %d text: \"%s\"", (int)iFoundLine, text.c_str());
+   if(bNewLine) {
+      // adding a newline into result -> set bookmark in main window
+      if(mUseBookmark && !mbOnDiskMode) {
+         _pParent->execute(teNppWindows::scnActiveHandle, SCI_MARKERADD, iFoundLine, _pParent->getBookmarkId());
       }
-//      doStyle(resLine, startPos, (int)startPos+(int)s.length());
-      setFinderReadOnly(true);
-   } else {
-      DBG1("setLineText() ERROR iFoundLine: %d not in editor! do  nothing", (int)iFoundLine);
+      ++_lineCounter;
    }
+   // the comment is taken from the pattern when the line is shown
+   mCommentWidth = commentWidth;
+   mbWindowDirty = true;
 }
 
 void tclFindResultDlg::moveResult(tPatId oldPattId, tPatId newPattId)
@@ -318,10 +377,26 @@ void tclFindResultDlg::moveResult(tPatId oldPattId, tPatId newPattId)
    mFindResults.moveResult(oldPattId, newPattId);
    // 2. correct th pattern styles
    mPatStyleList.moveResult(oldPattId, newPattId);
+   setResultStyles();
    // 3. activate new coloring
    _scintView.execute(SCI_COLOURISE, 0, -1);
+   if (_pParent->getIsResultOfActiveDoc()) {
+      highlightMainView(true);
+   }
 }
    
+void tclFindResultDlg::shiftLines(tiLine foundLine, tiLine lineDelta)
+{
+   tiLine resLine = mFindResults.shiftLines(foundLine, lineDelta);
+   if (lineDelta == 0 || !_scintView.getLineNumbersInResult()) {
+      return;
+   }
+   // the line numbers shown from resLine on have changed
+   if (resLine < mWindow.getEnd()) {
+      mbWindowDirty = true;
+   }
+}
+
 void tclFindResultDlg::setPatternFonts() {
    // set the result window font style
    unsigned iPat = FNDRESDLG_DEFAULT_STYLE;
@@ -354,10 +429,12 @@ void tclFindResultDlg::updateWindowData(const generic_string& fontName, unsigned
 
 void tclFindResultDlg::clear_view()
 {
+   mWindow.clear();
    if (_scintView.getHSelf() != NULL)
    {
        setFinderReadOnly(false);
       _scintView.execute(SCI_CLEARALL);
+      _scintView.execute(SCI_MARGINTEXTCLEARALL);
        setFinderReadOnly(true);
    }
 }
@@ -367,13 +444,64 @@ void tclFindResultDlg::clear(bool initial)
    setCurrentMarkedLine(-1);
    //_foundInfos.clear(); 
    mFindResults.clear();
+   setResultStyles();
+   if (!initial) {
+      clearMainHighlight();
+   }
    if(mUseBookmark && !initial) {
       _pParent->execute(teNppWindows::scnActiveHandle, SCI_MARKERDELETEALL, _pParent->getBookmarkId());
    }
    clear_view();
+   mWindow.setLineCount(0);
+   mbWindowDirty = false;
+   resetSelection();
+   updateScrollBar();
+   _lineCounter = 0;
+}
+
+void tclFindResultDlg::saveResultView(tstResultView& view)
+{
+   releaseResultView(view);
+   _markedLine = -1;
+   view.firstLine = getViewTop();
+   mFindResults.swap(view.results);
+   view.patStyles = mPatStyleList;
+   view.lineNumColSize = miLineNumColSize;
+   view.bOnDiskMode = mbOnDiskMode;
+   view.memSize = view.results.getMemorySize();
+   setResultStyles();
+   clear_view();
+   mWindow.setLineCount(0);
+   mbWindowDirty = false;
+   resetSelection();
+   updateScrollBar();
    _lineCounter = 0;
 }
 
+void tclFindResultDlg::restoreResultView(tstResultView& view)
+{
+   DBG1("restoreResultView() %d lines", (int)view.results.size());
+   _markedLine = -1;
+   mFindResults.clear();
+   mFindResults.swap(view.results);
+   mPatStyleList = view.patStyles;
+   view.patStyles.clear();
+   setResultStyles();
+   setLineNumColSize(view.lineNumColSize);
+   mbOnDiskMode = view.bOnDiskMode;
+   _lineCounter = (size_t)mFindResults.size();
+   resetSelection();
+   mWindow.setLineCount(mFindResults.size());
+   fillWindowAround(view.firstLine);
+}
+
+void tclFindResultDlg::releaseResultView(tstResultView& view)
+{
+   view.results.clear();
+   view.patStyles.clear();
+   view.memSize = 0;
+}
+
 tiLine tclFindResultDlg::getCurrentMarkedLine() const
 {
    return _markedLine;
@@ -444,8 +572,6 @@ void tclFindResultDlg::setPatternStyles(const tclPatternList& list)
    _scintView.execute(SCI_STYLESETFORE, iDefPat, defPat.getColorNum());
    _scintView.execute(SCI_STYLESETBACK, iDefPat, defPat.getBgColorNum());
    _scintView.execute(SCI_STYLESETEOLFILLED, iDefPat, (defPat.getSelectionType()==tclPattern::line));
-   // prepare rtfColTbl as color table for richtext support color 0 = default color
-   _scintView.startRtfColorTable(defPat.getColorNum(), defPat.getBgColorNum());
    // copy styles into result window cache because while painting
    // user may have removed a pattern already
    // we can maximally style MY_STYLE_COUNT patterns
@@ -464,26 +590,403 @@ void tclFindResultDlg::setPatternStyles(const tclPatternList& list)
          _scintView.execute(SCI_STYLESETFORE, transStyleId(iPat), rPat.getColorNum());
          _scintView.execute(SCI_STYLESETBACK, transStyleId(iPat), rPat.getBgColorNum());
          _scintView.execute(SCI_STYLESETEOLFILLED, transStyleId(iPat), (rPat.getSelectionType() == tclPattern::line));
-         // colors 1 based
-         _scintView.addRtfColor2Table(rPat.getColorNum(), rPat.getBgColorNum());
       }
    } // for
    
-   _scintView.finalizeRtfColorTable();
    setPatternFonts();
+   setResultStyles();
 
    if(bReStyle) {
       _scintView.execute(SCI_COLOURISE, 0, -1);
    }
+   if (_pParent->getIsResultOfActiveDoc()) {
+      highlightMainView(true);
+   }
+}
+
+void tclFindResultDlg::setHighlightMain(bool bOn) {
+   if (mbHighlightMain && !bOn) {
+      clearMainHighlight();
+   }
+   mbHighlightMain = bOn;
+}
+
+void tclFindResultDlg::allocateIndicators() {
+   int start = 0;
+   if (_pParent->execute(teNppWindows::nppHandle, NPPM_ALLOCATEINDICATOR, 2, (LPARAM)&start) && start > 0) {
+      mIndicFore = start;
+      mIndicBack = start + 1;
+   }
+   DBG2("allocateIndicators() %d and %d", mIndicFore, mIndicBack);
+}
+
+void tclFindResultDlg::clearMainHighlight() {
+   // the colours moved with the text when it was edited, so the whole
+   // document is cleared; that costs the coloured ranges only
+   tiLine length = (tiLine)_pParent->execute(teNppWindows::scnActiveHandle, SCI_GETLENGTH);
+   for (int indic : {mIndicFore, mIndicBack}) {
+      _pParent->execute(teNppWindows::scnActiveHandle, SCI_SETINDICATORCURRENT, indic);
+      _pParent->execute(teNppWindows::scnActiveHandle, SCI_INDICATORCLEARRANGE, 0, length);
+   }
+   mHighlightFirst = 0;
+   mHighlightEnd = 0;
+}
+
+void tclFindResultDlg::highlightMainView(bool bForce) {
+   if (!mbHighlightMain || mbOnDiskMode) {
+      return;
+   }
+   tiLine top = (tiLine)_pParent->execute(teNppWindows::scnActiveHandle, SCI_DOCLINEFROMVISIBLE,
+      _pParent->execute(teNppWindows::scnActiveHandle, SCI_GETFIRSTVISIBLELINE));
+   tiLine bottom = top + (tiLine)_pParent->execute(teNppWindows::scnActiveHandle, SCI_LINESONSCREEN);
+   tiLine lineCount = (tiLine)_pParent->execute(teNppWindows::scnActiveHandle, SCI_GETLINECOUNT);
+   if (bottom > lineCount) {
+      bottom = lineCount;
+   }
+   if (!bForce && top >= mHighlightFirst && bottom <= mHighlightEnd) {
+      return; // still inside the coloured lines
+   }
+   clearMainHighlight();
+   tiLine first = (top > FNDRESDLG_HIGHLIGHT_MARGIN) ? top - FNDRESDLG_HIGHLIGHT_MARGIN : 0;
+   tiLine end = (bottom + FNDRESDLG_HIGHLIGHT_MARGIN < lineCount) ? bottom + FNDRESDLG_HIGHLIGHT_MARGIN : lineCount;
+   DBG2("highlightMainView() lines %d to %d", (int)first, (int)end);
+   // the indicators are set per view, the value is the colour
+   _pParent->execute(teNppWindows::scnActiveHandle, SCI_INDICSETSTYLE, mIndicFore, INDIC_TEXTFORE);
+   _pParent->execute(teNppWindows::scnActiveHandle, SCI_INDICSETFLAGS, mIndicFore, SC_INDICFLAG_VALUEFORE);
+   _pParent->execute(teNppWindows::scnActiveHandle, SCI_INDICSETSTYLE, mIndicBack, INDIC_STRAIGHTBOX);
+   _pParent->execute(teNppWindows::scnActiveHandle, SCI_INDICSETFLAGS, mIndicBack, SC_INDICFLAG_VALUEFORE);
+   _pParent->execute(teNppWindows::scnActiveHandle, SCI_INDICSETALPHA, mIndicBack, 255);
+   _pParent->execute(teNppWindows::scnActiveHandle, SCI_INDICSETOUTLINEALPHA, mIndicBack, 255);
+   _pParent->execute(teNppWindows::scnActiveHandle, SCI_INDICSETUNDER, mIndicBack, true);
+   // only the colours a pattern sets apart from the default are shown
+   const tclPattern& defPat = mFindResultSearchDlg.getdefaultPattern();
+   tiLine line = mFindResults.getNextLineNoAtMain(first);
+   if (line < 0 || line >= end) {
+      mHighlightFirst = first;
+      mHighlightEnd = end;
+      return;
+   }
+   tiLine resLine = mFindResults.getLineNoAtRes(line);
+   for (; resLine < mFindResults.size(); ++resLine) {
+      tclFindResultDoc::tstLineHits lh = mFindResults.getLineAtRes(resLine);
+      if (lh.line >= end) {
+         break;
+      }
+      tiLine lineBegin = (tiLine)_pParent->execute(teNppWindows::scnActiveHandle, SCI_POSITIONFROMLINE, lh.line);
+      tiLine lineEnd = (tiLine)_pParent->execute(teNppWindows::scnActiveHandle, SCI_GETLINEENDPOSITION, lh.line);
+      // the hits are sorted by pattern; a later pattern overrides the ones before
+      for (const tclFindResultDoc::tstHit* pHit = lh.begin; pHit != lh.end; ++pHit) {
+         tclPatternList::const_iterator iPattern = mPatStyleList.find(mFindResults.getPatId(*pHit));
+         if (iPattern == mPatStyleList.end()) {
+            continue;
+         }
+         const tclPattern& rPat = iPattern.getPattern();
+         tiLine begin = lineBegin;
+         tiLine length = lineEnd - lineBegin;
+         if (rPat.getSelectionType() != tclPattern::line) {
+            begin += pHit->start;
+            length = (begin + (tiLine)pHit->length <= lineEnd) ? (tiLine)pHit->length : lineEnd - begin;
+         }
+         if (length <= 0) {
+            continue;
+         }
+         _pParent->execute(teNppWindows::scnActiveHandle, SCI_SETINDICATORCURRENT, mIndicFore);
+         if (rPat.getColorNum() != defPat.getColorNum()) {
+            _pParent->execute(teNppWindows::scnActiveHandle, SCI_SETINDICATORVALUE, rPat.getColorNum() | SC_INDICVALUEBIT);
+            _pParent->execute(teNppWindows::scnActiveHandle, SCI_INDICATORFILLRANGE, begin, length);
+         } else {
+            _pParent->execute(teNppWindows::scnActiveHandle, SCI_INDICATORCLEARRANGE, begin, length);
+         }
+         _pParent->execute(teNppWindows::scnActiveHandle, SCI_SETINDICATORCURRENT, mIndicBack);
+         if (rPat.getBgColorNum() != defPat.getBgColorNum()) {
+            _pParent->execute(teNppWindows::scnActiveHandle, SCI_SETINDICATORVALUE, rPat.getBgColorNum() | SC_INDICVALUEBIT);
+            _pParent->execute(teNppWindows::scnActiveHandle, SCI_INDICATORFILLRANGE, begin, length);
+         } else {
+            _pParent->execute(teNppWindows::scnActiveHandle, SCI_INDICATORCLEARRANGE, begin, length);
+         }
+      }
+   }
+   mHighlightFirst = first;
+   mHighlightEnd = end;
+}
+
+void tclFindResultDlg::setResultStyles() {
+   for (unsigned iPat = 0; iPat < mPatStyleList.size(); ++iPat) {
+      tPatId patId = mPatStyleList.getPatternId(iPat);
+      bool bWholeLine = (mPatStyleList.getPattern(patId).getSelectionType() == tclPattern::line);
+      mFindResults.setPatternStyle(patId, (unsigned char)transStyleId(iPat), bWholeLine);
+   }
 }
 
 void tclFindResultDlg::updateDockingDlg(void) {
-   _scintView.updateLineNumberWidth(true);
-   _scintView.execute(SCI_COLOURISE, 0, -1);
+   updateWindow();
+   colouriseVisible();
    DockingDlgInterface::updateDockingDlg();
    saveSearchDoc();
 }
 
+void tclFindResultDlg::updateWindow() {
+   if (_scintView.getHSelf() == NULL) {
+      return;
+   }
+   mWindow.setLineCount(mFindResults.size());
+   tiLine topLine = getViewTop();
+   if (mbWindowDirty) {
+      DBG2("updateWindow() %d lines, top %d", (int)mFindResults.size(), (int)topLine);
+      setCurrentMarkedLine(-1);
+      // the selected lines may be gone
+      resetSelection();
+      fillWindowAround(topLine);
+   } else if (!mWindow.getIsCovering(topLine, getScreenLines())) {
+      fillWindowAround(topLine);
+   } else {
+      updateScrollBar();
+   }
+}
+
+tiLine tclFindResultDlg::getViewTop() const {
+   tiLine topLine = mWindow.getFirst() + 
+      (tiLine)_scintView.execute(SCI_DOCLINEFROMVISIBLE, _scintView.execute(SCI_GETFIRSTVISIBLELINE));
+   return (topLine < mWindow.getLineCount()) ? topLine : mWindow.getLineCount();
+}
+
+tiLine tclFindResultDlg::getScreenLines() const {
+   tiLine lines = (tiLine)_scintView.execute(SCI_LINESONSCREEN);
+   return (lines > 0) ? lines : 1;
+}
+
+void tclFindResultDlg::fillWindowAround(tiLine topLine) {
+   mWindow.placeAround(topLine, getScreenLines());
+   fillWindow(mWindow.getFirst(), mWindow.getCount(), topLine);
+}
+
+void tclFindResultDlg::fillWindow(tiLine first, tiLine count, tiLine topLine) {
+   mWindow.setLineCount(mFindResults.size());
+   mWindow.place(first, count);
+   if (_scintView.getHSelf() == NULL) {
+      return;
+   }
+   DBG3("fillWindow() lines %d to %d, top %d", (int)mWindow.getFirst(), (int)mWindow.getEnd(), (int)topLine);
+   std::string s;
+   s.reserve((size_t)mWindow.getCount() * (miLineHeadSize + 80));
+   for (tiLine resLine = mWindow.getFirst(); resLine < mWindow.getEnd(); ++resLine) {
+      appendResultLine(s, resLine);
+   }
+   setFinderReadOnly(false);
+   _scintView.execute(SCI_CLEARALL);
+   _scintView.execute(SCI_MARGINTEXTCLEARALL);
+   // window is empty, so this is the same as SCI_SETTEXT but with length
+   _scintView.execute(SCI_APPENDTEXT, s.size(), (LPARAM)s.data());
+   setFinderReadOnly(true);
+   char conv[20];
+   for (tiLine line = 0; line < mWindow.getCount(); ++line) {
+      _scintView.execute(SCI_MARGINSETTEXT, line, (LPARAM)_i64toa(mWindow.getFirst() + line + 1, conv, 10));
+      _scintView.execute(SCI_MARGINSETSTYLE, line, STYLE_LINENUMBER);
+   }
+   _scintView.updateLineNumberWidth(true, mWindow.getLineCount());
+   mbWindowDirty = false;
+   if (topLine < mWindow.getFirst()) {
+      topLine = mWindow.getFirst();
+   }
+   _scintView.execute(SCI_SETFIRSTVISIBLELINE, _scintView.execute(SCI_VISIBLEFROMDOCLINE, topLine - mWindow.getFirst()));
+   restoreSelection();
+   colouriseVisible();
+   updateScrollBar();
+}
+
+void tclFindResultDlg::scrollToResLine(tiLine topLine) {
+   tiLine lastTop = mWindow.getLineCount() - getScreenLines();
+   if (topLine > lastTop) {
+      topLine = lastTop;
+   }
+   if (topLine < 0) {
+      topLine = 0;
+   }
+   if (mbWindowDirty || !mWindow.getIsCovering(topLine, getScreenLines())) {
+      fillWindowAround(topLine);
+   } else {
+      _scintView.execute(SCI_SETFIRSTVISIBLELINE, _scintView.execute(SCI_VISIBLEFROMDOCLINE, topLine - mWindow.getFirst()));
+      updateScrollBar();
+   }
+}
+
+void tclFindResultDlg::updateScrollBar() {
+   if (mhScrollBar == 0) {
+      return;
+   }
+   SCROLLINFO si;
+   si.cbSize = sizeof(si);
+   si.fMask = SIF_RANGE | SIF_PAGE | SIF_POS | SIF_DISABLENOSCROLL;
+   si.nMin = 0;
+   si.nMax = (int)((mWindow.getLineCount() > 0) ? mWindow.getLineCount() - 1 : 0);
+   si.nPage = (UINT)getScreenLines();
+   si.nPos = (int)getViewTop();
+   ::SetScrollInfo(mhScrollBar, SB_CTL, &si, TRUE);
+}
+
+void tclFindResultDlg::doVScroll(int code) {
+   tiLine topLine = getViewTop();
+   tiLine screenLines = getScreenLines();
+   switch (code) {
+   case SB_LINEUP:   --topLine; break;
+   case SB_LINEDOWN: ++topLine; break;
+   case SB_PAGEUP:   topLine -= screenLines; break;
+   case SB_PAGEDOWN: topLine += screenLines; break;
+   case SB_TOP:      topLine = 0; break;
+   case SB_BOTTOM:   topLine = mWindow.getLineCount(); break;
+   case SB_THUMBTRACK:
+   case SB_THUMBPOSITION:
+      {
+         SCROLLINFO si;
+         si.cbSize = sizeof(si);
+         si.fMask = SIF_TRACKPOS;
+         ::GetScrollInfo(mhScrollBar, SB_CTL, &si);
+         topLine = si.nTrackPos;
+         break;
+      }
+   default:
+      return;
+   }
+   scrollToResLine(topLine);
+}
+
+void tclFindResultDlg::layoutView() {
+   RECT rc;
+   getClientRect(rc);
+   int scrollWidth = ::GetSystemMetrics(SM_CXVSCROLL);
+   if (rc.right > scrollWidth) {
+      rc.right -= scrollWidth;
+   }
+   _scintView.reSizeTo(rc);
+   if (mhScrollBar) {
+      ::MoveWindow(mhScrollBar, rc.right, rc.top, scrollWidth, rc.bottom - rc.top, TRUE);
+   }
+}
+
+void tclFindResultDlg::beginPageSearch() {
+   mPageSearchTop = getViewTop();
+   mbPageSearch = true;
+}
+
+void tclFindResultDlg::showFirstPage(bool bDown) {
+   tiLine first = bDown ? 0 : mFindResults.size() - FNDRESDLG_SEARCH_PAGE_LINES;
+   fillWindow((first > 0) ? first : 0, FNDRESDLG_SEARCH_PAGE_LINES, (first > 0) ? first : 0);
+}
+
+bool tclFindResultDlg::showNextPage(bool bDown) {
+   if (bDown) {
+      if (mWindow.getEnd() >= mFindResults.size()) {
+         return false;
+      }
+      fillWindow(mWindow.getEnd(), FNDRESDLG_SEARCH_PAGE_LINES, mWindow.getEnd());
+   } else {
+      if (mWindow.getFirst() == 0) {
+         return false;
+      }
+      tiLine first = mWindow.getFirst() - FNDRESDLG_SEARCH_PAGE_LINES;
+      first = (first > 0) ? first : 0;
+      fillWindow(first, mWindow.getFirst() - first, first);
+   }
+   return true;
+}
+
+void tclFindResultDlg::endPageSearch(bool bFound) {
+   mbPageSearch = false;
+   if (!bFound) {
+      fillWindowAround(mPageSearchTop);
+   }
+   // otherwise the page stays until the found text is scrolled out
+}
+
+tclFindResultDlg::tstResPos tclFindResultDlg::getResPos(tiLine viewPos) const {
+   tstResPos pos;
+   tiLine line = (tiLine)_scintView.execute(SCI_LINEFROMPOSITION, viewPos);
+   pos.col = viewPos - (tiLine)_scintView.execute(SCI_POSITIONFROMLINE, line);
+   pos.line = mWindow.getFirst() + line;
+   if (pos.line >= mWindow.getEnd()) {
+      // behind the last line break
+      pos.line = mWindow.getEnd();
+      pos.col = 0;
+   }
+   return pos;
+}
+
+tiLine tclFindResultDlg::getViewPos(const tstResPos& pos) const {
+   if (pos.line < mWindow.getFirst()) {
+      return 0;
+   }
+   if (pos.line >= mWindow.getEnd()) {
+      return (tiLine)_scintView.execute(SCI_GETLENGTH);
+   }
+   tiLine line = pos.line - mWindow.getFirst();
+   tiLine viewPos = (tiLine)_scintView.execute(SCI_POSITIONFROMLINE, line) + pos.col;
+   tiLine nextLine = (tiLine)_scintView.execute(SCI_POSITIONFROMLINE, line + 1);
+   return (nextLine >= 0 && viewPos > nextLine) ? nextLine : viewPos;
+}
+
+void tclFindResultDlg::trackSelection() {
+   tiLine anchor = (tiLine)_scintView.execute(SCI_GETANCHOR);
+   tiLine caret = (tiLine)_scintView.execute(SCI_GETCURRENTPOS);
+   // an end cut at the window border keeps its line outside of the window
+   if (anchor != mViewAnchor || anchor == caret) {
+      mSelAnchor = getResPos(anchor);
+   }
+   if (caret != mViewCaret) {
+      mSelCaret = getResPos(caret);
+   }
+   mViewAnchor = anchor;
+   mViewCaret = caret;
+}
+
+void tclFindResultDlg::restoreSelection() {
+   mViewAnchor = getViewPos(mSelAnchor);
+   mViewCaret = getViewPos(mSelCaret);
+   _scintView.execute(SCI_SETSELECTION, mViewCaret, mViewAnchor);
+}
+
+void tclFindResultDlg::resetSelection() {
+   mSelAnchor.line = 0;
+   mSelAnchor.col = 0;
+   mSelCaret = mSelAnchor;
+}
+
+void tclFindResultDlg::selectAll() {
+   mSelAnchor.line = 0;
+   mSelAnchor.col = 0;
+   mSelCaret.line = mFindResults.size();
+   mSelCaret.col = 0;
+   restoreSelection();
+}
+
+void tclFindResultDlg::copySelection() {
+   if (_scintView.execute(SCI_SELECTIONISRECTANGLE)) {
+      // the columns of a rectangle are only known by the view
+      _scintView.execute(SCI_COPY);
+      return;
+   }
+   trackSelection();
+   const tstResPos* pFrom = &mSelAnchor;
+   const tstResPos* pTo = &mSelCaret;
+   if (pTo->line < pFrom->line || (pTo->line == pFrom->line && pTo->col < pFrom->col)) {
+      std::swap(pFrom, pTo);
+   }
+   if (pFrom->line == pTo->line && pFrom->col == pTo->col) {
+      return; // nothing selected
+   }
+   // the lines are taken from the result, so the lines outside of the window
+   // are copied with their styles too
+   tclResultExport exporter(mFindResults);
+   initExport(exporter);
+   std::ostringstream text;
+   exporter.write(text, tclResultExport::fmtText, pFrom->line, (unsigned)pFrom->col, pTo->line, (unsigned)pTo->col);
+   const std::string s = text.str();
+   DBG2("copySelection() %d chars from line %d", (int)s.size(), (int)pFrom->line);
+   _scintView.execute(SCI_COPYTEXT, s.size(), (LPARAM)s.data());
+   std::ostringstream rtf;
+   exporter.write(rtf, tclResultExport::fmtRtf, pFrom->line, (unsigned)pFrom->col, pTo->line, (unsigned)pTo->col);
+   _scintView.setRichTextClip(rtf.str());
+}
+
 void tclFindResultDlg::setFileName(const generic_string& str) {
    if(mSearchFileName != str) {
       mSearchFileName = str;
@@ -519,14 +1022,13 @@ void tclFindResultDlg::restoreCurrentViewPos() {
 void tclFindResultDlg::setCurrentViewPos(tiLine iThisMainLine) {
    tiLine iResLine;
    if (-1 == iThisMainLine) {
-      tiLine len = (tiLine)_scintView.execute(SCI_GETLENGTH);
-      iResLine = (tiLine)_scintView.execute(SCI_LINEFROMPOSITION, len);
+      iResLine = mFindResults.size();
    }
    else {
       iResLine = mFindResults.getLineNoAtRes(iThisMainLine);
    }
-   DBGDEF(tiLine res = (tiLine) ) _scintView.execute(SCI_SETFIRSTVISIBLELINE, iResLine);
-   DBG2("tclFindResultDlg::setCurrentViewPos() Setting the line to %d returns %d", (int)iResLine, (int)res);
+   scrollToResLine(iResLine);
+   DBG1("tclFindResultDlg::setCurrentViewPos() Setting the line to %d", (int)iResLine);
 }
 
 void tclFindResultDlg::updateViewScrollState(tiLine iLineInMain, bool bInMain, bool bAnyway) {
@@ -545,8 +1047,12 @@ void tclFindResultDlg::updateViewScrollState(tiLine iLineInMain, bool bInMain, b
 }
 // public version calls internal with correct start and end values
 void tclFindResultDlg::doStyle(tiLine iFoundLine) {
-   tiLine iLineNumber = mFindResults.getLineNoAtRes(iFoundLine);
-   DBG2("doStyle(iFoundLine) iFoundLine %d resLine %d", (int)iFoundLine, (int)iLineNumber);
+   tiLine resLine = mFindResults.getLineNoAtRes(iFoundLine);
+   DBG2("doStyle(iFoundLine) iFoundLine %d resLine %d", (int)iFoundLine, (int)resLine);
+   if (!mWindow.getIsInside(resLine)) {
+      return; // styled when it is scrolled in
+   }
+   tiLine iLineNumber = resLine - mWindow.getFirst();
    tiLine styleBegin = (tiLine)_scintView.execute(SCI_POSITIONFROMLINE, iLineNumber);
    tiLine endOfLine = (tiLine)_scintView.execute(SCI_GETLINEENDPOSITION, iLineNumber);
    doStyle(iLineNumber, styleBegin, endOfLine);
@@ -584,6 +1090,58 @@ void tclFindResultDlg::doSaveToFile() {
    }
 }
 
+void tclFindResultDlg::doSaveExport(tclResultExport::teFormat format) {
+   const TCHAR* filter = TEXT("Richtext\0*.rtf\0");
+   const TCHAR* ext = TEXT(".rtf");
+   const TCHAR* title = TEXT("Save Analyse Search Result once as Richtext File");
+   if (format == tclResultExport::fmtHtml) {
+      filter = TEXT("HTML\0*.html;*.htm\0");
+      ext = TEXT(".html");
+      title = TEXT("Save Analyse Search Result once as HTML File");
+   }
+   else if (format == tclResultExport::fmtCsv) {
+      filter = TEXT("CSV\0*.csv\0");
+      ext = TEXT(".csv");
+      title = TEXT("Save Analyse Search Result once as CSV File");
+   }
+   OPENFILENAME ofn;       // common dialog box structure
+   TCHAR szFile[MAX_PATH] = TEXT("");       // buffer for file name
+   generic_string lastFile = mLastExportFile.substr(0, mLastExportFile.size() - generic_strlen(PathFindExtension(mLastExportFile.c_str())));
+   (void)generic_strncpy(szFile, lastFile.c_str(), COUNTCHAR(szFile));
+   szFile[COUNTCHAR(szFile)-1]=0;
+   // Initialize OPENFILENAME
+   ZeroMemory(&ofn, sizeof(ofn));
+   ofn.lStructSize = sizeof(ofn);
+   ofn.hwndOwner = _hSelf;
+   ofn.lpstrFile = szFile;
+   ofn.nMaxFile = COUNTCHAR(szFile);
+   ofn.lpstrFilter = filter;
+   ofn.nFilterIndex = 1;
+   ofn.lpstrTitle = title;
+   ofn.lpstrInitialDir = szFile;
+   ofn.Flags = OFN_OVERWRITEPROMPT; // OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST;
+
+   if (GetSaveFileName(&ofn) != TRUE) {
+      return;
+   }
+   generic_string dot = PathFindExtension(szFile);
+   if (dot == TEXT("") && ((generic_strlen(szFile) + generic_strlen(ext)) < MAX_PATH)) {
+      generic_strncat(szFile, ext, generic_strlen(ext) + 1);
+   }
+   mLastExportFile = szFile;
+   // the lines are streamed out of the result, the view stays as it is
+   ::SetCursor(::LoadCursor(NULL, IDC_WAIT));
+   tclResultExport exporter(mFindResults);
+   initExport(exporter);
+   std::ofstream os(szFile, std::ios::out | std::ios::binary | std::ios::trunc);
+   bool bOk = os.is_open() && exporter.write(os, format);
+   os.close();
+   ::SetCursor(::LoadCursor(NULL, IDC_ARROW));
+   if (!bOk) {
+      MessageBox(NULL, TEXT("Problem in save"), TEXT("tclFindResultDlg::doSaveExport"), MB_OK);
+   }
+}
+
 // message call back method
 INT_PTR CALLBACK tclFindResultDlg::run_dlgProc(UINT message, WPARAM wParam, LPARAM lParam)
 {
@@ -615,18 +1173,35 @@ INT_PTR CALLBACK tclFindResultDlg::run_dlgProc(UINT message, WPARAM wParam, LPAR
 
          case FNDRESDLG_SCINTILLAFINFER_SAVE_RTF:
             {
-            _scintView.doSaveRichtext();
-            return TRUE;
-         }
+               doSaveExport(tclResultExport::fmtRtf);
+               return TRUE;
+            }
+         case FNDRESDLG_SCINTILLAFINFER_SAVE_HTML:
+            {
+               doSaveExport(tclResultExport::fmtHtml);
+               return TRUE;
+            }
+         case FNDRESDLG_SCINTILLAFINFER_SAVE_CSV:
+            {
+               doSaveExport(tclResultExport::fmtCsv);
+               return TRUE;
+            }
          case FNDRESDLG_SCINTILLAFINFER_COPY :
             {
-               _scintView.execute(SCI_COPY);
-               _scintView.doRichTextCopy();
+               copySelection();
                return TRUE;
             }
          case FNDRESDLG_SCINTILLAFINFER_SELECTALL :
             {
-               _scintView.execute(SCI_SELECTALL);
+               selectAll();
+               return TRUE;
+            }
+         case FNDRESDLG_UPDATE_WINDOW:
+            {
+               mbWindowUpdatePosted = false;
+               if (!mbPageSearch) {
+                  updateWindow();
+               }
                return TRUE;
             }
          case FNDRESDLG_SCINTILLAFINFER_SEARCH:
@@ -668,15 +1243,23 @@ INT_PTR CALLBACK tclFindResultDlg::run_dlgProc(UINT message, WPARAM wParam, LPAR
             tmp.push_back(MenuItemUnit(FNDRESDLG_ACTIVATE_PATTERN_LIST, TEXT("matching patterns:")));
             {
                int pos = (int)_scintView.execute(SCI_GETCURRENTPOS);
-               int line = (int)_scintView.execute(SCI_LINEFROMPOSITION, pos);
-               const tlmIdxPosInfo& p = mFindResults.getLineAtRes(line).second.posInfos();
-               tlmIdxPosInfo::const_iterator it = p.begin();
-               for (; it != p.end(); ++it) {
-                  int idx = _pParent->getPatternIndex(it->first); // list is zero based
-                  generic_string s = _pParent->getPatternIdentification(it->first);
+               tiLine line = mWindow.getFirst() + (tiLine)_scintView.execute(SCI_LINEFROMPOSITION, pos);
+               tclFindResultDoc::tstLineHits p;
+               p.begin = p.end = 0;
+               if (line < mFindResults.size()) {
+                  p = mFindResults.getLineAtRes(line);
+               }
+               const tclFindResultDoc::tstHit* it = p.begin;
+               for (; it != p.end; ++it) {
+                  tPatId patId = mFindResults.getPatId(*it);
+                  if (it != p.begin && mFindResults.getPatId(*(it - 1)) == patId) {
+                     continue; // hits are sorted by pattern
+                  }
+                  int idx = _pParent->getPatternIndex(patId); // list is zero based
+                  generic_string s = _pParent->getPatternIdentification(patId);
                   s += TEXT(":");
-                  s += _pParent->getPatternSearchText(it->first);
-                  DBG4("Line %d has pattern %f line %d text %s", line, it->first, idx, s.c_str());
+                  s += _pParent->getPatternSearchText(patId);
+                  DBG4("Line %d has pattern %f line %d text %s", (int)line, patId, idx, s.c_str());
                   int range = (FNDRESDLG_ACTIVATE_PATTERN_END - FNDRESDLG_ACTIVATE_PATTERN_BASE);
                   if (idx > range) {
                      break;
@@ -715,9 +1298,17 @@ INT_PTR CALLBACK tclFindResultDlg::run_dlgProc(UINT message, WPARAM wParam, LPAR
 
    case WM_SIZE :
       {
-         RECT rc;
-         getClientRect(rc);
-         _scintView.reSizeTo(rc);
+         layoutView();
+         if (!mbPageSearch) {
+            updateWindow();
+         }
+         return TRUE;
+      }
+
+   case WM_VSCROLL :
+      {
+         // from our scroll bar or the keys moving to the begin or end
+         doVScroll(LOWORD(wParam));
          return TRUE;
       }
 
@@ -742,28 +1333,13 @@ INT_PTR CALLBACK tclFindResultDlg::run_dlgProc(UINT message, WPARAM wParam, LPAR
    return FALSE;
 }
 
-/** 
-this function sends the series of commands to 
-scintilla win with the corresponding style id converted from the mPatStyleList
-**/
-void tclFindResultDlg::setStyle(tPatId iPatternId, tiLine iBeginPos, tiLine iLength)
-{
-   unsigned u = mPatStyleList.getPatternIndex(iPatternId);
-   u = transStyleId(u); // shift by table lookup to avoid predefined default styles
-   DBG4("setStyle() pattern %f style %d begin %d length %d", iPatternId, u, (int)iBeginPos, (int)iLength);
-   _scintView.execute(SCI_STARTSTYLING, iBeginPos, MY_STYLE_MASK);
-   _scintView.execute(SCI_SETSTYLING, iLength, u);
-}
-
-/** 
-this function sends the series of commands to 
-scintilla win with the corresponding style id 
-**/
-void tclFindResultDlg::setDefaultStyle(tiLine iBeginPos, tiLine iLength)
-{
-   DBG2("setDefaultStyle() begin %d length %d", (int)iBeginPos, (int)iLength);
-   _scintView.execute(SCI_STARTSTYLING, iBeginPos, MY_STYLE_MASK);
-   _scintView.execute(SCI_SETSTYLING, iLength, FNDRESDLG_DEFAULT_STYLE);
+int tclFindResultDlg::getLineHeadSize() const {
+   // same as appendLineHead() writes
+   int size = _scintView.getLineNumbersInResult() ? miLineHeadSize : (int)strlen(FNDRESDLG_LINE_HEAD);
+   if (mDisplayComment) {
+      size += (int)(mCommentWidth + strlen(FNDRESDLG_LINE_HYPHEN));
+   }
+   return size;
 }
 
 // callback from scintilla to colorize the search window
@@ -772,13 +1348,6 @@ void tclFindResultDlg::doStyle(tiLine startResultLineNo, tiLine startStyleNeeded
    DBG3("doStyle() startResultLineNo %d startStyleNeeded %d endStyleNeeded %d", 
       (int)startResultLineNo, (int)startStyleNeeded, (int)endStyleNeeded);
    /*
-   Procedure
-   1. get the last time styled position to start on SCI_GETENDSTYLED
-   startPos = SCI_GETENDSTYLED();
-   2. from 1) until endStyleNeeded do:
-   lineNumber = SCI_LINEFROMPOSITION(startPos);
-   startPos = SCI_POSITIONFROMLINE(lineNumber);
-   doStyle(lineNumber, startPos, endStyleNeeded);
    Concept of styling
    each pattern has a color and style attributes bold, underline and italic
    this data is implemented in styles having STYLE_LASTPREDEFINED + patId no.
@@ -787,87 +1356,44 @@ void tclFindResultDlg::doStyle(tiLine startResultLineNo, tiLine startStyleNeeded
    styles
    a pattern later in list overrides the previous one
    a pattern can restrict the styling to the search word
-   Process per line
-   from result look which Positions were found
-   from first to last position look 
-   if the line shall be styled or the word
-   execute the styling
+   Process
+   the result lines keep their style runs relative to the line text, so 
+   the main window is not asked. the style bytes of all lines from 
+   startResultLineNo until endStyleNeeded are collected in one buffer
+   and set with one SCI_SETSTYLINGEX
    */
-   tiLine resultLineNum = startResultLineNo;
-   tiLine styleBegin = startStyleNeeded;
-   tiLine maxResultLines = (tiLine)_scintView.execute(SCI_GETLINECOUNT);
-   tiLine endOfLine = (tiLine)(_scintView.execute(SCI_GETLINEENDPOSITION, resultLineNum)
-                     +((resultLineNum<maxResultLines)?2:0)); // CRLF is not in last line
-   //int charsHidden = 0;
-   do // for all lines to be styled
-   {
-      if(resultLineNum < mFindResults.size() ) 
-      {
-         const tlpLinePosInfo& rlpi = mFindResults.getLineAtRes(resultLineNum);
-         // for each pattern applicable for this line 
-         DBG2("doStyle() resLine %d size of patterns %d. ",
-            (int)resultLineNum, (int)rlpi.second.posInfos().size());
-         
-         tiLine iLength = endOfLine - styleBegin;                  
-         if(iLength < 0 ) {
-            DBG0("doStyle() ERROR negative line length");
-            continue;
-         } 
-         // default style
-         setDefaultStyle(styleBegin, iLength);
-         int iThisLineHead = _scintView.getLineNumbersInResult() ? miLineHeadSize : 0;
-         if(iLength <= iThisLineHead) {
-            DBG0("doStyle() line length 0 nothing to style");
-            ++resultLineNum;
-            styleBegin = (tiLine)_scintView.execute(SCI_POSITIONFROMLINE, resultLineNum);
-            endOfLine = (tiLine)_scintView.execute(SCI_GETLINEENDPOSITION, resultLineNum);
-            continue;
-         } 
-         tlmIdxPosInfo::const_iterator iPosInfo = rlpi.second.posInfos().begin();
-         for(; iPosInfo != rlpi.second.posInfos().end(); ++iPosInfo) 
-         {
-            // iPosInfo (PatternId, FoundPositions)
-            tclPatternList::const_iterator iPattern = mPatStyleList.find(iPosInfo->first);
-            if(iPattern == mPatStyleList.end()) {
-               DBG1("doStyle() ERROR invalid iPosInfo id %f! use default painter",
-                  iPosInfo->first);
-               // default style already done.
-               continue;
-            }
-            if(iPattern.getPattern().getSelectionType() == tclPattern::line) {
-               // style whole line if chars left after line header
-               DBG0("doStyle() style for line");
-               setStyle(iPosInfo->first, styleBegin+ iThisLineHead, iLength- iThisLineHead); // until end of line
-            } else {
-               // style per found positions
-               // iPosInfo calculates on mainWin text
-               tlsPosInfo::const_iterator iFoundPos = iPosInfo->second.begin();
-               for(; iFoundPos != iPosInfo->second.end(); ++iFoundPos) {
-                  tiLine iPosInfoLength = (iFoundPos->end - iFoundPos->start);
-                  tiLine iPosLineBegin = iFoundPos->start - (tiLine)_pParent->execute(teNppWindows::scnActiveHandle,SCI_POSITIONFROMLINE,iFoundPos->line);
-                  if((iPosInfoLength>0) && (iPosLineBegin>=0) &&
-                     ((styleBegin+ iThisLineHead +iPosLineBegin) >= styleBegin) &&
-                     (iPosInfoLength <= (endOfLine-styleBegin))) {
-                     // do styling 
-                        setStyle(iPosInfo->first, styleBegin+ iThisLineHead +iPosLineBegin, iPosInfoLength);
-                  } else {
-                     DBG4("doStyle() ERROR word styling pos illegal pos.start %d styleBegin %d pos.end %d endOfLine %d.",
-                        (int)styleBegin+ iThisLineHead +iPosLineBegin, (int)styleBegin,
-                        (int)styleBegin+ iThisLineHead +iPosLineBegin+iPosInfoLength, (int)endOfLine);
-                  }
-               }
-            }
-         }
-      } else {
-         // line in result is not in result list (one empty line break at the end)
-         // make style marker is moved until end as requested
-         DBG1("doStyle() called on empty line %d", (int)resultLineNum);
+   tiLine docLength = (tiLine)_scintView.execute(SCI_GETLENGTH);
+   if (endStyleNeeded > docLength) {
+      endStyleNeeded = docLength;
+   }
+   if (startStyleNeeded >= endStyleNeeded) {
+      return;
+   }
+   const char defStyle = (char)FNDRESDLG_DEFAULT_STYLE;
+   const size_t headSize = (size_t)getLineHeadSize();
+   mStyleBuffer.clear();
+   const size_t needed = (size_t)(endStyleNeeded - startStyleNeeded);
+   // the view holds the result lines from the first one of the window on
+   tiLine resLine = mWindow.getFirst() + startResultLineNo;
+   for (; resLine < mWindow.getEnd() && mStyleBuffer.size() < needed; ++resLine) {
+      unsigned length = 0;
+      mFindResults.getLineTextAtRes(resLine, length);
+      size_t textBegin = mStyleBuffer.size() + headSize;
+      mStyleBuffer.append(headSize + length, defStyle);
+      unsigned count = 0;
+      const tclFindResultDoc::tstStyleRun* pRun = mFindResults.getStyleRunsAtRes(resLine, count);
+      for (unsigned r = 0; r < count; ++r, ++pRun) {
+         mStyleBuffer.replace(textBegin + pRun->start, pRun->length, pRun->length, (char)pRun->style);
       }
-      ++resultLineNum;
-      styleBegin = (tiLine)_scintView.execute(SCI_POSITIONFROMLINE, resultLineNum);
-      endOfLine = (tiLine)_scintView.execute(SCI_GETLINEENDPOSITION, resultLineNum
-                       +((resultLineNum<maxResultLines)?2:0)); // CRLF is not in last line
-   } while ((styleBegin < endStyleNeeded)&&(resultLineNum < maxResultLines));
+   }
+   // line in result is not in result list (one empty line break at the end)
+   // make style marker is moved until end as requested
+   if (mStyleBuffer.size() < needed) {
+      mStyleBuffer.append(needed - mStyleBuffer.size(), defStyle);
+   }
+   DBG2("doStyle() %d lines %d chars", (int)(resLine - mWindow.getFirst() - startResultLineNo), (int)needed);
+   _scintView.execute(SCI_STARTSTYLING, startStyleNeeded, MY_STYLE_MASK);
+   _scintView.execute(SCI_SETSTYLINGEX, needed, (LPARAM)mStyleBuffer.data());
 }
 
 bool tclFindResultDlg::notify(SCNotification *notification)
@@ -926,19 +1452,28 @@ bool tclFindResultDlg::notify(SCNotification *notification)
 
             // get currently marked line in result doc
             tiLine resLineNo = (tiLine)_scintView.execute(SCI_LINEFROMPOSITION, currentPos);
-            if ((resLineNo >= _scintView.execute(SCI_GETLINECOUNT)) || (mFindResults.size() == 0)) {
+            if ((resLineNo >= _scintView.execute(SCI_GETLINECOUNT)) || (mWindow.getFirst() + resLineNo >= mFindResults.size())) {
                // we are out of editable range. don't do anything
                return TRUE;
             }
-            const tlpLinePosInfo& lineInfo = mFindResults.getLineAtRes(resLineNo);
-            tiLine lineMain = lineInfo.first;
+            resLineNo += mWindow.getFirst();
+            tiLine lineMain = mFindResults.getLineAtRes(resLineNo).line;
             //int startMain = (int)_pParent->execute(scnActiveHandle, SCI_POSITIONFROMLINE, lineMain, 0);
 
             //int cmd = NPPM_SWITCHTOFILE;//getMode()==FILES_IN_DIR?WM_DOOPEN:NPPM_SWITCHTOFILE;
             int iSuccess = (int)_pParent->execute(teNppWindows::nppHandle, NPPM_SWITCHTOFILE, 0, (LPARAM)getszFileName());
             if (iSuccess == 0) {
-               struct _stat st;
+               struct _stat64 st;
                iSuccess = (filestat(getszFileName(),&st))?0:1; // check if file exist -> ret == 0
+               if (iSuccess != 0 && mbOnDiskMode && st.st_size >= FNDRESDLG_OPEN_WARN_SIZE) {
+                  // notepad++ loads the whole file, which may take long or fail
+                  TCHAR msg[256];
+                  generic_sprintf(msg, TEXT("The file has %lld MB and notepad++ loads it completely.\nOpen it anyway?"),
+                                  (long long)(st.st_size / (1024 * 1024)));
+                  if (::MessageBox(_hSelf, msg, TEXT("Analyse Plugin - Open File"), MB_YESNO | MB_ICONQUESTION) != IDYES) {
+                     return TRUE;
+                  }
+               }
                // try to open it
                if (iSuccess != 0) {
                   iSuccess = (int)_pParent->execute(teNppWindows::nppHandle, NPPM_DOOPEN, 0, (LPARAM)getszFileName());
@@ -958,7 +1493,7 @@ bool tclFindResultDlg::notify(SCNotification *notification)
             }
 
             DBG3("notify(SCNotification) SCN_DOUBLECLICK to line  %d in %s line in result %d", 
-               (int)lineMain, getszFileName(), resLineNo);
+               (int)lineMain, getszFileName(), (int)resLineNo);
 
             ret = true;
 
@@ -981,15 +1516,33 @@ bool tclFindResultDlg::notify(SCNotification *notification)
       }
    case SCN_UPDATEUI:
    {
-      if (((notification->updated & SC_UPDATE_V_SCROLL) != 0) && _pParent->getIsSyncScroll()) {
-         tiLine currTopLine = (tiLine)_scintView.execute(SCI_GETFIRSTVISIBLELINE);
+      if (mbPageSearch) {
+         break; // the pages are only put in for searching
+      }
+      if ((notification->updated & SC_UPDATE_SELECTION) != 0) {
+         trackSelection();
+      }
+      if ((notification->updated & SC_UPDATE_V_SCROLL) == 0) {
+         break;
+      }
+      tiLine currTopLine = getViewTop();
+      if (!mWindow.getIsCovering(currTopLine, getScreenLines())) {
+         // the lines around are put in after painting
+         if (!mbWindowUpdatePosted) {
+            mbWindowUpdatePosted = true;
+            ::PostMessage(_hSelf, WM_COMMAND, FNDRESDLG_UPDATE_WINDOW, 0);
+         }
+      } else {
+         updateScrollBar();
+      }
+      // moving the window keeps the top line where it is
+      if (currTopLine != mViewTop && _pParent->getIsSyncScroll()) {
          DBG3("notify() SCN_UPDATEUI: Scroll to currTopLine=%d from main %d result %d", (int)currTopLine, mFromMainWindow, mFromFindResult);
          // setting mainwindow based on result windows setting is disabled to avoid echo causing 
          if (!mFromMainWindow) {
             mFromFindResult = true;
-            tiLine mainLine = mFindResults.getLineNoAtMain(currTopLine);
-            generic_string currFile;
-            if (_pParent->bCheckLastFileNameSame(currFile)) {
+            if (currTopLine < mFindResults.size() && _pParent->getIsResultOfActiveDoc()) {
+               tiLine mainLine = mFindResults.getLineNoAtMain(currTopLine);
                _pParent->execute(teNppWindows::scnActiveHandle, SCI_ENSUREVISIBLEENFORCEPOLICY, (WPARAM)mainLine);
             }
          }
@@ -998,6 +1551,7 @@ bool tclFindResultDlg::notify(SCNotification *notification)
             mFromFindResult = false;
          }
       }
+      mViewTop = currTopLine;
       break;
    }
    default :
@@ -1013,6 +1567,14 @@ void tclFindResultDlg::setFinderReadOnly(bool isReadOnly) {
    _scintView.execute(SCI_SETREADONLY, isReadOnly);
 }
 
+void tclFindResultDlg::initDocument() {
+   setFinderReadOnly(true);
+   // let window parent (this class) do the styling
+   _scintView.execute(SCI_SETILEXER,SCLEX_CONTAINER);
+   // the window is read only, so there is nothing to be undone
+   _scintView.execute(SCI_SETUNDOCOLLECTION, false);
+}
+
 void tclFindResultDlg::saveSearchDoc() {
    if (0 == mSearchResultFile.size()) {
       // no saving configured
@@ -1022,18 +1584,25 @@ void tclFindResultDlg::saveSearchDoc() {
    UnicodeConvertor.setEncoding(uniUTF8);
    if (UnicodeConvertor.openFile(mSearchResultFile.c_str()))
    {
-      char* buf = (char*) _scintView.execute(SCI_GETCHARACTERPOINTER); // vs. SCI_GETDOCPOINTER
-      unsigned long lengthDoc = (unsigned long)_scintView.getCurrentDocLen(); // TODO check 64-bit issue
-      if (lengthDoc && buf) {
-         bool items_written = UnicodeConvertor.writeFile(buf, lengthDoc);
-         UnicodeConvertor.closeFile();
-
-         // Error, we didn't write the entire document to disk.
-         // Note that fwrite() doesn't return the number of bytes written, but rather the number of ITEMS.
-         if(!items_written)
-         {
-            MessageBox(NULL, TEXT("Problem in save"), TEXT("tclFindResultDlg::saveSearchDoc"), MB_OK);
+      // the view only holds a part, so the lines are taken from the result
+      bool items_written = true;
+      std::string buf;
+      tiLine resLine = 0;
+      while (items_written && resLine < mFindResults.size()) {
+         buf.clear();
+         for (tiLine chunkEnd = resLine + FNDRESDLG_SAVE_CHUNK_LINES; 
+              resLine < chunkEnd && resLine < mFindResults.size(); ++resLine) {
+            appendResultLine(buf, resLine);
          }
+         items_written = UnicodeConvertor.writeFile(buf.data(), (unsigned long)buf.size());
+      }
+      UnicodeConvertor.closeFile();
+
+      // Error, we didn't write the entire document to disk.
+      // Note that fwrite() doesn't return the number of bytes written, but rather the number of ITEMS.
+      if(!items_written)
+      {
+         MessageBox(NULL, TEXT("Problem in save"), TEXT("tclFindResultDlg::saveSearchDoc"), MB_OK);
       }
    }
 }
@@ -18,7 +18,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 /* tclFindResultDlg.h 
 This class implements the handling of the search result window 
 it mainly contains the view based on scintilla and maintains parallel stored
-search result string cache
+search result string cache. the view only holds the lines around the visible
+ones, all others are taken out of the cache when they are scrolled in
 */
 
 #ifndef TCLFINDRESULTDLG_H
@@ -31,12 +32,28 @@ search result string cache
 #include "ScintillaSearchView.h"
 #include "tclFindResultDoc.h"
 #include "tclFindResultSearchDlg.h"
+#include "tclResultExport.h"
+#include "tclResultWindow.h"
 
 #define MY_STYLE_COUNT (MY_STYLE_MASK-8) // 0 and 32-39 are defaults
 
-class tclFindResultDlg : public DockingDlgInterface {
+class tclFindResultDlg : public DockingDlgInterface, public tclResultPager {
 
 public:
+   /**
+   * the content of the window put aside by saveResultView(); only the
+   * result lines are kept, the view renders them again when restored
+   */
+   struct tstResultView {
+      tstResultView() : lineNumColSize(0), bOnDiskMode(false), firstLine(0), memSize(0) {}
+      tclFindResultDoc results;
+      tclPatternList patStyles; // styles as used for the results
+      int lineNumColSize;
+      bool bOnDiskMode;
+      tiLine firstLine;         // result line on top of the view
+      size_t memSize;           // estimated bytes of the results
+   };
+
    tclFindResultDlg();
 
    ~tclFindResultDlg();
@@ -61,22 +78,60 @@ public:
 
    void create(tTbData * data, bool isRTL = false);
    
-   tiLine insertPosInfo(tPatId patternId, tiLine iResultLine, tclPosInfo pos);
+   void insertPosInfo(tPatId patternId, tiLine iResultLine, const tclPosInfo& pos);
 
    bool getLineAvail(tiLine foundLine) const ;
    tiLine getNextFoundLine(intptr_t iEdittorsLine) const;
 
-   const std::string& getLineText(intptr_t iResultLine);
+   std::string getLineText(intptr_t iResultLine) const;
 
    void setLineText(intptr_t iFoundLine, const std::string& text, const std::string& comment, unsigned commentWidth);
+
+   /**
+   * if the result window is empty the lines of the following setLineText()
+   * calls are only collected and the view is filled once with 
+   * endBulkUpdate()
+   * @return true if the bulk mode is active
+   */
+   bool beginBulkUpdate();
+   void endBulkUpdate();
+
+   /**
+   * the result comes from a file searched on disk and not from the editor:
+   * no bookmarks are set
+   */
+   void setOnDiskMode(bool bOn) {
+      mbOnDiskMode = bOn;
+   }
+   bool getOnDiskMode() const {
+      return mbOnDiskMode;
+   }
    
    void moveResult(tPatId oldPattId, tPatId newPattId);
 
+   /**
+   * move the lines from foundLine on after the main document was modified;
+   * the line numbers shown in the moved lines are updated
+   */
+   void shiftLines(tiLine foundLine, tiLine lineDelta);
+
    void updateWindowData(const generic_string& fontName, unsigned fontSize);
    
    void clear_view();
    void clear(bool initial = false);
 
+   /**
+   * move the content into view and continue with an empty window. unlike
+   * clear() the bookmarks in the main window stay, they belong to its document
+   */
+   void saveResultView(tstResultView& view);
+
+   /** show the content of view again instead of the actual one */
+   void restoreResultView(tstResultView& view);
+
+   /** free the content kept in view */
+   void releaseResultView(tstResultView& view);
+
    intptr_t getCurrentMarkedLine() const ;
    
    /**
@@ -96,6 +151,29 @@ public:
    void setUseBookmark(int useIt){
       mUseBookmark = useIt;
    }
+
+   /** colour the hits in the main window too */
+   void setHighlightMain(bool bOn);
+   bool getHighlightMain() const {
+      return mbHighlightMain;
+   }
+
+   /**
+   * colour the hits of the lines shown in the main window with indicators.
+   * only the lines on screen and a margin around them are coloured, so
+   * scrolling costs the lines on screen and not the count of hits.
+   * bForce colours them again after the result or the styles changed
+   */
+   void highlightMainView(bool bForce = false);
+
+   /** remove the colours of the hits from the document of the main window */
+   void clearMainHighlight();
+
+   /**
+   * ask notepad++ for the two indicators of highlightMainView(), so they
+   * don't clash with other plugins; older versions keep 16 and 17
+   */
+   void allocateIndicators();
    void setWrapMode(bool bOn) {
       _scintView.setWrapMode(bOn);
    }
@@ -130,6 +208,18 @@ public:
    void setCurrentViewPos(tiLine iThisMainLine);
    void updateViewScrollState(tiLine iLineInMain, bool bInMain, bool bAnyway=false);
 
+   /**
+   * put the changed result lines into the view; called by 
+   * updateDockingDlg() and after searches not updating the docking dialog
+   */
+   void updateWindow();
+
+   // tclResultPager
+   virtual void beginPageSearch();
+   virtual void showFirstPage(bool bDown);
+   virtual bool showNextPage(bool bDown);
+   virtual void endPageSearch(bool bFound);
+
 protected :
    static const int transStyleIdTab[MY_STYLE_COUNT];
    int transStyleId(unsigned int id) const;
@@ -142,15 +232,17 @@ protected :
 
    // identify the file to which the result shall be stored
    void doSaveToFile();
+
+   /** ask for a file and write the result once in format into it */
+   void doSaveExport(tclResultExport::teFormat format);
    // message call back method
    virtual INT_PTR CALLBACK run_dlgProc(UINT message, WPARAM wParam, LPARAM lParam);
 
-   /** 
-   this function sends the series of commands to 
-   scintilla win with the corresponding style id 
-   **/
-   void setStyle(tPatId iPatternId, tiLine iBeginPos, tiLine iLength);
-   void setDefaultStyle(tiLine iBeginPos, tiLine iLength);
+   /** hand the styles of mPatStyleList to the result lines */
+   void setResultStyles();
+
+   /** count of chars shown in front of the line text */
+   int getLineHeadSize() const;
 
    // callback from scintilla to colorize the search window
    void doStyle(tiLine startResultLineNo, tiLine startStyleNeeded, tiLine endStyleNeeded);
@@ -158,7 +250,64 @@ protected :
    bool notify(SCNotification *notification);
    
    void setFinderReadOnly(bool isReadOnly); 
+
+   /** settings scintilla keeps per document and not per view */
+   void initDocument();
+
+   /** style the lines shown in the window */
+   void colouriseVisible();
    void saveSearchDoc();
+
+   /** append line number and comment shown in front of the line text */
+   void appendLineHead(std::string& s, tiLine iFoundLine, const std::string& comment, unsigned commentWidth) const;
+
+   /** append result line resLine as shown in the view */
+   void appendResultLine(std::string& s, tiLine resLine) const;
+
+   /** append the line head of result line resLine as shown in the view */
+   void appendResultHead(std::string& s, tiLine resLine) const;
+
+   /** str in the code page of the view */
+   std::string getViewString(const generic_string& str) const;
+
+   /** hand the styles, pattern names and line heads of the view to exporter */
+   void initExport(tclResultExport& exporter) const;
+
+   /** result line on top of the view */
+   tiLine getViewTop() const;
+
+   /** lines fitting into the view */
+   tiLine getScreenLines() const;
+
+   /** put the result lines [first, first+count) into the view, resLine on top */
+   void fillWindow(tiLine first, tiLine count, tiLine topLine);
+
+   /** put the lines around topLine into the view */
+   void fillWindowAround(tiLine topLine);
+
+   /** show topLine on top and move the window if needed */
+   void scrollToResLine(tiLine topLine);
+
+   void updateScrollBar();
+   void doVScroll(int code);
+   void layoutView();
+
+   /** position in a result line; line size() is the end of the result */
+   struct tstResPos {
+      tiLine line;
+      tiLine col;
+   };
+   tstResPos getResPos(tiLine viewPos) const;
+   tiLine getViewPos(const tstResPos& pos) const;
+
+   /** take the selection of the view as far as it was changed by the user */
+   void trackSelection();
+   /** set the selection kept as far as it is in the view */
+   void restoreSelection();
+   void resetSelection();
+   void selectAll();
+   void copySelection();
+
    void setPatternFonts();
 
    MyPlugin* _pParent;
@@ -188,10 +337,33 @@ protected :
    int mUseBookmark;
    int mDisplayComment;
    generic_string mSearchResultFile;
+   generic_string mLastExportFile; // file of the last save once as rtf, html or csv
 #ifdef FEATURE_RESVIEW_POS_KEEP_AT_SEARCH
    tiLine mCurrentViewLineNo;
 #endif
    bool mFromMainWindow; // flag if main window moves the result window
+
+   bool mbBulkUpdate;
+   unsigned mCommentWidth;
    bool mFromFindResult; // flag set if double click moves the main window
+   bool mbOnDiskMode;
+
+   tclResultWindow mWindow; // result lines in the view
+   bool mbWindowDirty;      // result lines changed since the view was filled
+   bool mbWindowUpdatePosted;
+   bool mbPageSearch;       // find in result walks through the pages
+   tiLine mPageSearchTop;
+   tiLine mViewTop;         // top line at the last scroll notification
+   std::string mStyleBuffer; // style bytes of the range styled at once
+   HWND mhScrollBar;        // the scroll bar of scintilla only knows the window
+   tstResPos mSelAnchor;    // selection in result lines
+   tstResPos mSelCaret;
+   tiLine mViewAnchor;      // selection set into the view
+   tiLine mViewCaret;
+   bool mbHighlightMain;    // hits are coloured in the main window
+   tiLine mHighlightFirst;  // lines of the main window coloured
+   tiLine mHighlightEnd;
+   int mIndicFore;          // indicator of the text colour in the main window
+   int mIndicBack;          // indicator of the background colour
 };
 #endif //TCLFINDRESULTDLG_H
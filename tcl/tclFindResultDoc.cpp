@@ -26,125 +26,581 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #define MDBG_COMP "FRDoc:" 
 #include "myDebug.h"
 
+tclFindResultDoc::tclFindResultDoc()
+   : mvHitBegin(1, 0)
+   , mTextGarbage(0)
+   , mRunGarbage(0)
+   , mbResort(false)
+   , mbRemoved(false)
+   , mLastPat(0)
+{}
+
+unsigned tclFindResultDoc::getPatIndex(tPatId patternId) {
+   // hits are usually inserted pattern by pattern
+   if (mLastPat < mvPatIds.size() && mvPatIds[mLastPat] == patternId) {
+      return mLastPat;
+   }
+   for (mLastPat = 0; mLastPat < mvPatIds.size(); ++mLastPat) {
+      if (mvPatIds[mLastPat] == patternId) {
+         return mLastPat;
+      }
+   }
+   mvPatIds.push_back(patternId);
+   tstPatStyle ps;
+   ps.style = 0;
+   ps.bWholeLine = false;
+   ps.bValid = false;
+   mvPatStyles.push_back(ps);
+   return mLastPat;
+}
+
+bool tclFindResultDoc::hitLess(const tstHit& left, const tstHit& right) const {
+   // same order as the former set of tclPosInfo per pattern
+   if (mvPatIds[left.pattern] != mvPatIds[right.pattern]) {
+      return mvPatIds[left.pattern] < mvPatIds[right.pattern];
+   }
+   if (left.start != right.start) {
+      return left.start < right.start;
+   }
+   return left.length < right.length;
+}
+
+void tclFindResultDoc::update() const {
+   if (mvPending.size() == 0 && !mbResort && !mbRemoved) {
+      return;
+   }
+   std::sort(mvPending.begin(), mvPending.end(), [this](const tstPending& left, const tstPending& right) {
+      if (left.line != right.line) {
+         return left.line < right.line;
+      }
+      if (left.hit.pattern == noHit || right.hit.pattern == noHit) {
+         return left.hit.pattern == noHit && right.hit.pattern != noHit;
+      }
+      return hitLess(left.hit, right.hit);
+   });
+   size_t newLines = 0;
+   for (size_t i = 0; i < mvPending.size(); ++i) {
+      if (i == 0 || mvPending[i].line != mvPending[i - 1].line) {
+         ++newLines;
+      }
+   }
+   tlvLine lines;
+   std::vector<size_t> hitBegin;
+   tlvHit hits;
+   std::vector<size_t> textBegin;
+   std::vector<unsigned> textLength;
+   std::vector<size_t> runBegin;
+   std::vector<unsigned> runCount;
+   std::vector<unsigned char> flags;
+   lines.reserve(mvLines.size() + newLines);
+   hitBegin.reserve(mvLines.size() + newLines + 1);
+   hits.reserve(mvHits.size() + mvPending.size());
+   textBegin.reserve(mvLines.size() + newLines);
+   textLength.reserve(mvLines.size() + newLines);
+   runBegin.reserve(mvLines.size() + newLines);
+   runCount.reserve(mvLines.size() + newLines);
+   flags.reserve(mvLines.size() + newLines);
+   // merge the lines and within each line the hits
+   size_t iOld = 0;
+   size_t iNew = 0;
+   while (iOld < mvLines.size() || iNew < mvPending.size()) {
+      const bool bOld = iOld < mvLines.size() && 
+                        (iNew >= mvPending.size() || mvLines[iOld] <= mvPending[iNew].line);
+      const bool bNew = iNew < mvPending.size() && 
+                        (iOld >= mvLines.size() || mvPending[iNew].line <= mvLines[iOld]);
+      const tiLine line = bOld ? mvLines[iOld] : mvPending[iNew].line;
+      size_t o = bOld ? mvHitBegin[iOld] : 0;
+      const size_t oEnd = bOld ? mvHitBegin[iOld + 1] : 0;
+      size_t n = iNew;
+      size_t nEnd = iNew;
+      while (bNew && nEnd < mvPending.size() && mvPending[nEnd].line == line) {
+         ++nEnd;
+      }
+      if (mbResort && oEnd > o) {
+         std::sort(mvHits.begin() + o, mvHits.begin() + oEnd, [this](const tstHit& left, const tstHit& right) {
+            return hitLess(left, right);
+         });
+      }
+      const size_t first = hits.size();
+      // new or removed hits and a new pattern order change the styles of the line
+      bool bRestyle = bNew || mbResort;
+      while (o < oEnd || n < nEnd) {
+         if (o < oEnd && mvHits[o].pattern == noHit) {
+            ++o; // removed
+            bRestyle = true;
+            continue;
+         }
+         if (n < nEnd && mvPending[n].hit.pattern == noHit) {
+            ++n; // only the line
+            continue;
+         }
+         const tstHit* pHit;
+         if (n >= nEnd || (o < oEnd && !hitLess(mvPending[n].hit, mvHits[o]))) {
+            pHit = &mvHits[o++];
+         } else {
+            pHit = &mvPending[n++].hit;
+         }
+         // every position is stored once per pattern
+         if (hits.size() > first && hits.back().start == pHit->start && hits.back().length == pHit->length &&
+             mvPatIds[hits.back().pattern] == mvPatIds[pHit->pattern]) {
+            continue;
+         }
+         hits.push_back(*pHit);
+      }
+      lines.push_back(line);
+      hitBegin.push_back(first);
+      textBegin.push_back(bOld ? mvTextBegin[iOld] : 0);
+      textLength.push_back(bOld ? mvTextLength[iOld] : 0);
+      runBegin.push_back(bOld ? mvRunBegin[iOld] : 0);
+      runCount.push_back(bOld ? mvRunCount[iOld] : 0);
+      flags.push_back(bOld ? (unsigned char)(mvFlags[iOld] & ~(bRestyle ? lfStyled : 0)) : 0);
+      if (bOld) {
+         ++iOld;
+      }
+      if (bNew) {
+         iNew = nEnd;
+      }
+   }
+   hitBegin.push_back(hits.size());
+   mvLines.swap(lines);
+   mvHitBegin.swap(hitBegin);
+   mvHits.swap(hits);
+   mvTextBegin.swap(textBegin);
+   mvTextLength.swap(textLength);
+   mvRunBegin.swap(runBegin);
+   mvRunCount.swap(runCount);
+   mvFlags.swap(flags);
+   tlvPending().swap(mvPending);
+   mbResort = false;
+   mbRemoved = false;
+}
+
+size_t tclFindResultDoc::findLine(tiLine foundLine) const {
+   tlvLine::const_iterator it = std::lower_bound(mvLines.begin(), mvLines.end(), foundLine);
+   if (it != mvLines.end() && *it == foundLine) {
+      return (size_t)(it - mvLines.begin());
+   }
+   return mvLines.size();
+}
+
+void tclFindResultDoc::compactText() const {
+   std::string text;
+   text.reserve(mText.size() - mTextGarbage);
+   for (size_t i = 0; i < mvLines.size(); ++i) {
+      size_t begin = text.size();
+      text.append(mText, mvTextBegin[i], mvTextLength[i]);
+      mvTextBegin[i] = begin;
+   }
+   mText.swap(text);
+   mTextGarbage = 0;
+}
+
+void tclFindResultDoc::compactRuns() const {
+   std::vector<tstStyleRun> runs;
+   runs.reserve(mvRuns.size() - mRunGarbage);
+   for (size_t i = 0; i < mvLines.size(); ++i) {
+      if ((mvFlags[i] & lfStyled) == 0) {
+         // resolved again when needed
+         mvRunCount[i] = 0;
+      }
+      size_t begin = runs.size();
+      runs.insert(runs.end(), mvRuns.begin() + mvRunBegin[i], mvRuns.begin() + mvRunBegin[i] + mvRunCount[i]);
+      mvRunBegin[i] = begin;
+   }
+   mvRuns.swap(runs);
+   mRunGarbage = 0;
+}
+
+void tclFindResultDoc::buildStyleRuns(size_t i) const {
+   mRunGarbage += mvRunCount[i];
+   mvRunBegin[i] = mvRuns.size();
+   resolveStyleRuns(i, mvRuns);
+   mvRunCount[i] = (unsigned)(mvRuns.size() - mvRunBegin[i]);
+   mvFlags[i] |= lfStyled;
+}
+
+void tclFindResultDoc::resolveStyleRuns(size_t i, std::vector<tstStyleRun>& runs) const {
+   const unsigned length = mvTextLength[i];
+   // style per character, -1 keeps the default style
+   mvStyleScratch.assign(length, -1);
+   // the hits are sorted by pattern id; a later pattern overrides the ones before
+   for (size_t h = mvHitBegin[i]; h < mvHitBegin[i + 1]; ++h) {
+      const tstHit& hit = mvHits[h];
+      if (hit.pattern == noHit || !mvPatStyles[hit.pattern].bValid) {
+         continue;
+      }
+      const tstPatStyle& ps = mvPatStyles[hit.pattern];
+      unsigned begin = 0;
+      unsigned end = length;
+      if (!ps.bWholeLine) {
+         if (hit.start < 0 || hit.start >= (tiLine)length || hit.length == 0) {
+            DBG2("resolveStyleRuns() hit at %d outside of line length %d", (int)hit.start, (int)length);
+            continue;
+         }
+         begin = (unsigned)hit.start;
+         end = (hit.length < length - begin) ? begin + hit.length : length;
+      }
+      std::fill(mvStyleScratch.begin() + begin, mvStyleScratch.begin() + end, (int)ps.style);
+   }
+   unsigned p = 0;
+   while (p < length) {
+      unsigned q = p + 1;
+      while (q < length && mvStyleScratch[q] == mvStyleScratch[p]) {
+         ++q;
+      }
+      if (mvStyleScratch[p] >= 0) {
+         tstStyleRun run;
+         run.start = p;
+         run.length = q - p;
+         run.style = (unsigned char)mvStyleScratch[p];
+         runs.push_back(run);
+      }
+      p = q;
+   }
+}
+
+void tclFindResultDoc::invalidateStyles() const {
+   for (size_t i = 0; i < mvLines.size(); ++i) {
+      mvFlags[i] &= ~lfStyled;
+      mvRunCount[i] = 0;
+   }
+   std::vector<tstStyleRun>().swap(mvRuns);
+   mRunGarbage = 0;
+}
+
 /**
 * insert the line into the result window if not already in.
-* @return the resultwindow line number; (-1 is error case and should never come)
+* the position is relative to the line start
 */
-tiLine tclFindResultDoc::insertPosInfo(tPatId patternId, tiLine foundLine, tclPosInfo pos) {
-   // check line in
-   mLines[foundLine].posInfos()[patternId].insert(pos);
-   insertResLine(foundLine);
-   return getLineNoAtRes(foundLine);
-}
-
-/** function creates an empty line if not available before */
-std::string& tclFindResultDoc::refLineText(tiLine foundLine) {
-   return mLines[foundLine].text();
+void tclFindResultDoc::insertPosInfo(tPatId patternId, tiLine foundLine, const tclPosInfo& pos) {
+   tstPending p;
+   p.line = foundLine;
+   p.hit.start = pos.start;
+   p.hit.length = (unsigned)(pos.end - pos.start);
+   p.hit.pattern = getPatIndex(patternId);
+   mvPending.push_back(p);
 }
 
 bool tclFindResultDoc::getLineAvail(tiLine foundLine) const {
-   tlmLinePosInfo::const_iterator it = mLines.find(foundLine);
-   if(it!=mLines.end()) {
-      return it->second.valid();
+   update();
+   size_t i = findLine(foundLine);
+   if (i < mvLines.size()) {
+      return (mvFlags[i] & lfValid) != 0;
    }
    return false;
 }
 
-/** function creates an empty line if not available before */
-const std::string& tclFindResultDoc::getLineText(tiLine foundLine) {
-   tlmLinePosInfo::const_iterator it = mLines.find(foundLine);
-   if(it!=mLines.end()) {
-      return it->second.text();
-   } else {
-      return mDefLineInfo.second.text();
+/** returns an empty string if line not available */
+std::string tclFindResultDoc::getLineText(tiLine foundLine) const {
+   update();
+   size_t i = findLine(foundLine);
+   if (i < mvLines.size()) {
+      return std::string(mText, mvTextBegin[i], mvTextLength[i]);
    }
+   return std::string();
 }
 
 /** setLineText returns true in case that line was added or updated */
 bool tclFindResultDoc::setLineText(tiLine foundLine, const std::string& text) {
-   tlmLinePosInfo::iterator it = mLines.find(foundLine); 
-   bool bNew;
-   if(it != mLines.end()) {
-      bNew = !it->second.valid();
-      it->second.first = tclResultLine(text);
-   } else {
-      bNew = true;
-      mLines[foundLine].first = tclResultLine(text);
-      insertResLine(foundLine);
+   update();
+   size_t i = findLine(foundLine);
+   if (i == mvLines.size()) {
+      // line without hit
+      tstPending p;
+      p.line = foundLine;
+      p.hit.start = 0;
+      p.hit.length = 0;
+      p.hit.pattern = noHit;
+      mvPending.push_back(p);
+      update();
+      i = findLine(foundLine);
+   }
+   bool bNew = (mvFlags[i] & lfValid) == 0;
+   mTextGarbage += mvTextLength[i];
+   mvTextBegin[i] = mText.size();
+   mvTextLength[i] = (unsigned)text.size();
+   mText.append(text);
+   // if text.size()==0 the line will become invisible but valid
+   // the runs are clamped to the text, so they are resolved again
+   mvFlags[i] = (unsigned char)(lfValid | ((text.size() > 0) ? lfVisible : 0));
+   if (mTextGarbage > mText.size() / 2) {
+      compactText();
    }
    return bNew;
 }
 
+const char* tclFindResultDoc::getLineTextAtRes(tiLine resultWinLine, unsigned& length) const {
+   update();
+   if(resultWinLine >= (tiLine)mvLines.size() || resultWinLine < 0) {
+      assert(resultWinLine < (tiLine)mvLines.size()); // index out of range
+      length = 0;
+      return "";
+   }
+   length = mvTextLength[resultWinLine];
+   return mText.data() + mvTextBegin[resultWinLine];
+}
+
+void tclFindResultDoc::setPatternStyle(tPatId patternId, unsigned char style, bool bWholeLine) {
+   getPatIndex(patternId);
+   // after moveResult() the id may be in the table more than once
+   bool bChanged = false;
+   for (size_t i = 0; i < mvPatIds.size(); ++i) {
+      tstPatStyle& ps = mvPatStyles[i];
+      if (mvPatIds[i] != patternId || (ps.bValid && ps.style == style && ps.bWholeLine == bWholeLine)) {
+         continue;
+      }
+      ps.style = style;
+      ps.bWholeLine = bWholeLine;
+      ps.bValid = true;
+      bChanged = true;
+   }
+   if (bChanged) {
+      update();
+      invalidateStyles();
+   }
+}
+
+const tclFindResultDoc::tstStyleRun* tclFindResultDoc::getStyleRunsAtRes(tiLine resultWinLine, unsigned& count) const {
+   update();
+   if(resultWinLine >= (tiLine)mvLines.size() || resultWinLine < 0) {
+      assert(resultWinLine < (tiLine)mvLines.size()); // index out of range
+      count = 0;
+      return 0;
+   }
+   if ((mvFlags[resultWinLine] & lfStyled) == 0) {
+      buildStyleRuns((size_t)resultWinLine);
+      if (mRunGarbage > mvRuns.size() / 2) {
+         compactRuns();
+      }
+   }
+   count = mvRunCount[resultWinLine];
+   return mvRuns.data() + mvRunBegin[resultWinLine];
+}
+
+void tclFindResultDoc::getStyleRuns(tiLine resultWinLine, std::vector<tstStyleRun>& runs) const {
+   update();
+   runs.clear();
+   if(resultWinLine >= (tiLine)mvLines.size() || resultWinLine < 0) {
+      assert(resultWinLine < (tiLine)mvLines.size()); // index out of range
+      return;
+   }
+   if ((mvFlags[resultWinLine] & lfStyled) != 0) {
+      const tstStyleRun* pRun = mvRuns.data() + mvRunBegin[resultWinLine];
+      runs.assign(pRun, pRun + mvRunCount[resultWinLine]);
+   }
+   else {
+      resolveStyleRuns((size_t)resultWinLine, runs);
+   }
+}
+
 void tclFindResultDoc::reserve(unsigned count) {
-   mReslines.reserve(count);
+   mvPending.reserve(mvPending.size() + count);
 }
 
 void tclFindResultDoc::clear() {
-   mLines.clear();
-   mReslines.clear();
+   tlvLine().swap(mvLines);
+   mvHitBegin.assign(1, 0);
+   tlvHit().swap(mvHits);
+   std::vector<size_t>().swap(mvTextBegin);
+   std::vector<unsigned>().swap(mvTextLength);
+   std::vector<size_t>().swap(mvRunBegin);
+   std::vector<unsigned>().swap(mvRunCount);
+   std::vector<tstStyleRun>().swap(mvRuns);
+   std::vector<int>().swap(mvStyleScratch);
+   std::vector<unsigned char>().swap(mvFlags);
+   std::string().swap(mText);
+   tlvPending().swap(mvPending);
+   mvPatIds.clear();
+   mvPatStyles.clear();
+   mTextGarbage = 0;
+   mRunGarbage = 0;
+   mbResort = false;
+   mbRemoved = false;
+   mLastPat = 0;
+}
+
+void tclFindResultDoc::swap(tclFindResultDoc& other) {
+   mvLines.swap(other.mvLines);
+   mvHitBegin.swap(other.mvHitBegin);
+   mvHits.swap(other.mvHits);
+   mvTextBegin.swap(other.mvTextBegin);
+   mvTextLength.swap(other.mvTextLength);
+   mvFlags.swap(other.mvFlags);
+   mText.swap(other.mText);
+   std::swap(mTextGarbage, other.mTextGarbage);
+   mvRunBegin.swap(other.mvRunBegin);
+   mvRunCount.swap(other.mvRunCount);
+   mvRuns.swap(other.mvRuns);
+   std::swap(mRunGarbage, other.mRunGarbage);
+   mvStyleScratch.swap(other.mvStyleScratch);
+   mvPending.swap(other.mvPending);
+   std::swap(mbResort, other.mbResort);
+   std::swap(mbRemoved, other.mbRemoved);
+   mvPatIds.swap(other.mvPatIds);
+   mvPatStyles.swap(other.mvPatStyles);
+   std::swap(mLastPat, other.mLastPat);
+}
+
+size_t tclFindResultDoc::getMemorySize() const {
+   return sizeof(*this) +
+      mvLines.capacity() * sizeof(tiLine) +
+      mvHitBegin.capacity() * sizeof(size_t) +
+      mvHits.capacity() * sizeof(tstHit) +
+      mvTextBegin.capacity() * sizeof(size_t) +
+      mvTextLength.capacity() * sizeof(unsigned) +
+      mvRunBegin.capacity() * sizeof(size_t) +
+      mvRunCount.capacity() * sizeof(unsigned) +
+      mvRuns.capacity() * sizeof(tstStyleRun) +
+      mvStyleScratch.capacity() * sizeof(int) +
+      mvFlags.capacity() +
+      mText.capacity() +
+      mvPending.capacity() * sizeof(tstPending) +
+      mvPatIds.capacity() * sizeof(tPatId) +
+      mvPatStyles.capacity() * sizeof(tstPatStyle);
 }
 
 tiLine tclFindResultDoc::size() const {
-   return (tiLine)mLines.size();
+   update();
+   return (tiLine)mvLines.size();
 }
 
-void tclFindResultDoc::erase(tiLine foundLine){
-   removeResLine(foundLine);
-   mLines.erase(foundLine);
+void tclFindResultDoc::removePosInfos(tPatId patternId, const tlvLine& foundLines, tlvLine& emptyLines) {
+   update();
+   emptyLines.clear();
+   tlvLine::const_iterator iLine = foundLines.begin();
+   tlvLine::const_iterator iLast = mvLines.begin();
+   for (; iLine != foundLines.end(); ++iLine) {
+      // lines are sorted, so the search continues behind the last one
+      iLast = std::lower_bound(iLast, mvLines.cend(), *iLine);
+      if (iLast == mvLines.end()) {
+         break;
+      }
+      if (*iLast != *iLine) {
+         DBG1("removePosInfos() found line %d already removed", (int)*iLine);
+         continue;
+      }
+      size_t i = (size_t)(iLast - mvLines.begin());
+      unsigned left = 0;
+      for (size_t h = mvHitBegin[i]; h < mvHitBegin[i + 1]; ++h) {
+         if (mvHits[h].pattern != noHit && mvPatIds[mvHits[h].pattern] == patternId) {
+            mvHits[h].pattern = noHit;
+            mbRemoved = true;
+         } else if (mvHits[h].pattern != noHit) {
+            ++left;
+         }
+      }
+      if (left == 0 && (emptyLines.size() == 0 || emptyLines.back() != *iLine)) {
+         emptyLines.push_back(*iLine);
+      }
+   }
+}
+
+void tclFindResultDoc::eraseLines(const tlvLine& foundLines) {
+   update();
+   if (foundLines.size() == 0) {
+      return;
+   }
+   // compact the columns in place
+   size_t w = 0;
+   size_t wHit = 0;
+   tlvLine::const_iterator iErase = foundLines.begin();
+   for (size_t r = 0; r < mvLines.size(); ++r) {
+      const size_t hitBegin = mvHitBegin[r];
+      const size_t hitEnd = mvHitBegin[r + 1];
+      while (iErase != foundLines.end() && *iErase < mvLines[r]) {
+         ++iErase;
+      }
+      if (iErase != foundLines.end() && *iErase == mvLines[r]) {
+         mTextGarbage += mvTextLength[r];
+         mRunGarbage += mvRunCount[r];
+         continue;
+      }
+      mvLines[w] = mvLines[r];
+      mvHitBegin[w] = wHit;
+      mvTextBegin[w] = mvTextBegin[r];
+      mvTextLength[w] = mvTextLength[r];
+      mvRunBegin[w] = mvRunBegin[r];
+      mvRunCount[w] = mvRunCount[r];
+      mvFlags[w] = mvFlags[r];
+      for (size_t h = hitBegin; h < hitEnd; ++h) {
+         mvHits[wHit++] = mvHits[h];
+      }
+      ++w;
+   }
+   mvLines.resize(w);
+   mvHitBegin.resize(w + 1);
+   mvHitBegin[w] = wHit;
+   mvHits.resize(wHit);
+   mvTextBegin.resize(w);
+   mvTextLength.resize(w);
+   mvRunBegin.resize(w);
+   mvRunCount.resize(w);
+   mvFlags.resize(w);
+   if (mTextGarbage > mText.size() / 2) {
+      compactText();
+   }
+   if (mRunGarbage > mvRuns.size() / 2) {
+      compactRuns();
+   }
 }
 
 void tclFindResultDoc::moveResult(tPatId oldPattId, tPatId newPattId)
 {
    DBG2("moveResult(old, new) %f %f", oldPattId, newPattId);
-   // iterate over all lines and change old in new id
-   tlmLinePosInfo::iterator it = mLines.begin();
-   for(;it != mLines.end(); ++it) {
-      tlmIdxPosInfo& posInfos = it->second.posInfos();
-      tlmIdxPosInfo::iterator iOld = posInfos.find(oldPattId);
-      if(iOld != posInfos.end()) {
-         // old pattern found in this line -> move
-         posInfos[newPattId] = iOld->second;
-         posInfos.erase(iOld);
+   // only the id table changes, but the hits have to be sorted again
+   update();
+   std::vector<tPatId>::iterator it = mvPatIds.begin();
+   for (; it != mvPatIds.end(); ++it) {
+      if (*it == oldPattId) {
+         *it = newPattId;
+         mbResort = true;
       }
    }
+   if (mbResort) {
+      // the precedence of the patterns has changed
+      invalidateStyles();
+   }
+}
+
+tiLine tclFindResultDoc::shiftLines(tiLine foundLine, tiLine lineDelta)
+{
+   DBG2("shiftLines() from %d lines %d", (int)foundLine, (int)lineDelta);
+   update();
+   size_t first = (size_t)(std::lower_bound(mvLines.begin(), mvLines.end(), foundLine) - mvLines.begin());
+   // the positions are relative to the lines and stay
+   for (size_t i = first; i < mvLines.size(); ++i) {
+      mvLines[i] += lineDelta;
+   }
+   return (tiLine)first;
 }
 
 /** make sure function is not called with resultWinLine >= size() */
-const tlpLinePosInfo& tclFindResultDoc::getLineAtRes(tiLine resultWinLine) const {
+tclFindResultDoc::tstLineHits tclFindResultDoc::getLineAtRes(tiLine resultWinLine) const {
+   update();
+   tstLineHits lh;
+   lh.line = 0;
+   lh.begin = 0;
+   lh.end = 0;
    if(resultWinLine >= size()) {
       if (resultWinLine == size() && resultWinLine > 0) {
          // special case click in CR from last line
          --resultWinLine;
       } else {
          assert(resultWinLine == 0 || resultWinLine < size()); // index out of range
-         return mDefLineInfo;
+         return lh;
       }
    }
-   tiLine foundLine = mReslines[resultWinLine];
-   tlmLinePosInfo::const_iterator it = mLines.lower_bound(foundLine);
-   if((it!= mLines.end())&&(it->first==foundLine)) {
-      return *it;
-   } else {
-      assert((it!= mLines.end())&&(it->first==foundLine)); // index out of range
-      return mDefLineInfo;
-   }
-}
-
-/** function returns empty line (default CTOR) if not available before */
-const tclLinePosInfo& tclFindResultDoc::getLineAtMain(tiLine foundLine) const {
-   tlmLinePosInfo::const_iterator it = mLines.lower_bound(foundLine);
-   if((it!= mLines.end())&&(it->first==foundLine)) {
-      return it->second;
-   } else {
-      assert((it!= mLines.end())&&(it->first==foundLine)); // index out of range
-      return mDefLineInfo.second;
-   }
+   lh.line = mvLines[resultWinLine];
+   lh.begin = mvHits.data() + mvHitBegin[resultWinLine];
+   lh.end = mvHits.data() + mvHitBegin[resultWinLine + 1];
+   return lh;
 }
 
 tiLine tclFindResultDoc::getNextLineNoAtMain(tiLine iFirstLineInView) const {
-   tlmLinePosInfo::const_iterator it = mLines.lower_bound(iFirstLineInView);
-   if (it != mLines.end()) {
-      return it->first;
+   update();
+   tlvLine::const_iterator it = std::lower_bound(mvLines.begin(), mvLines.end(), iFirstLineInView);
+   if (it != mvLines.end()) {
+      return *it;
    }
    else {
       return (tiLine)-1;
@@ -153,82 +609,25 @@ tiLine tclFindResultDoc::getNextLineNoAtMain(tiLine iFirstLineInView) const {
 
 /** function returns true if available */
 bool tclFindResultDoc::getLineAtMainAvail(tiLine foundLine) const {
-   tlmLinePosInfo::const_iterator it = mLines.lower_bound(foundLine);
-   if((it!= mLines.end())&&(it->first==foundLine)) {
-      return true;
-   } else {
-      return false;
-   }
-}
-
-/** function returns newly inserted element if not available before */
-tclLinePosInfo& tclFindResultDoc::refLineAtMain(tiLine foundLine) {
-   return mLines[foundLine];
+   update();
+   return findLine(foundLine) < mvLines.size();
 }
 
 tiLine tclFindResultDoc::getLineNoAtRes(tiLine foundLine) const {
-   //tlmLinePosInfo::const_iterator it = mLines.find(foundLine);
-   // inform window to redraw the given line array
-   tiLine i=-1;
-   //// go the shorteset way to the end and count the lines before or after
-   tlvLine::const_iterator first = mReslines.begin();
-   tlvLine::const_iterator last, it;
-
-   if ( (tiLine)mReslines.size() > foundLine ) {
-      last = mReslines.begin() + foundLine;
-   } else {
-      last = mReslines.end();
+   update();
+   size_t i = findLine(foundLine);
+   if (i < mvLines.size()) {
+      return (tiLine)i;
    }
-   it = std::lower_bound(first, last, foundLine);
-   if((it != mReslines.end())&&(*it == foundLine)) {
-      i = (tiLine)(it - first);
-   } else {assert(0); }
-   return i;
+   assert(0);
+   return -1;
 }
 
 /** make sure function is not called with resultWinLine >= size() */
 tiLine tclFindResultDoc::getLineNoAtMain(tiLine resultWinLine) const {
-   if(resultWinLine >= size() ) {
+   if(resultWinLine >= size() || resultWinLine < 0) {
       assert(resultWinLine <= size()); // index out of range but 0 should be not be an error as it is reset scintilla
       return -1;
    }
-   return mReslines.at(resultWinLine);
-}
-
-void tclFindResultDoc::insertResLine(tiLine foundLine) {
-   // from resline == foundline we start searching for the real place
-   // foundline cannot be bigger as resline
-   tlvLine::iterator first = mReslines.begin(),
-      last, it;
-   if ( (tiLine)mReslines.size() > foundLine) {
-      last = mReslines.begin() + foundLine;
-   } else {
-      last = mReslines.end();
-   }
-   it = std::lower_bound(first, last, foundLine);
-   if(it == mReslines.end()) {
-      mReslines.insert(it, foundLine);
-   } else if(*it > foundLine) {
-      mReslines.insert(it, foundLine);
-   }
-}
-
-void tclFindResultDoc::removeResLine(tiLine foundLine) {
-   // from resline == foundline we start searching for the real place
-   // foundline cannot be bigger as resline
-   tlvLine::iterator first = mReslines.begin(),
-      last, it;
-   if ( (tiLine)mReslines.size() > foundLine) {
-      last = mReslines.begin() + foundLine;
-   } else {
-      last = mReslines.end();
-   }
-   it = std::lower_bound(first, last, foundLine);
-   if(it == mReslines.end()) {
-      assert(0); // line allready removed!
-   } else if(*it == foundLine) {
-      mReslines.erase(it);
-   } else if(*it > foundLine) {
-      assert(0); // line allready removed!
-   }
+   return mvLines[resultWinLine];
 }
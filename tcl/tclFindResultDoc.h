@@ -19,141 +19,211 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #ifndef TCLFINDRESULTDOC_H
 #define TCLFINDRESULTDOC_H
 
-#include <map>
-#include <set>
 #include <vector>
 #include <string>
-#include "MyPlugin.h"
 #include "tclPosInfo.h"
 
-class tclResultLine
-{
-public:
-   tclResultLine():bVisible(false), bValid(false){}
-   tclResultLine(const tclResultLine& right)
-      :bVisible(right.bVisible), bValid(right.bValid),text(right.text){}
-   // special constructor for adding or deleting lines.
-   // if str.size()==0 the line will become invisible but valid
-   tclResultLine(const std::string& str)
-      :bVisible(str.size()>0), bValid(true),text(str){}
-   tclResultLine& operator=(const tclResultLine& right) {
-      if(&right==this) {
-         return *this;
-      }
-      bVisible = right.bVisible;
-      bValid = right.bValid;
-      text = right.text;
-      return *this;
-      }
-   bool bVisible; // if to be displayed
-   bool bValid; // if at least once set
-   std::string text;
-};
-
-
-typedef std::set<tclPosInfo> tlsPosInfo; // second -> set of pos infos for one pattern per line 
-typedef std::map<tPatId, tlsPosInfo> tlmIdxPosInfo; // position and according pattern
-
-// second -> line and found positions
-class tclLinePosInfo : public std::pair<tclResultLine, tlmIdxPosInfo> {
-public:
-   tclLinePosInfo()
-      :std::pair<tclResultLine, tlmIdxPosInfo>() {}
-   tclLinePosInfo(const std::string& line, const tlmIdxPosInfo& pos)
-      :std::pair<tclResultLine, tlmIdxPosInfo>(line,pos) {}
-   tclLinePosInfo(const tclLinePosInfo& other)
-      :std::pair<tclResultLine, tlmIdxPosInfo>(other){}
-   // my accessors
-   const std::string& text() const { return first.text; }
-   std::string& text() { return first.text; }
-   const bool& visible() const { return first.bVisible; }
-   bool& visible() { return first.bVisible; }
-   const bool& valid() const { return first.bValid; }
-   bool& valid() { return first.bValid; }
-   const tlmIdxPosInfo& posInfos () const { return second; }
-   tlmIdxPosInfo& posInfos () { return second; }
-};
-
-typedef std::pair<const tiLine, tclLinePosInfo> tlpLinePosInfo; // pair of the map
-typedef std::map<tiLine, tclLinePosInfo> tlmLinePosInfo; // result list complete
 typedef std::vector<tiLine> tlvLine;
 
-
 /**
 * the find result doc is an implementation of all searchresults ordered by their 
 * line number of the found position. It maintains the relation ship between line 
 * number in the edit window of the result, the line number in the main window and 
 * the index information which pattern caused this find position.
-* It maintains the data in a triple map which on first level qualifies the line
-* and on second the pattern index and on third level a set of sorted positions.
+* The data is kept in columns: a sorted array of the found lines, which index
+* is the line in the result window, per line an offset into one flat array of
+* hits and the line texts in one common text buffer.
+* Inserted hits are collected and merged into the columns with the next read
+* access, so that many inserts cost one merge.
+* The positions of the hits are relative to their line, so the styles of a
+* line are known without asking the main window. They are resolved into
+* style runs once per line and kept until its hits or the styles change.
 */
 class tclFindResultDoc {
 public:
+   /** one found position; the line is given by the result line it belongs to */
+   struct tstHit {
+      tiLine start;     // start position in its line of the main window
+      unsigned length;  // length of the found text
+      unsigned pattern; // index into the pattern id table
+   };
+
+   /** the hits of one result line sorted by pattern id and position */
+   struct tstLineHits {
+      tiLine line;         // line number in main window
+      const tstHit* begin;
+      const tstHit* end;
+   };
+
+   /** styled part of a line text; the text between the runs keeps the default style */
+   struct tstStyleRun {
+      unsigned start;      // position in the line text
+      unsigned length;
+      unsigned char style;
+   };
+
+   tclFindResultDoc();
 
    /**
-   * insert the line into the result window if not already in.
-   * @return the resultwindow line number; (-1 is error case and should never come)
+   * insert the line into the result window if not already in. the
+   * position is relative to the line start. the hit becomes visible with
+   * the next read access
    */
-   tiLine insertPosInfo(tPatId patternId, tiLine foundLine, tclPosInfo pos); 
-
-   /** function creates an empty line if not available before */
-   std::string& refLineText(tiLine foundLine); 
+   void insertPosInfo(tPatId patternId, tiLine foundLine, const tclPosInfo& pos); 
 
    bool getLineAvail(tiLine foundLine) const ;
 
-   /** function creates an empty line if not available before */
-   const std::string& getLineText(tiLine foundLine); 
+   /** returns an empty string if line not available */
+   std::string getLineText(tiLine foundLine) const; 
 
    /** setLineText returns true in case that line was added or updated */
    bool setLineText(tiLine foundLine, const std::string& text); 
 
+   /** 
+   * text of the result line without copying; valid until the next 
+   * modification. make sure function is not called with resultWinLine >= size() 
+   */
+   const char* getLineTextAtRes(tiLine resultWinLine, unsigned& length) const;
+
    void reserve(unsigned count); 
 
    void clear(); 
 
+   /** exchange the complete content with other */
+   void swap(tclFindResultDoc& other);
+
+   /** bytes allocated for the content */
+   size_t getMemorySize() const;
+
    tiLine size() const;
 
-   void erase(tiLine foundLine);
+   /**
+   * remove the hits of the pattern from the given lines, which have to be
+   * sorted. the lines left without hits are returned in emptyLines
+   */
+   void removePosInfos(tPatId patternId, const tlvLine& foundLines, tlvLine& emptyLines);
+
+   /** remove the given sorted lines */
+   void eraseLines(const tlvLine& foundLines);
 
    void moveResult(tPatId oldPattId, tPatId newPattId);
 
+   /**
+   * move all lines from foundLine on by lineDelta lines after the main
+   * document was modified.
+   * @return the resultwindow line number of the first moved line
+   */
+   tiLine shiftLines(tiLine foundLine, tiLine lineDelta);
+
+   /**
+   * style of the hits of the pattern; bWholeLine styles the complete line
+   * text. a pattern with a higher id wins over the ones before
+   */
+   void setPatternStyle(tPatId patternId, unsigned char style, bool bWholeLine);
+
+   /**
+   * style runs of the line text of a result line, sorted by position and
+   * not overlapping. make sure function is not called with resultWinLine >= size()
+   */
+   const tstStyleRun* getStyleRunsAtRes(tiLine resultWinLine, unsigned& count) const;
+
+   /**
+   * the same runs copied into runs without keeping them, for walking
+   * through all lines once. make sure function is not called with 
+   * resultWinLine >= size()
+   */
+   void getStyleRuns(tiLine resultWinLine, std::vector<tstStyleRun>& runs) const;
+
    /** make sure function is not called with resultWinLine >= size() */
-   const tlpLinePosInfo& getLineAtRes(tiLine resultWinLine) const;
-   
-   /** function returns empty line (default CTOR) if not available before */
-   const tclLinePosInfo& getLineAtMain(tiLine foundLine) const;
+   tstLineHits getLineAtRes(tiLine resultWinLine) const;
 
+   /** pattern id of a hit returned by getLineAtRes() */
+   tPatId getPatId(const tstHit& hit) const {
+      return mvPatIds[hit.pattern];
+   }
+   
    /** returns the next found line number in main window for seeking to it after search has finished
        In case no more found lines follow after the given line the return is -1 == ERROR.
    **/
    tiLine getNextLineNoAtMain(tiLine iFirstLineInView) const;
 
-   /** function returns empty line (default CTOR) if not available before */
+   /** function returns true if available */
    bool getLineAtMainAvail(tiLine foundLine) const; 
 
-   /** function returns newly inserted element if not available before */
-   tclLinePosInfo& refLineAtMain(tiLine foundLine); 
-
-
    tiLine getLineNoAtRes(tiLine foundLine) const; 
 
    /** make sure function is not called with resultWinLine >= size() */
    tiLine getLineNoAtMain(tiLine resultWinLine) const;
 
-
-
 protected:
-   void insertResLine(tiLine foundLine); 
-   void removeResLine(tiLine foundLine); 
-
-   /**
-   mLines map<line, map< patternIndex, tclPosInfo>>
-   */
-   tlmLinePosInfo mLines;
-   // conversion from resLIne in Foundline and back
-   tlvLine mReslines;
-
-   static tlpLinePosInfo mDefLineInfo; // used for return of invalid value
+   enum teLineFlags {
+      lfVisible = 1, // if to be displayed
+      lfValid = 2,   // if at least once set
+      lfStyled = 4   // style runs are up to date
+   };
+   // style of the hits of one pattern
+   struct tstPatStyle {
+      unsigned char style;
+      bool bWholeLine;
+      bool bValid;      // set by setPatternStyle()
+   };
+   // hit to be merged; pattern noHit only creates the line
+   struct tstPending {
+      tiLine line;
+      tstHit hit;
+   };
+   typedef std::vector<tstHit> tlvHit;
+   typedef std::vector<tstPending> tlvPending;
+
+   /** index of the pattern in mvPatIds, added if not in */
+   unsigned getPatIndex(tPatId patternId);
+
+   /** ordering of the hits in a line */
+   bool hitLess(const tstHit& left, const tstHit& right) const;
+
+   /** merge pending hits and remove deleted ones */
+   void update() const;
+
+   /** the index of foundLine or size() if not in */
+   size_t findLine(tiLine foundLine) const;
+
+   /** rebuild the text buffer without the replaced texts */
+   void compactText() const;
+
+   /** rebuild the runs buffer without the replaced runs */
+   void compactRuns() const;
+
+   /** resolve the hits of line i into its style runs */
+   void buildStyleRuns(size_t i) const;
+
+   /** append the style runs of line i to runs */
+   void resolveStyleRuns(size_t i, std::vector<tstStyleRun>& runs) const;
+
+   /** the style runs of all lines have to be resolved again */
+   void invalidateStyles() const;
+
+   static const unsigned noHit = (unsigned)-1;
+
+   // the columns are merged on read access, therefore mutable
+   mutable tlvLine mvLines;                 // line in main window per result line
+   mutable std::vector<size_t> mvHitBegin;  // per line first hit, one more than lines
+   mutable tlvHit mvHits;
+   mutable std::vector<size_t> mvTextBegin; // per line offset into mText
+   mutable std::vector<unsigned> mvTextLength;
+   mutable std::vector<unsigned char> mvFlags;
+   mutable std::string mText;               // line texts of all lines
+   mutable size_t mTextGarbage;             // replaced text in mText
+   mutable std::vector<size_t> mvRunBegin;  // per line offset into mvRuns
+   mutable std::vector<unsigned> mvRunCount;
+   mutable std::vector<tstStyleRun> mvRuns; // style runs of all lines
+   mutable size_t mRunGarbage;              // replaced runs in mvRuns
+   mutable std::vector<int> mvStyleScratch; // style per character while resolving a line
+   mutable tlvPending mvPending;
+   mutable bool mbResort;                   // pattern order changed
+   mutable bool mbRemoved;                  // hits marked as removed
+   std::vector<tPatId> mvPatIds;            // pattern of the hits
+   std::vector<tstPatStyle> mvPatStyles;    // per entry of mvPatIds
+   unsigned mLastPat;                       // cache for getPatIndex()
 };
 
 #endif //TCLFINDRESULTDOC_H
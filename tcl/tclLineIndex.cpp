@@ -0,0 +1,138 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclLineIndex keeps the start position of every line of a document buffer
+*/
+#include "tclLineIndex.h"
+#include "tclByteScanner.h"
+#include <algorithm>
+
+tclLineIndex::tclLineIndex()
+   : mpDoc(0)
+   , mLength(0)
+{}
+
+void tclLineIndex::setDocument(const char* pDoc, tiLine length)
+{
+   mpDoc = pDoc;
+   mLength = length;
+   mlvLineStarts.clear();
+   mlvLineStarts.push_back(0);
+}
+
+void tclLineIndex::build(const char* pDoc, tiLine length)
+{
+   setDocument(pDoc, length);
+   // only the line end characters are looked at
+   static const unsigned char lineEnds[2] = { '\r', '\n' };
+   tclByteScanner scanner;
+   scanner.setBytes(lineEnds, 2);
+   const unsigned char* p = (const unsigned char*)pDoc;
+   const unsigned char* end = p + length;
+   for (const unsigned char* q = scanner.find(p, end); q < end; q = scanner.find(q + 1, end)) {
+      if (isLineEndAt(p, (tiLine)(q - p), length)) {
+         mlvLineStarts.push_back((tiLine)(q - p) + 1);
+      }
+   }
+}
+
+void tclLineIndex::assign(const char* pDoc, tiLine length, tlvPosition& lineStarts)
+{
+   mpDoc = pDoc;
+   mLength = length;
+   mlvLineStarts.clear();
+   mlvLineStarts.swap(lineStarts);
+   if (mlvLineStarts.size() == 0) {
+      mlvLineStarts.push_back(0);
+   }
+}
+
+void tclLineIndex::swap(tclLineIndex& other)
+{
+   std::swap(mpDoc, other.mpDoc);
+   std::swap(mLength, other.mLength);
+   mlvLineStarts.swap(other.mlvLineStarts);
+}
+
+void tclLineIndex::update(const char* pDoc, tiLine length, tiLine start, tiLine oldEnd)
+{
+   tiLine delta = length - mLength;
+   if (mlvLineStarts.size() == 0 || start < 0 || oldEnd < start || oldEnd > mLength) {
+      build(pDoc, length);
+      return;
+   }
+   mpDoc = pDoc;
+   mLength = length;
+   // a CR in front of the range and a LF behind it may have been joined or 
+   // separated, so their line starts are checked again too
+   tiLine newEnd = oldEnd + delta;
+   tlvPosition lineStarts;
+   const unsigned char* p = (const unsigned char*)pDoc;
+   for (tiLine i = (start > 0) ? start - 1 : 0; i <= newEnd && i < length; ++i) {
+      if (isLineEndAt(p, i, length)) {
+         lineStarts.push_back(i + 1);
+      }
+   }
+   tlvPosition::iterator iFirst = std::lower_bound(mlvLineStarts.begin() + 1, mlvLineStarts.end(), start);
+   tlvPosition::iterator iLast = std::upper_bound(iFirst, mlvLineStarts.end(), oldEnd + 1);
+   for (tlvPosition::iterator it = iLast; it != mlvLineStarts.end(); ++it) {
+      *it += delta;
+   }
+   iFirst = mlvLineStarts.erase(iFirst, iLast);
+   mlvLineStarts.insert(iFirst, lineStarts.begin(), lineStarts.end());
+}
+
+void tclLineIndex::clear()
+{
+   mpDoc = 0;
+   mLength = 0;
+   mlvLineStarts.clear();
+}
+
+tiLine tclLineIndex::lineFromPosition(tiLine pos) const
+{
+   tlvPosition::const_iterator it = std::upper_bound(mlvLineStarts.begin(), mlvLineStarts.end(), pos);
+   if (it == mlvLineStarts.begin()) {
+      return 0;
+   }
+   return (tiLine)(it - mlvLineStarts.begin()) - 1;
+}
+
+tiLine tclLineIndex::positionFromLine(tiLine line) const
+{
+   if (line < 0 || line >= getLineCount()) {
+      return -1;
+   }
+   return mlvLineStarts[line];
+}
+
+tiLine tclLineIndex::lineEndPosition(tiLine line) const
+{
+   if (line < 0 || line >= getLineCount()) {
+      return -1;
+   }
+   tiLine start = mlvLineStarts[line];
+   tiLine end = (line + 1 < getLineCount()) ? mlvLineStarts[line + 1] : mLength;
+   if (end > start && mpDoc[end - 1] == '\n') {
+      --end;
+   }
+   if (end > start && mpDoc[end - 1] == '\r') {
+      --end;
+   }
+   return end;
+}
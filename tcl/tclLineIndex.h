@@ -0,0 +1,108 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclLineIndex keeps the start position of every line of a document buffer
+so that line numbers can be calculated without asking scintilla.
+Line ends are CR LF, LF and CR as in scintilla.
+*/
+
+#ifndef TCLLINEINDEX_H
+#define TCLLINEINDEX_H
+
+#include <vector>
+#include "tclPosInfo.h"
+
+class tclLineIndex {
+public:
+   typedef std::vector<tiLine> tlvPosition;
+
+   tclLineIndex();
+
+   /**
+   * reset the index for the given buffer; afterwards only line 0 is known
+   */
+   void setDocument(const char* pDoc, tiLine length);
+
+   /** add the next line start while the caller scans the buffer itself */
+   void addLineStart(tiLine pos) {
+      mlvLineStarts.push_back(pos);
+   }
+
+   /** scan the whole buffer and collect all line starts */
+   void build(const char* pDoc, tiLine length);
+
+   /**
+   * take the line starts of the buffer collected elsewhere, e.g. read from
+   * a file; lineStarts is left empty
+   */
+   void assign(const char* pDoc, tiLine length, tlvPosition& lineStarts);
+
+   void swap(tclLineIndex& other);
+
+   const tlvPosition& getLineStarts() const {
+      return mlvLineStarts;
+   }
+
+   /**
+   * the text of the buffer between start and oldEnd has been replaced; 
+   * only the new text is scanned and the following line starts are moved.
+   * pDoc may differ from the former one, the content outside of the 
+   * replaced range has to be the same
+   */
+   void update(const char* pDoc, tiLine length, tiLine start, tiLine oldEnd);
+
+   /** true if a new line starts behind the character at pos */
+   static bool isLineEndAt(const unsigned char* p, tiLine pos, tiLine length) {
+      return (p[pos] == '\n') ||
+             (p[pos] == '\r' && (pos + 1 >= length || p[pos + 1] != '\n'));
+   }
+
+   void clear();
+
+   tiLine getLineCount() const {
+      return (tiLine)mlvLineStarts.size();
+   }
+
+   const char* getDocument() const {
+      return mpDoc;
+   }
+
+   /** the same text moved to pDoc, e.g. a copy of the buffer */
+   void moveDocument(const char* pDoc) {
+      mpDoc = pDoc;
+   }
+
+   tiLine getLength() const {
+      return mLength;
+   }
+
+   /** same as SCI_LINEFROMPOSITION */
+   tiLine lineFromPosition(tiLine pos) const;
+
+   /** same as SCI_POSITIONFROMLINE */
+   tiLine positionFromLine(tiLine line) const;
+
+   /** same as SCI_GETLINEENDPOSITION, the line end characters are excluded */
+   tiLine lineEndPosition(tiLine line) const;
+
+protected:
+   const char* mpDoc;
+   tiLine mLength;
+   tlvPosition mlvLineStarts;
+};
+#endif //TCLLINEINDEX_H
@@ -0,0 +1,175 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclLineIndexFile keeps the line index of a large file on disk beside it
+*/
+#include "tclLineIndexFile.h"
+#include "tclMappedFile.h"
+#include <fstream>
+#include <string>
+#include <string.h>
+#define MDBG_COMP "LiIdxF:"
+#include "myDebug.h"
+
+// magic, length, modification time, hash and count of lines
+#define LINEINDEXFILE_MAGIC "APLIDX01"
+#define LINEINDEXFILE_HEADER_SIZE (8 + 4 * 8)
+
+static void appendU64(std::string& s, uint64_t value)
+{
+   for (int i = 0; i < 8; ++i) {
+      s += (char)(value >> (8 * i));
+   }
+}
+
+static uint64_t readU64(const unsigned char* p)
+{
+   uint64_t value = 0;
+   for (int i = 7; i >= 0; --i) {
+      value = (value << 8) | p[i];
+   }
+   return value;
+}
+
+tclLineIndexFile::tclLineIndexFile(const generic_string& fileName, unsigned long long modified)
+   : mSidecarName(fileName + LINEINDEXFILE_EXTENSION)
+   , mModified(modified)
+{}
+
+uint64_t tclLineIndexFile::getHash(const char* pDoc, tiLine length)
+{
+   // FNV-1a of the length, the first and the last bytes
+   uint64_t hash = 14695981039346656037ULL;
+   for (int i = 0; i < 8; ++i) {
+      hash = (hash ^ (unsigned char)((uint64_t)length >> (8 * i))) * 1099511628211ULL;
+   }
+   const unsigned char* p = (const unsigned char*)pDoc;
+   const tiLine head = (length < LINEINDEXFILE_HASH_SIZE) ? length : LINEINDEXFILE_HASH_SIZE;
+   for (tiLine i = 0; i < head; ++i) {
+      hash = (hash ^ p[i]) * 1099511628211ULL;
+   }
+   const tiLine tail = (length - LINEINDEXFILE_HASH_SIZE > head) ? length - LINEINDEXFILE_HASH_SIZE : head;
+   for (tiLine i = tail; i < length; ++i) {
+      hash = (hash ^ p[i]) * 1099511628211ULL;
+   }
+   return hash;
+}
+
+uint64_t tclLineIndexFile::getContentHash(const char* pDoc, tiLine length)
+{
+   // FNV-1a of the length and eight bytes at once, the high bits folded
+   // down after each step
+   uint64_t hash = (14695981039346656037ULL ^ (uint64_t)length) * 1099511628211ULL;
+   tiLine i = 0;
+   for (; i + 8 <= length; i += 8) {
+      uint64_t word;
+      memcpy(&word, pDoc + i, sizeof(word));
+      hash = (hash ^ word) * 1099511628211ULL;
+      hash ^= hash >> 32;
+   }
+   for (; i < length; ++i) {
+      hash = (hash ^ (unsigned char)pDoc[i]) * 1099511628211ULL;
+   }
+   return hash;
+}
+
+tclLineIndexFile::teState tclLineIndexFile::load(const char* pDoc, tiLine length, tclLineIndex& index) const
+{
+   tclMappedFile sidecar;
+   if (!sidecar.open(mSidecarName)) {
+      return stateMissing;
+   }
+   const unsigned char* p = (const unsigned char*)sidecar.getData();
+   const unsigned char* end = p + sidecar.getLength();
+   if (sidecar.getLength() < LINEINDEXFILE_HEADER_SIZE || memcmp(p, LINEINDEXFILE_MAGIC, 8) != 0) {
+      DBG0("load() no line index file");
+      return stateMissing;
+   }
+   const uint64_t indexedLength = readU64(p + 8);
+   const uint64_t modified = readU64(p + 16);
+   const uint64_t hash = readU64(p + 24);
+   const uint64_t lineCount = readU64(p + 32);
+   p += LINEINDEXFILE_HEADER_SIZE;
+   // a file of the same length written again is split again
+   const bool bCurrent = (indexedLength == (uint64_t)length) && (modified == mModified);
+   if (indexedLength > (uint64_t)length || (indexedLength == (uint64_t)length && !bCurrent) ||
+       lineCount < 1 || lineCount - 1 > (uint64_t)(end - p) ||
+       hash != getHash(pDoc, (tiLine)indexedLength)) {
+      DBG0("load() line index of another file");
+      return stateMissing;
+   }
+   tclLineIndex::tlvPosition lineStarts;
+   lineStarts.reserve((size_t)lineCount);
+   lineStarts.push_back(0);
+   uint64_t pos = 0;
+   while (p < end) {
+      uint64_t delta = 0;
+      int shift = 0;
+      while (p < end && (*p & 0x80) != 0 && shift < 63) {
+         delta |= (uint64_t)(*p++ & 0x7F) << shift;
+         shift += 7;
+      }
+      if (p >= end || (*p & 0x80) != 0) {
+         return stateMissing;
+      }
+      delta |= (uint64_t)*p++ << shift;
+      pos += delta;
+      if (delta == 0 || pos > indexedLength) {
+         return stateMissing;
+      }
+      lineStarts.push_back((tiLine)pos);
+   }
+   if ((uint64_t)lineStarts.size() != lineCount) {
+      return stateMissing;
+   }
+   index.assign(pDoc, (tiLine)indexedLength, lineStarts);
+   if (bCurrent) {
+      return stateCurrent;
+   }
+   // only the appended text is split
+   DBG2("load() extend from %d to %d", (int)indexedLength, (int)length);
+   index.update(pDoc, length, (tiLine)indexedLength, (tiLine)indexedLength);
+   return stateExtended;
+}
+
+bool tclLineIndexFile::save(const tclLineIndex& index) const
+{
+   const tclLineIndex::tlvPosition& lineStarts = index.getLineStarts();
+   std::string data(LINEINDEXFILE_MAGIC);
+   data.reserve(LINEINDEXFILE_HEADER_SIZE + lineStarts.size() + lineStarts.size() / 8);
+   appendU64(data, (uint64_t)index.getLength());
+   appendU64(data, mModified);
+   appendU64(data, getHash(index.getDocument(), index.getLength()));
+   appendU64(data, (uint64_t)lineStarts.size());
+   for (size_t i = 1; i < lineStarts.size(); ++i) {
+      uint64_t delta = (uint64_t)(lineStarts[i] - lineStarts[i - 1]);
+      while (delta >= 0x80) {
+         data += (char)((delta & 0x7F) | 0x80);
+         delta >>= 7;
+      }
+      data += (char)delta;
+   }
+   std::ofstream file(mSidecarName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+   if (!file) {
+      // e.g. a folder without write access; the file is split next time again
+      DBG0("save() line index file not written");
+      return false;
+   }
+   file.write(data.data(), data.size());
+   return file.good();
+}
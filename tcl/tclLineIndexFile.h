@@ -0,0 +1,79 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclLineIndexFile keeps the line index of a large file on disk beside it,
+so analysing the file again doesn't need to split it into lines. The
+sidecar holds the distances between the line starts as variable length
+numbers, about one byte per line of a log. It belongs to the file of
+the same length and modification time; the first and the last bytes of
+the indexed text are hashed too. A file which has grown since keeps the
+index of its former end and only the new text is split.
+*/
+
+#ifndef TCLLINEINDEXFILE_H
+#define TCLLINEINDEXFILE_H
+
+#include <stdint.h>
+#include "platform.h"
+#include "tclLineIndex.h"
+
+// the sidecar is named like the file with this extension added
+#define LINEINDEXFILE_EXTENSION TEXT(".apidx")
+// smaller files are split faster than their sidecar is read
+#define LINEINDEXFILE_MIN_SIZE (64*1024*1024)
+// bytes hashed at the begin and the end of the indexed text
+#define LINEINDEXFILE_HASH_SIZE (64*1024)
+
+class tclLineIndexFile {
+public:
+   enum teState {
+      stateMissing = 0, // no sidecar or it belongs to another text
+      stateExtended,    // the file has grown, the new text was split
+      stateCurrent      // the sidecar matches the file
+   };
+
+   /** the sidecar of the file named fileName modified at modified */
+   tclLineIndexFile(const generic_string& fileName, unsigned long long modified);
+
+   const generic_string& getSidecarName() const {
+      return mSidecarName;
+   }
+
+   /**
+   * fill index for the text in pDoc from the sidecar. a missing or
+   * foreign sidecar leaves index untouched.
+   */
+   teState load(const char* pDoc, tiLine length, tclLineIndex& index) const;
+
+   /** write the sidecar of index; false if that was not possible */
+   bool save(const tclLineIndex& index) const;
+
+   /** hash of the begin and the end of a text and its length */
+   static uint64_t getHash(const char* pDoc, tiLine length);
+
+   /**
+   * hash of the whole text, e.g. for noticing a modification keeping the
+   * length of an editor buffer
+   */
+   static uint64_t getContentHash(const char* pDoc, tiLine length);
+
+protected:
+   generic_string mSidecarName;
+   unsigned long long mModified;
+};
+#endif //TCLLINEINDEXFILE_H
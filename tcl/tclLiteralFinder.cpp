@@ -0,0 +1,123 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclLiteralFinder looks for one literal in a text
+*/
+#include "tclLiteralFinder.h"
+#include "tclNgramIndex.h"
+#include <string.h>
+#include <stddef.h>
+#define MDBG_COMP "LitFnd:"
+#include "myDebug.h"
+
+static inline unsigned char toLowerAscii(unsigned char c) {
+   return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + ('a' - 'A')) : c;
+}
+
+static inline unsigned char toUpperAscii(unsigned char c) {
+   return (c >= 'a' && c <= 'z') ? (unsigned char)(c - ('a' - 'A')) : c;
+}
+
+tclLiteralFinder::tclLiteralFinder(const std::string& text, bool bMatchCase)
+   : mText(text)
+   , mbMatchCase(bMatchCase)
+   , mAnchor(0)
+{
+   if (!mbMatchCase) {
+      for (size_t i = 0; i < mText.size(); ++i) {
+         mText[i] = (char)toLowerAscii((unsigned char)mText[i]);
+      }
+   }
+   int best = 0x7fffffff;
+   for (size_t i = 0; i < mText.size(); ++i) {
+      int commonness = getCommonness((unsigned char)mText[i], mbMatchCase);
+      if (commonness < best) {
+         best = commonness;
+         mAnchor = i;
+      }
+   }
+   if (mText.size() > 0) {
+      unsigned char anchor[2];
+      anchor[0] = (unsigned char)mText[mAnchor];
+      anchor[1] = mbMatchCase ? anchor[0] : toUpperAscii(anchor[0]);
+      mAnchorScanner.setBytes(anchor, 2);
+   }
+   tclNgramIndex::getKeys(mText, mlvNgramKey);
+   DBG2("tclLiteralFinder() anchor %d of %d", (int)mAnchor, (int)mText.size());
+}
+
+int tclLiteralFinder::getCommonness(unsigned char c, bool bMatchCase)
+{
+   // rough order of a log: text, digits, upper case, punctuation
+   int commonness;
+   if (c == ' ') {
+      commonness = 100;
+   } else if (c >= 'a' && c <= 'z') {
+      commonness = strchr("etaoinsrhl", c) ? 60 : 50;
+   } else if (c >= '0' && c <= '9') {
+      commonness = 40;
+   } else if (c >= 'A' && c <= 'Z') {
+      commonness = 30;
+   } else if (c == ':' || c == '.' || c == ',' || c == '-' || c == '_' || c == '/' || c == '=') {
+      commonness = 25;
+   } else if (c >= 0x80) {
+      commonness = 15;
+   } else {
+      commonness = 10;
+   }
+   if (!bMatchCase && ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))) {
+      // two scans for both cases
+      commonness += 15;
+   }
+   return commonness;
+}
+
+bool tclLiteralFinder::isAt(const char* p) const
+{
+   if (mbMatchCase) {
+      return memcmp(p, mText.data(), mText.size()) == 0;
+   }
+   for (size_t i = 0; i < mText.size(); ++i) {
+      if (toLowerAscii((unsigned char)p[i]) != (unsigned char)mText[i]) {
+         return false;
+      }
+   }
+   return true;
+}
+
+const char* tclLiteralFinder::find(const char* begin, const char* end) const
+{
+   const size_t length = mText.size();
+   if (length == 0 || end - begin < (ptrdiff_t)length) {
+      return 0;
+   }
+   // the anchor can be found in [p, last]
+   const unsigned char* p = (const unsigned char*)begin + mAnchor;
+   const unsigned char* last = (const unsigned char*)end - length + mAnchor;
+   while (p <= last) {
+      const unsigned char* hit = mAnchorScanner.find(p, last + 1);
+      if (hit > last) {
+         return 0;
+      }
+      if (isAt((const char*)hit - mAnchor)) {
+         return (const char*)hit - mAnchor;
+      }
+      p = hit + 1;
+   }
+   return 0;
+}
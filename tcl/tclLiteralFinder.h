@@ -0,0 +1,68 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclLiteralFinder looks for one literal in a text. It scans with
+tclByteScanner for the rarest looking byte of the literal, in both cases
+without match case, and only compares the whole literal where that byte
+is found. Used to skip the text a regular expression can not match in,
+because it lacks a literal every match contains.
+*/
+
+#ifndef TCLLITERALFINDER_H
+#define TCLLITERALFINDER_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "tclByteScanner.h"
+
+class tclLiteralFinder {
+public:
+   /** without bMatchCase ASCII letters match in both cases */
+   tclLiteralFinder(const std::string& text, bool bMatchCase);
+
+   const std::string& getText() const {
+      return mText;
+   }
+
+   bool getIsMatchCase() const {
+      return mbMatchCase;
+   }
+
+   /** trigrams of the literal looked up in a tclNgramIndex; empty if it can't be */
+   const std::vector<uint32_t>& getNgramKeys() const {
+      return mlvNgramKey;
+   }
+
+   /** first occurrence of the literal in [begin, end) or 0 */
+   const char* find(const char* begin, const char* end) const;
+
+protected:
+   /** the literal is at p */
+   bool isAt(const char* p) const;
+
+   /** how often a byte is expected in a log, the lower the rarer */
+   static int getCommonness(unsigned char c, bool bMatchCase);
+
+   std::string mText;      // lower case without mbMatchCase
+   bool mbMatchCase;
+   size_t mAnchor;         // index of the byte searched for
+   tclByteScanner mAnchorScanner;
+   std::vector<uint32_t> mlvNgramKey;
+};
+#endif //TCLLITERALFINDER_H
@@ -0,0 +1,154 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclMappedFile maps a whole file read only into memory
+*/
+#include "tclMappedFile.h"
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#define MDBG_COMP "MapFile:"
+#include "myDebug.h"
+
+// an empty file can't be mapped, it is shown as this buffer
+static const char gEmptyFile[1] = { 0 };
+
+tclMappedFile::tclMappedFile()
+#ifdef _WIN32
+   : mhFile(INVALID_HANDLE_VALUE)
+   , mhMapping(0)
+#else
+   : mFd(-1)
+#endif
+   , mpData(0)
+   , mLength(0)
+   , mModified(0)
+{}
+
+tclMappedFile::~tclMappedFile()
+{
+   close();
+}
+
+#ifdef _WIN32
+bool tclMappedFile::open(const generic_string& fileName)
+{
+   close();
+   mhFile = ::CreateFile(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                         0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+   if (mhFile == INVALID_HANDLE_VALUE) {
+      DBG1("open() CreateFile failed %d", (int)::GetLastError());
+      return false;
+   }
+   LARGE_INTEGER size;
+   if (!::GetFileSizeEx(mhFile, &size) || (unsigned long long)size.QuadPart > (unsigned long long)INTPTR_MAX) {
+      // a 32 bit process can't address the file
+      DBG0("open() file too large");
+      close();
+      return false;
+   }
+   mFileName = fileName;
+   mLength = (tiLine)size.QuadPart;
+   FILETIME written;
+   if (::GetFileTime(mhFile, 0, 0, &written)) {
+      mModified = ((unsigned long long)written.dwHighDateTime << 32) | written.dwLowDateTime;
+   }
+   if (mLength == 0) {
+      mpData = gEmptyFile;
+      return true;
+   }
+   mhMapping = ::CreateFileMapping(mhFile, 0, PAGE_READONLY, 0, 0, 0);
+   if (mhMapping != 0) {
+      mpData = (const char*)::MapViewOfFile(mhMapping, FILE_MAP_READ, 0, 0, 0);
+   }
+   if (mpData == 0) {
+      DBG1("open() mapping failed %d", (int)::GetLastError());
+      close();
+      return false;
+   }
+   return true;
+}
+
+void tclMappedFile::close()
+{
+   if (mpData != 0 && mpData != gEmptyFile) {
+      ::UnmapViewOfFile(mpData);
+   }
+   if (mhMapping != 0) {
+      ::CloseHandle(mhMapping);
+      mhMapping = 0;
+   }
+   if (mhFile != INVALID_HANDLE_VALUE) {
+      ::CloseHandle(mhFile);
+      mhFile = INVALID_HANDLE_VALUE;
+   }
+   mpData = 0;
+   mLength = 0;
+   mModified = 0;
+   mFileName.clear();
+}
+#else // _WIN32
+bool tclMappedFile::open(const generic_string& fileName)
+{
+   close();
+   mFd = ::open(fileName.c_str(), O_RDONLY);
+   if (mFd < 0) {
+      return false;
+   }
+   struct stat st;
+   if (::fstat(mFd, &st) != 0 || !S_ISREG(st.st_mode) ||
+       (unsigned long long)st.st_size > (unsigned long long)INTPTR_MAX) {
+      close();
+      return false;
+   }
+   mFileName = fileName;
+   mLength = (tiLine)st.st_size;
+   mModified = (unsigned long long)st.st_mtime;
+   if (mLength == 0) {
+      mpData = gEmptyFile;
+      return true;
+   }
+   void* p = ::mmap(0, (size_t)mLength, PROT_READ, MAP_PRIVATE, mFd, 0);
+   if (p == MAP_FAILED) {
+      close();
+      return false;
+   }
+   // the file is searched from begin to end
+   ::madvise(p, (size_t)mLength, MADV_SEQUENTIAL);
+   mpData = (const char*)p;
+   return true;
+}
+
+void tclMappedFile::close()
+{
+   if (mpData != 0 && mpData != gEmptyFile) {
+      ::munmap((void*)mpData, (size_t)mLength);
+   }
+   if (mFd >= 0) {
+      ::close(mFd);
+      mFd = -1;
+   }
+   mpData = 0;
+   mLength = 0;
+   mModified = 0;
+   mFileName.clear();
+}
+#endif // _WIN32
@@ -0,0 +1,83 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclMappedFile maps a whole file read only into memory, so that it can be
+searched like a document buffer without reading it. The pages are loaded
+by the operating system when they are accessed.
+*/
+
+#ifndef TCLMAPPEDFILE_H
+#define TCLMAPPEDFILE_H
+
+#include "platform.h"
+#include "tclPosInfo.h"
+
+class tclMappedFile {
+public:
+   tclMappedFile();
+
+   ~tclMappedFile();
+
+   /**
+   * map the file; a former one is closed before.
+   * @return false if the file can't be opened or is too large for the
+   * address space
+   */
+   bool open(const generic_string& fileName);
+
+   void close();
+
+   bool isOpen() const {
+      return mpData != 0;
+   }
+
+   /** the content of the file; valid until close() */
+   const char* getData() const {
+      return mpData;
+   }
+
+   tiLine getLength() const {
+      return mLength;
+   }
+
+   const generic_string& getFileName() const {
+      return mFileName;
+   }
+
+   /** time of the last write as given by the file system, 0 if unknown */
+   unsigned long long getModified() const {
+      return mModified;
+   }
+
+private:
+   // a mapping can't be copied
+   tclMappedFile(const tclMappedFile&);
+   tclMappedFile& operator=(const tclMappedFile&);
+
+#ifdef _WIN32
+   HANDLE mhFile;
+   HANDLE mhMapping;
+#else
+   int mFd;
+#endif
+   const char* mpData;
+   tiLine mLength;
+   unsigned long long mModified;
+   generic_string mFileName;
+};
+#endif //TCLMAPPEDFILE_H
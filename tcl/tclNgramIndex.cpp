@@ -0,0 +1,255 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclNgramIndex tells which blocks of a large document can't contain a literal
+*/
+#include "tclNgramIndex.h"
+#include "tclLineIndexFile.h"
+#include "tclMappedFile.h"
+#include "tclByteScanner.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <thread>
+#include <string.h>
+#define MDBG_COMP "NgrIdx:"
+#include "myDebug.h"
+
+// magic, length, modification time, hash, count of blocks and key bits
+#define NGRAMINDEX_MAGIC "APNGR001"
+#define NGRAMINDEX_HEADER_SIZE (8 + 5 * 8)
+
+static void appendU64(std::string& s, uint64_t value)
+{
+   for (int i = 0; i < 8; ++i) {
+      s += (char)(value >> (8 * i));
+   }
+}
+
+static uint64_t readU64(const unsigned char* p)
+{
+   uint64_t value = 0;
+   for (int i = 7; i >= 0; --i) {
+      value = (value << 8) | p[i];
+   }
+   return value;
+}
+
+static inline unsigned char foldCase(unsigned char c)
+{
+   return (c >= 'A' && c <= 'Z') ? (unsigned char)(c - 'A' + 'a') : c;
+}
+
+tclNgramIndex::tclNgramIndex()
+   : mLength(0)
+   , mHash(0)
+   , mlvBlockStart(1, 0)
+{}
+
+void tclNgramIndex::clear()
+{
+   mLength = 0;
+   mHash = 0;
+   mlvBlockStart.assign(1, 0);
+   std::vector<uint64_t>().swap(mlvFilter);
+}
+
+void tclNgramIndex::swap(tclNgramIndex& other)
+{
+   std::swap(mLength, other.mLength);
+   std::swap(mHash, other.mHash);
+   mlvBlockStart.swap(other.mlvBlockStart);
+   mlvFilter.swap(other.mlvFilter);
+}
+
+unsigned tclNgramIndex::getBlockAt(tiLine pos) const
+{
+   std::vector<tiLine>::const_iterator it = std::upper_bound(mlvBlockStart.begin(), mlvBlockStart.end() - 1, pos);
+   return (it == mlvBlockStart.begin()) ? 0 : (unsigned)(it - mlvBlockStart.begin()) - 1;
+}
+
+void tclNgramIndex::build(const char* pDoc, tiLine length, unsigned maxThreads)
+{
+   clear();
+   if (pDoc == 0 || length < 1) {
+      return;
+   }
+   // blocks end behind the first line end after their size
+   const unsigned char* p = (const unsigned char*)pDoc;
+   const unsigned char lineEnds[] = {'\r', '\n'};
+   tclByteScanner lineEndScanner;
+   lineEndScanner.setBytes(lineEnds, 2);
+   tiLine pos = 0;
+   while (length - pos > NGRAMINDEX_BLOCK_SIZE) {
+      const unsigned char* q = lineEndScanner.find(p + pos + NGRAMINDEX_BLOCK_SIZE, p + length);
+      if (q < p + length - 1 && q[0] == '\r' && q[1] == '\n') {
+         ++q;
+      }
+      if (q >= p + length - 1) {
+         break;
+      }
+      pos = (tiLine)(q - p) + 1;
+      mlvBlockStart.push_back(pos);
+   }
+   mlvBlockStart.push_back(length);
+   const unsigned count = getBlockCount();
+   mlvFilter.assign((size_t)count * NGRAMINDEX_FILTER_WORDS, 0);
+   // the blocks are independent of each other
+   unsigned nThreads = (maxThreads != 0) ? maxThreads : std::thread::hardware_concurrency();
+   if (nThreads == 0) {
+      nThreads = 1;
+   }
+   if (nThreads > count) {
+      nThreads = count;
+   }
+   std::atomic<unsigned> nextBlock(0);
+   std::vector<std::thread> workers;
+   for (unsigned t = 1; t < nThreads; ++t) {
+      workers.push_back(std::thread([this, p, count, &nextBlock]() {
+         for (unsigned b = nextBlock++; b < count; b = nextBlock++) {
+            buildBlock(p, b);
+         }
+      }));
+   }
+   for (unsigned b = nextBlock++; b < count; b = nextBlock++) {
+      buildBlock(p, b);
+   }
+   for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it) {
+      it->join();
+   }
+   mLength = length;
+   mHash = tclLineIndexFile::getHash(pDoc, length);
+   DBG2("build() %d bytes in %d blocks", (int)length, (int)count);
+}
+
+void tclNgramIndex::buildBlock(const unsigned char* pDoc, unsigned block)
+{
+   uint64_t* filter = &mlvFilter[(size_t)block * NGRAMINDEX_FILTER_WORDS];
+   const unsigned char* p = pDoc + mlvBlockStart[block];
+   const unsigned char* end = pDoc + mlvBlockStart[block + 1];
+   uint32_t window = 0;
+   unsigned count = 0;  // bytes in window since the last line end
+   for (; p < end; ++p) {
+      const unsigned char c = *p;
+      if (c == '\r' || c == '\n') {
+         // literals with line ends are not looked up
+         count = 0;
+         continue;
+      }
+      window = (window << 8) | foldCase(c);
+      if (count < 2) {
+         ++count;
+         continue;
+      }
+      const uint32_t key = getKey(window);
+      filter[key >> 6] |= (uint64_t)1 << (key & 63);
+   }
+}
+
+void tclNgramIndex::getKeys(const std::string& text, tlvKey& keys)
+{
+   keys.clear();
+   if (text.size() < 3 || text.find_first_of("\r\n") != std::string::npos) {
+      return;
+   }
+   uint32_t window = 0;
+   for (size_t i = 0; i < text.size(); ++i) {
+      window = (window << 8) | foldCase((unsigned char)text[i]);
+      if (i >= 2) {
+         keys.push_back(getKey(window));
+      }
+   }
+   std::sort(keys.begin(), keys.end());
+   keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+bool tclNgramIndex::load(const generic_string& fileName, unsigned long long modified, const char* pDoc, tiLine length)
+{
+   tclMappedFile sidecar;
+   if (!sidecar.open(fileName + NGRAMINDEX_EXTENSION)) {
+      return false;
+   }
+   const unsigned char* p = (const unsigned char*)sidecar.getData();
+   const size_t size = (size_t)sidecar.getLength();
+   if (size < NGRAMINDEX_HEADER_SIZE || memcmp(p, NGRAMINDEX_MAGIC, 8) != 0) {
+      DBG0("load() no n-gram index file");
+      return false;
+   }
+   const uint64_t hash = readU64(p + 24);
+   const uint64_t count = readU64(p + 32);
+   // a grown or rewritten file is indexed again as a whole
+   if (readU64(p + 8) != (uint64_t)length || readU64(p + 16) != modified ||
+       readU64(p + 40) != NGRAMINDEX_KEY_BITS || count == 0 || count > (uint64_t)length ||
+       size != NGRAMINDEX_HEADER_SIZE + (count + 1) * 8 + count * NGRAMINDEX_FILTER_WORDS * 8 ||
+       hash != tclLineIndexFile::getHash(pDoc, length)) {
+      DBG0("load() n-gram index of another file");
+      return false;
+   }
+   p += NGRAMINDEX_HEADER_SIZE;
+   std::vector<tiLine> blockStart((size_t)count + 1);
+   for (size_t b = 0; b <= count; ++b, p += 8) {
+      blockStart[b] = (tiLine)readU64(p);
+      if ((b == 0) ? blockStart[b] != 0 : blockStart[b] <= blockStart[b - 1]) {
+         return false;
+      }
+   }
+   if (blockStart.back() != length) {
+      return false;
+   }
+   mlvFilter.resize((size_t)count * NGRAMINDEX_FILTER_WORDS);
+   for (std::vector<uint64_t>::iterator it = mlvFilter.begin(); it != mlvFilter.end(); ++it, p += 8) {
+      *it = readU64(p);
+   }
+   mlvBlockStart.swap(blockStart);
+   mLength = length;
+   mHash = hash;
+   return true;
+}
+
+bool tclNgramIndex::save(const generic_string& fileName, unsigned long long modified) const
+{
+   if (mLength == 0) {
+      return false;
+   }
+   std::ofstream file((fileName + NGRAMINDEX_EXTENSION).c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+   if (!file) {
+      // e.g. a folder without write access; the file is indexed next time again
+      DBG0("save() n-gram index file not written");
+      return false;
+   }
+   std::string data(NGRAMINDEX_MAGIC);
+   appendU64(data, (uint64_t)mLength);
+   appendU64(data, modified);
+   appendU64(data, mHash);
+   appendU64(data, (uint64_t)getBlockCount());
+   appendU64(data, NGRAMINDEX_KEY_BITS);
+   for (std::vector<tiLine>::const_iterator it = mlvBlockStart.begin(); it != mlvBlockStart.end(); ++it) {
+      appendU64(data, (uint64_t)*it);
+   }
+   file.write(data.data(), data.size());
+   // the filters are written per block
+   for (unsigned b = 0; b < getBlockCount() && file.good(); ++b) {
+      data.clear();
+      const uint64_t* filter = &mlvFilter[(size_t)b * NGRAMINDEX_FILTER_WORDS];
+      for (unsigned w = 0; w < NGRAMINDEX_FILTER_WORDS; ++w) {
+         appendU64(data, filter[w]);
+      }
+      file.write(data.data(), data.size());
+   }
+   return file.good();
+}
@@ -0,0 +1,127 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclNgramIndex tells which blocks of a large document can't contain a
+literal, so searching the same document again skips them. The document
+is cut into blocks of about 1 MB at line ends; each block has a bloom
+filter of the trigrams in it with ASCII letters in lower case. A literal
+of at least 3 characters without line ends can only be in a block whose
+filter has all its trigrams.
+*/
+
+#ifndef TCLNGRAMINDEX_H
+#define TCLNGRAMINDEX_H
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "platform.h"
+#include "tclPosInfo.h"
+
+// the sidecar of a file on disk is named like it with this extension added
+#define NGRAMINDEX_EXTENSION TEXT(".apngr")
+// smaller documents are scanned faster than the index is built
+#define NGRAMINDEX_MIN_SIZE (64*1024*1024)
+// size of a block, it ends at the next line end behind
+#define NGRAMINDEX_BLOCK_SIZE (1024*1024)
+// the filter of a block has 2^NGRAMINDEX_KEY_BITS bits
+#define NGRAMINDEX_KEY_BITS 17
+
+class tclNgramIndex {
+public:
+   typedef std::vector<uint32_t> tlvKey;
+
+   enum {
+      NGRAMINDEX_FILTER_WORDS = (1 << NGRAMINDEX_KEY_BITS) / 64
+   };
+
+   tclNgramIndex();
+
+   void clear();
+
+   void swap(tclNgramIndex& other);
+
+   /** length of the indexed document, 0 without index */
+   tiLine getLength() const {
+      return mLength;
+   }
+
+   /** hash of the begin and the end of the indexed document */
+   uint64_t getHash() const {
+      return mHash;
+   }
+
+   unsigned getBlockCount() const {
+      return (unsigned)mlvBlockStart.size() - 1;
+   }
+
+   tiLine getBlockStart(unsigned block) const {
+      return mlvBlockStart[block];
+   }
+
+   tiLine getBlockEnd(unsigned block) const {
+      return mlvBlockStart[block + 1];
+   }
+
+   /** block containing pos */
+   unsigned getBlockAt(tiLine pos) const;
+
+   /** index the document; the blocks are filled by up to maxThreads threads, 0 = one per core */
+   void build(const char* pDoc, tiLine length, unsigned maxThreads = 0);
+
+   /**
+   * the filter bits of the trigrams of text; empty if the text can't be
+   * looked up because it is too short or contains a line end
+   */
+   static void getKeys(const std::string& text, tlvKey& keys);
+
+   /** false if block certainly doesn't contain the text of keys */
+   bool mayContain(unsigned block, const tlvKey& keys) const {
+      const uint64_t* filter = &mlvFilter[(size_t)block * NGRAMINDEX_FILTER_WORDS];
+      for (tlvKey::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+         if ((filter[*it >> 6] & ((uint64_t)1 << (*it & 63))) == 0) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   /**
+   * read the index of the file from its sidecar; false if there is none
+   * for the document, which is the content of the file from pDoc on
+   */
+   bool load(const generic_string& fileName, unsigned long long modified, const char* pDoc, tiLine length);
+
+   /** write the sidecar of the file; false if that was not possible */
+   bool save(const generic_string& fileName, unsigned long long modified) const;
+
+protected:
+   /** fill the filter of one block */
+   void buildBlock(const unsigned char* pDoc, unsigned block);
+
+   /** filter bit of the trigram in the lower 3 bytes of window */
+   static uint32_t getKey(uint32_t window) {
+      return ((window & 0xFFFFFF) * 2654435761u) >> (32 - NGRAMINDEX_KEY_BITS);
+   }
+
+   tiLine mLength;
+   uint64_t mHash;                     // of the indexed document, see tclLineIndexFile
+   std::vector<tiLine> mlvBlockStart;  // per block and the length at the end
+   std::vector<uint64_t> mlvFilter;    // NGRAMINDEX_FILTER_WORDS per block
+};
+#endif //TCLNGRAMINDEX_H
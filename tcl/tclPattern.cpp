@@ -21,7 +21,7 @@ tclPattern implements information stored to execute one search on
 
 //#include "stdafx.h"
 #include "tclPattern.h"
-#include <windows.h>
+#include "tclCompiledPattern.h"
 #include <stdio.h>
 
 const TCHAR*  tclPattern::transSearchType[max_searchType] = {
@@ -60,6 +60,18 @@ tclPattern::tclPattern()
 
 tclPattern::~tclPattern(){}
 
+const tclCompiledPattern& tclPattern::getCompiled(unsigned cp) const {
+   if (!mpCompiled || !mpCompiled->isFor(*this, cp)) {
+      mpCompiled = std::make_shared<tclCompiledPattern>(*this, cp);
+   }
+   return *mpCompiled;
+}
+
+std::shared_ptr<const tclCompiledPattern> tclPattern::getCompiledShared(unsigned cp) const {
+   getCompiled(cp);
+   return mpCompiled;
+}
+
 const generic_string& tclPattern::getSearchText() const{
    return mSearchText;
 }
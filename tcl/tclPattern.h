@@ -21,13 +21,15 @@ tclPattern stores the infos to execute one search
 
 #ifndef TCLPATTERN_H
 #define TCLPATTERN_H
-#include <windows.h>
 #include <string>
-#include "Common.h"
+#include <memory>
+#include "platform.h"
 #include "tclColor.h"
 
 #define MAX_ORDER_NUM_CHARS 20
 
+class tclCompiledPattern;
+
 /**
 * A Pattern is a text and additionaly stores the configuration information for it.
 * The text has two visualisation forms 1. the text as shown in find config. 
@@ -79,6 +81,7 @@ public:
       mSelectionType = right.mSelectionType;
       mComment = right.mComment;
       mGroup = right.mGroup;
+      mpCompiled = right.mpCompiled;
    }
 
    virtual ~tclPattern();
@@ -104,6 +107,10 @@ public:
       mSelectionType = right.mSelectionType;
       mComment = right.mComment;
       mGroup = right.mGroup;
+      // an own compiled text stays as long as it fits to the new fields
+      if (right.mpCompiled) {
+         mpCompiled = right.mpCompiled;
+      }
       return *this;
    }
 
@@ -175,6 +182,15 @@ public:
 
    generic_string getReplaceText() const;
 
+   /**
+   * search text prepared for documents in code page cp; built on first
+   * use and kept until a search relevant field or the code page changes
+   */
+   const tclCompiledPattern& getCompiled(unsigned cp) const;
+
+   /** the same as getCompiled() for keeping it while the pattern changes */
+   std::shared_ptr<const tclCompiledPattern> getCompiledShared(unsigned cp) const;
+
    /** used for the search algorithm */
    generic_string getSearchTextConverted() const {
       if(mSearchType==escaped) {
@@ -382,5 +398,7 @@ protected:
    generic_string mComment;
    /** defines the group to which this pattern belongs */
    generic_string mGroup;
+   /** search text prepared for the last code page searched in */
+   mutable std::shared_ptr<tclCompiledPattern> mpCompiled;
 };
 #endif //TCLPATTERN_H
@@ -24,6 +24,7 @@ class tclPatternList contains a vector of tclPatterns
 #include "tclPattern.h"
 #define MDBG_COMP "PatLst:" 
 #include "myDebug.h"
+#include <algorithm>
 
 // this value is used for the initial, first entry
 // it is intentionally high as inserting in front cause ID/2 values before
@@ -32,6 +33,23 @@ class tclPatternList contains a vector of tclPatterns
 
 tclPattern tclPatternList::mDefault = tclPattern();
 
+tclPatternList::tclPatternList()
+   : mbIndexValid(true)
+{}
+
+void tclPatternList::updateIndex() const {
+   if(mbIndexValid) {
+      return;
+   }
+   mvPatIds.clear();
+   mvPatIds.reserve(mlmPattern.size());
+   tlmPatternList::const_iterator it = mlmPattern.begin();
+   for (; it != mlmPattern.end(); ++it) {
+      mvPatIds.push_back(it->first);
+   }
+   mbIndexValid = true;
+}
+
 const tclPattern& tclPatternList::getPattern(tPatId i ) const {
    tlmPatternList::const_iterator it = mlmPattern.find(i);
    if(it!=mlmPattern.end()) {
@@ -42,24 +60,19 @@ const tclPattern& tclPatternList::getPattern(tPatId i ) const {
 }
 
 tPatId tclPatternList::getPatternId(unsigned index) const {
-   tlmPatternList::const_iterator it = mlmPattern.begin();
    if(size() ==0) {
       return 0;
    }
-   unsigned i = 0;
-   while (i < index) {
-      if(it == mlmPattern.end()) {
-         return tPatId(unsigned(-1));
-      }
-      ++i;
-      ++it;
+   updateIndex();
+   if(index >= mvPatIds.size()) {
+      return tPatId(unsigned(-1));
    }
-   return it->first;
+   return mvPatIds[index];
 }
 generic_string tclPatternList::getPatternIdentification(tPatId id) const {
    const tclPattern& p = getPattern(id);
    generic_string s;
-   TCHAR index[5];
+   TCHAR index[24];
    unsigned idx = getPatternIndex(id);
    generic_itoa(idx + 1, index, 10);  // show line 1 based
    s = PAT_LINE_TXT;
@@ -68,17 +81,12 @@ generic_string tclPatternList::getPatternIdentification(tPatId id) const {
 }
 
 unsigned tclPatternList::getPatternIndex(tPatId id) const {
-   tlmPatternList::const_iterator it = mlmPattern.find(id);
-   unsigned i = 0;
-   if(it == mlmPattern.end()) {
-      i = unsigned(-1);
-   } else {
-      while(it != mlmPattern.begin()) {
-         --it;
-         ++i;
-      }
+   updateIndex();
+   std::vector<tPatId>::const_iterator it = std::lower_bound(mvPatIds.begin(), mvPatIds.end(), id);
+   if(it == mvPatIds.end() || *it != id) {
+      return unsigned(-1);
    }
-   return i;
+   return (unsigned)(it - mvPatIds.begin());
 }
 
 tPatId tclPatternList::push_back(const tclPattern& pattern) {
@@ -89,6 +97,7 @@ tPatId tclPatternList::push_back(const tclPattern& pattern) {
    }
    mlsPatIds.insert(id);
    mlmPattern[id] = pattern;
+   invalidateIndex();
    DBG1("push_back() adding id %f.", id);
    return id;
 }
@@ -119,6 +128,7 @@ tPatId tclPatternList::insert(tPatId before, const tclPattern& pattern) {
    }
    mlsPatIds.insert(newId);
    mlmPattern[newId] = pattern;
+   invalidateIndex();
    return newId;
 }
 
@@ -146,6 +156,7 @@ tPatId tclPatternList::insertAfter(tPatId after, const tclPattern& pattern) {
    }
    mlsPatIds.insert(newId);
    mlmPattern[newId] = pattern;
+   invalidateIndex();
    return newId;
 }
 
@@ -155,6 +166,7 @@ void tclPatternList::moveResult(tPatId oldPattId, tPatId newPattId)
    tlmPatternList::iterator iOld = mlmPattern.find(oldPattId);
    if(iOld != mlmPattern.end()) {
       mlmPattern[newPattId] = iOld->second;
+      invalidateIndex();
       tclPatternList::remove(oldPattId);
    }
 }
@@ -162,6 +174,7 @@ void tclPatternList::moveResult(tPatId oldPattId, tPatId newPattId)
 void tclPatternList::clear(){
    mlsPatIds.clear();
    mlmPattern.clear();
+   invalidateIndex();
 }
 
 bool tclPatternList::setPattern(tPatId i, const tclPattern& pattern){
@@ -174,6 +187,7 @@ bool tclPatternList::setPattern(tPatId i, const tclPattern& pattern){
       DBG1("setPattern() id %f was not in list! adding...", i);
       mlmPattern[i] = pattern;
       mlsPatIds.insert(i);
+      invalidateIndex();
       return false;
    }
 }
@@ -191,6 +205,7 @@ unsigned tclPatternList::getCommentWidth() const {
 void tclPatternList::remove(tPatId i){
    // removal only in pattern list Ids will remain
    mlmPattern.erase(i); 
+   invalidateIndex();
    if(mlmPattern.size() == 0) {
       mlsPatIds.clear();
    }
@@ -209,6 +224,7 @@ void tclPatternList::sort(tFuncStr func, bool bAscending){
    // after having index we clean the original instance to build up in right order
    mlmPattern.clear();
    mlsPatIds.clear();
+   invalidateIndex();
    if (bAscending) {
       std::multimap < generic_string, tPatId>::const_iterator it = index.begin();
       for (; it != index.end(); ++it) {
@@ -235,6 +251,7 @@ void tclPatternList::sort(tFuncInt func, bool bAscending){
    // after having index we clean the original instance to build up in right order
    mlmPattern.clear();
    mlsPatIds.clear();
+   invalidateIndex();
    if (bAscending) {
       std::multimap < int, tPatId>::const_iterator it = index.begin();
       for (; it != index.end(); ++it) {
@@ -260,6 +277,7 @@ void tclPatternList::sortByOrderNum(bool bAscending) {
    // after having index we clean the original instance to build up in right order
    mlmPattern.clear();
    mlsPatIds.clear();
+   invalidateIndex();
    if (bAscending) {
       std::map < generic_string, tPatId>::const_iterator it = index.begin();
       for (; it != index.end(); ++it) {
@@ -22,9 +22,10 @@ class tclPatternList contains a vector of tclPatterns
 #ifndef TCLPATTERNLIST_H
 #define TCLPATTERNLIST_H
 #include "tclPattern.h"
-#include "MyPlugin.h"
+#include "tclPosInfo.h"
 #include <map>
 #include <set>
+#include <vector>
 
 typedef std::map < tPatId , tclPattern > tlmPatternList;
 typedef std::set < tPatId > tlsPatId;
@@ -69,15 +70,17 @@ public:
    class const_iterator;
    class iterator;
 
+   tclPatternList();
+
    /**
     * The direct access to the members works directly on the vector function operator[] 
     */
    virtual const tclPattern& getPattern(tPatId i ) const ;
    
-   /** index conversion to id */
+   /** index conversion to id; constant time with the lazily built index */
    virtual tPatId getPatternId(unsigned index) const;
 
-   /** id conversion to index */
+   /** id conversion to index; binary search in the lazily built index */
    virtual unsigned getPatternIndex(tPatId id) const;
    virtual generic_string getPatternIdentification(tPatId id) const;
 
@@ -248,6 +251,20 @@ protected:
    /** stores all ids already been used */
    tlsPatId mlsPatIds;
 
+   /** 
+   * rebuild the index if the patterns changed since the last lookup 
+   */
+   void updateIndex() const;
+
+   /** has to be called whenever an id is added to or removed from mlmPattern */
+   void invalidateIndex() {
+      mbIndexValid = false;
+   }
+
+   /** ids of mlmPattern in ascending order; the position is the index */
+   mutable std::vector<tPatId> mvPatIds;
+   mutable bool mbIndexValid;
+
    static tclPattern mDefault;
 
 };
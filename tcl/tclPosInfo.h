@@ -21,7 +21,10 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #ifndef TCLPOSINFO_H
 #define TCLPOSINFO_H
 
+#include <stdint.h>
+
 typedef intptr_t tiLine;
+typedef double tPatId; // id of the pattern applied
 
 /**
  * Position info is the pure Information where a pattern has been found. 
@@ -33,7 +36,7 @@ typedef intptr_t tiLine;
 class tclPosInfo {
 public:
 
-   tclPosInfo(int thisStart, int thisEnd, int thisLine/*, const std::string& thisText*/):
+   tclPosInfo(tiLine thisStart, tiLine thisEnd, tiLine thisLine/*, const std::string& thisText*/):
       start(thisStart), end(thisEnd), line(thisLine)/*, text(thisText) */{}
 
    bool operator<(const tclPosInfo& right) const {
@@ -0,0 +1,259 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclRegex is a regular expression compiled with boost as done by notepad++
+*/
+#include "tclRegex.h"
+#include <iterator>
+#include <stddef.h>
+#include <boost/regex.hpp>
+#include "Scintilla.h"
+#define MDBG_COMP "Regex:"
+#include "myDebug.h"
+
+namespace {
+
+   /**
+   * the characters of a utf-8 text as wchar_t like the UTF8DocumentIterator
+   * of notepad++; a 16 bit wchar_t gets both surrogates of a character out
+   * of the supplementary planes. an invalid byte is taken as a character
+   * of its own with the value of the byte.
+   */
+   class tclUtf8Iterator {
+   public:
+      typedef std::bidirectional_iterator_tag iterator_category;
+      typedef wchar_t value_type;
+      typedef ptrdiff_t difference_type;
+      typedef const wchar_t* pointer;
+      typedef wchar_t reference;
+
+      tclUtf8Iterator()
+         : mpBegin(0), mpEnd(0), mpPos(0), mChar(0), mLength(0), mbLow(false) {}
+
+      /** at pos of [begin, end), which may be read on both sides of the range searched */
+      tclUtf8Iterator(const char* begin, const char* end, const char* pos)
+         : mpBegin((const unsigned char*)begin)
+         , mpEnd((const unsigned char*)end)
+         , mpPos((const unsigned char*)pos)
+         , mbLow(false)
+      {
+         decode();
+      }
+
+      wchar_t operator*() const {
+         if (sizeof(wchar_t) == 2 && mChar > 0xFFFF) {
+            return (wchar_t)(mbLow ? 0xDC00 + ((mChar - 0x10000) & 0x3FF) : 0xD800 + ((mChar - 0x10000) >> 10));
+         }
+         return (wchar_t)mChar;
+      }
+
+      tclUtf8Iterator& operator++() {
+         if (sizeof(wchar_t) == 2 && mChar > 0xFFFF && !mbLow) {
+            mbLow = true;
+         } else {
+            mpPos += mLength;
+            mbLow = false;
+            decode();
+         }
+         return *this;
+      }
+
+      tclUtf8Iterator operator++(int) {
+         tclUtf8Iterator former(*this);
+         ++*this;
+         return former;
+      }
+
+      tclUtf8Iterator& operator--() {
+         if (mbLow) {
+            mbLow = false;
+            return *this;
+         }
+         const unsigned char* p = mpPos - 1;
+         // the lead byte in front which reaches up to here
+         for (int back = 1; back <= 4 && mpPos - back >= mpBegin; ++back) {
+            const unsigned char* q = mpPos - back;
+            if ((*q & 0xC0) != 0x80) {
+               if (getLength(q) == back) {
+                  p = q;
+               }
+               break;
+            }
+         }
+         mpPos = p;
+         decode();
+         mbLow = (sizeof(wchar_t) == 2 && mChar > 0xFFFF);
+         return *this;
+      }
+
+      tclUtf8Iterator operator--(int) {
+         tclUtf8Iterator former(*this);
+         --*this;
+         return former;
+      }
+
+      bool operator==(const tclUtf8Iterator& right) const {
+         return mpPos == right.mpPos && mbLow == right.mbLow;
+      }
+
+      bool operator!=(const tclUtf8Iterator& right) const {
+         return !operator==(right);
+      }
+
+      /** byte position in the text */
+      const char* getPos() const {
+         return (const char*)mpPos;
+      }
+
+      /** bytes of the valid character at p, 1 for an invalid byte */
+      int getLength(const unsigned char* p) const {
+         const unsigned char b = *p;
+         int length;
+         unsigned char low = 0x80;
+         unsigned char high = 0xBF;
+         if (b < 0xC2 || b > 0xF4) {
+            return 1;
+         } else if (b < 0xE0) {
+            length = 2;
+         } else if (b < 0xF0) {
+            length = 3;
+            // no overlong forms and no surrogates
+            low = (b == 0xE0) ? 0xA0 : 0x80;
+            high = (b == 0xED) ? 0x9F : 0xBF;
+         } else {
+            length = 4;
+            low = (b == 0xF0) ? 0x90 : 0x80;
+            high = (b == 0xF4) ? 0x8F : 0xBF;
+         }
+         if (mpEnd - p < length || p[1] < low || p[1] > high) {
+            return 1;
+         }
+         for (int i = 2; i < length; ++i) {
+            if ((p[i] & 0xC0) != 0x80) {
+               return 1;
+            }
+         }
+         return length;
+      }
+
+   protected:
+      void decode() {
+         if (mpPos >= mpEnd) {
+            mChar = 0;
+            mLength = 1;
+            return;
+         }
+         mLength = getLength(mpPos);
+         switch (mLength) {
+         case 2:
+            mChar = ((mpPos[0] & 0x1F) << 6) | (mpPos[1] & 0x3F);
+            break;
+         case 3:
+            mChar = ((mpPos[0] & 0x0F) << 12) | ((mpPos[1] & 0x3F) << 6) | (mpPos[2] & 0x3F);
+            break;
+         case 4:
+            mChar = ((mpPos[0] & 0x07) << 18) | ((mpPos[1] & 0x3F) << 12) | ((mpPos[2] & 0x3F) << 6) | (mpPos[3] & 0x3F);
+            break;
+         default:
+            mChar = mpPos[0];
+            break;
+         }
+      }
+
+      const unsigned char* mpBegin;
+      const unsigned char* mpEnd;
+      const unsigned char* mpPos;
+      unsigned mChar;
+      int mLength;
+      bool mbLow;   // at the second surrogate of mChar
+   };
+
+}
+
+struct tclRegex::tstCompiled {
+   boost::wregex wide;  // for utf-8
+   boost::regex bytes;  // for all other code pages
+};
+
+tclRegex::tclRegex(const std::string& text, unsigned codePage, bool bMatchCase, bool bDotMatchesNl)
+   : mpCompiled(new tstCompiled)
+   , mbUtf8(codePage == SC_CP_UTF8)
+   , mbDotMatchesNl(bDotMatchesNl)
+{
+   boost::regex_constants::syntax_option_type flags = boost::regex_constants::ECMAScript;
+   if (!bMatchCase) {
+      flags |= boost::regex_constants::icase;
+   }
+   // boost::regex_error is a std::runtime_error
+   if (mbUtf8) {
+      const char* pText = text.c_str();
+      tclUtf8Iterator begin(pText, pText + text.size(), pText);
+      tclUtf8Iterator end(pText, pText + text.size(), pText + text.size());
+      mpCompiled->wide.assign(std::wstring(begin, end), flags);
+   } else {
+      mpCompiled->bytes.assign(text, flags);
+   }
+}
+
+tclRegex::~tclRegex()
+{}
+
+bool tclRegex::find(const char* pDoc, tiLine docLength, tiLine from, tiLine to, tiLine& matchStart, tiLine& matchEnd) const
+{
+   if (from > to) {
+      return false;
+   }
+   boost::match_flag_type flags = boost::match_default;
+   if (!mbDotMatchesNl) {
+      flags |= boost::match_not_dot_newline;
+   }
+   if (from > 0) {
+      flags |= boost::match_prev_avail;
+   }
+   if (to < docLength) {
+      // \z belongs to the end of the document only
+      flags |= boost::match_not_eob;
+   }
+   if (mbUtf8) {
+      tclUtf8Iterator begin(pDoc, pDoc + docLength, pDoc + from);
+      tclUtf8Iterator end(pDoc, pDoc + docLength, pDoc + to);
+      boost::match_results<tclUtf8Iterator> match;
+      if (!boost::regex_search(begin, end, match, mpCompiled->wide, flags)) {
+         return false;
+      }
+      matchStart = (tiLine)(match[0].first.getPos() - pDoc);
+      matchEnd = (tiLine)(match[0].second.getPos() - pDoc);
+   } else {
+      boost::cmatch match;
+      if (!boost::regex_search(pDoc + from, pDoc + to, match, mpCompiled->bytes, flags)) {
+         return false;
+      }
+      matchStart = (tiLine)(match[0].first - pDoc);
+      matchEnd = (tiLine)(match[0].second - pDoc);
+   }
+   return true;
+}
+
+tiLine tclRegex::getNextChar(const char* pDoc, tiLine docLength, tiLine pos) const
+{
+   if (!mbUtf8 || pos >= docLength) {
+      return pos + 1;
+   }
+   tclUtf8Iterator it(pDoc, pDoc + docLength, pDoc + pos);
+   return pos + it.getLength((const unsigned char*)pDoc + pos);
+}
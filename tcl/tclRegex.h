@@ -0,0 +1,64 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclRegex is a regular expression compiled with boost the same way as
+notepad++ does for SCI_SEARCHINTARGET with SCFIND_REGEXP: perl syntax,
+the case folded without match case and . not matching line ends without
+SCFIND_REGEXP_DOTMATCHESNL. A utf-8 document is matched per character,
+any other one per byte. The matcher of boost keeps its state on the heap,
+so a long line can't overflow the stack; an expression too complex for a
+text throws instead.
+*/
+
+#ifndef TCLREGEX_H
+#define TCLREGEX_H
+
+#include <string>
+#include <memory>
+#include "tclPosInfo.h"
+
+class tclRegex {
+public:
+   /**
+   * compile text given in the code page of the document. throws
+   * std::runtime_error with the message of boost for an invalid one.
+   */
+   tclRegex(const std::string& text, unsigned codePage, bool bMatchCase, bool bDotMatchesNl);
+   ~tclRegex();
+
+   /**
+   * first match starting in [from, to) of the document pDoc of docLength
+   * bytes. the characters in front of from are seen by ^, \b and look
+   * behinds; to is expected at a line end, so $ matches there. throws
+   * std::runtime_error if the expression gets too complex for the text.
+   */
+   bool find(const char* pDoc, tiLine docLength, tiLine from, tiLine to, tiLine& matchStart, tiLine& matchEnd) const;
+
+   /** start of the character behind the one at pos, for continuing behind an empty match */
+   tiLine getNextChar(const char* pDoc, tiLine docLength, tiLine pos) const;
+
+protected:
+   tclRegex(const tclRegex&);
+   tclRegex& operator=(const tclRegex&);
+
+   struct tstCompiled;
+   std::unique_ptr<tstCompiled> mpCompiled;
+   bool mbUtf8;
+   bool mbDotMatchesNl;
+};
+#endif //TCLREGEX_H
@@ -21,20 +21,22 @@ a tclResult is the container for the result of searching for one pattern
 
 //#include "stdafx.h"
 #include "tclResult.h"
-//#include <algorithm> 
+#include <algorithm> 
 using namespace std;
 
 bool line_less(const tclPosInfo& one, const tclPosInfo& two) {
    return one.line < two.line;
 }
 
-tclResult::tclResult():mbDirty(true){}
+tclResult::tclResult():mbDirty(true),mSearchedLength(-1){}
 
 tclResult::~tclResult(){}
 
 tclResult::tclResult(const tclResult & right):mbDirty(true){
    mbDirty = right.mbDirty;
+   mSearchedLength = right.mSearchedLength;
    mlvPositions = tlvPosInfo(right.mlvPositions);
+   mStats = right.mStats;
 }
 
 tclResult & tclResult::operator= (const tclResult & right){
@@ -42,13 +44,17 @@ tclResult & tclResult::operator= (const tclResult & right){
       return *this;
    }
    mbDirty = right.mbDirty;
+   mSearchedLength = right.mSearchedLength;
    mlvPositions = right.mlvPositions;
+   mStats = right.mStats;
    return *this;
 }
 
 void tclResult::clear(){
    mlvPositions.clear();
    mbDirty = true;
+   mSearchedLength = -1;
+   mStats.clear();
 }
 
 unsigned tclResult::size() const {
@@ -69,12 +75,64 @@ const tclPosInfo& tclResult::getPosition(unsigned index) const {
    return mlvPositions[index];
 }
 
-void tclResult::push_back(int targetStart, int targetEnd, int lineNumber/*, const char* pLine*/){
+void tclResult::push_back(tiLine targetStart, tiLine targetEnd, tiLine lineNumber/*, const char* pLine*/){
    mlvPositions.push_back(tclPosInfo(targetStart, targetEnd, lineNumber/*, std::string(pLine)*/));
 }
 
+void tclResult::swap(tclResult& right){
+   std::swap(mbDirty, right.mbDirty);
+   std::swap(mSearchedLength, right.mSearchedLength);
+   mlvPositions.swap(right.mlvPositions);
+   std::swap(mStats, right.mStats);
+}
+
+bool start_less(const tclPosInfo& one, tiLine pos) {
+   return one.start < pos;
+}
+
+void tclResult::splitAt(tiLine pos, tclResult& tail){
+   tail.clear();
+   if (pos <= 0) {
+      swap(tail);
+      return;
+   }
+   tlvPosInfo::iterator it = lower_bound(mlvPositions.begin(), mlvPositions.end(), pos, start_less);
+   tail.mlvPositions.assign(it, mlvPositions.end());
+   mlvPositions.erase(it, mlvPositions.end());
+   tail.mbDirty = mbDirty;
+   tail.mSearchedLength = mSearchedLength;
+}
+
+void tclResult::append(const tclResult& tail){
+   mlvPositions.insert(mlvPositions.end(), tail.mlvPositions.begin(), tail.mlvPositions.end());
+}
+
+void tclResult::shift(tiLine posDelta, tiLine lineDelta) {
+   tlvPosInfo::iterator it = mlvPositions.begin();
+   for (; it != mlvPositions.end(); ++it) {
+      it->start += posDelta;
+      it->end += posDelta;
+      it->line += lineDelta;
+   }
+}
+
+tiLine tclResult::getLastEndBefore(tiLine pos) const {
+   tlvPosInfo::const_iterator it = lower_bound(mlvPositions.begin(), mlvPositions.end(), pos, start_less);
+   if (it == mlvPositions.begin()) {
+      return 0;
+   }
+   return (--it)->end;
+}
+
 void tclResult::setDirty(bool dirty){
    mbDirty = dirty;
+   if (dirty) {
+      mSearchedLength = -1;
+   }
+}
+
+void tclResult::setTextDirty(){
+   mbDirty = true;
 }
 
 bool tclResult::getIsDirty() const {
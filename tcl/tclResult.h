@@ -24,6 +24,7 @@ a tclResult is the container for the result of searching for one pattern
 #include <string>
 #include <vector>
 #include "tclPosInfo.h"
+#include "tclSearchStats.h"
 
 //struct tstLineInfo {
 //   tstLineInfo(int thisLine, const char* thispText, int thisIndex)
@@ -83,13 +84,66 @@ public:
    /**
     * add one position into the result 
     */
-   void push_back(int targetStart, int targetEnd, int lineNumber/*, const char* pLine*/);
+   void push_back(tiLine targetStart, tiLine targetEnd, tiLine lineNumber/*, const char* pLine*/);
 
+   /**
+   * exchange the content with right without copying the positions
+   */
+   void swap(tclResult& right);
+
+   /**
+   * move all positions starting at or behind pos into tail.
+   * pos 0 moves everything.
+   */
+   void splitAt(tiLine pos, tclResult& tail);
+
+   /**
+   * append the positions of tail
+   */
+   void append(const tclResult& tail);
+
+   /**
+   * move all positions by posDelta characters and lineDelta lines
+   */
+   void shift(tiLine posDelta, tiLine lineDelta);
+
+   /**
+   * end of the last position starting before pos or 0 if there is none
+   */
+   tiLine getLastEndBefore(tiLine pos) const;
+
+   /**
+   * marking a result dirty forgets the searched length, because the
+   * pattern has changed and the complete document has to be searched
+   */
    void setDirty(bool dirty=true);
+   /**
+   * mark dirty because the document text has been modified. the searched
+   * length is kept, so that the unmodified text needs not be searched again
+   */
+   void setTextDirty();
    bool getIsDirty() const ;
 
+   /** document length the result is valid for or -1 if unknown */
+   tiLine getSearchedLength() const {
+      return mSearchedLength;
+   }
+   void setSearchedLength(tiLine length) {
+      mSearchedLength = length;
+   }
+
+   /** costs of the last search; reset by clear() */
+   const tstSearchStats& getStats() const {
+      return mStats;
+   }
+   tstSearchStats& refStats() {
+      return mStats;
+   }
+
 protected:
    bool mbDirty; // set to false if search is completed
+   tiLine mSearchedLength; // document length at the end of the search
    tlvPosInfo mlvPositions;
+   tstSearchStats mStats;
 };
 #endif //TCLRESULT_H
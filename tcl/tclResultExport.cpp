@@ -0,0 +1,432 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclResultExport writes the result lines in one pass into a stream
+*/
+#include "tclResultExport.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#define MDBG_COMP "ResExp:"
+#include "myDebug.h"
+
+#define RTF_HEADER_BEGIN "{\\rtf1\\ansi\\ansicpg\\lang1024\\noproof1252\\uc1 \\deff0{\\fonttbl{\\f0\\fnil\\fcharset0\\fprq1 Courier New;}}\n{\\colortbl"
+// inbetween color table
+#define RTF_HEADER_END "}\n\\fs20\\sa0\\sl0\n" // ensure line spacing 1-line
+#define RTF_CRLF "\\par\n" // eol
+#define RTF_FOOTER "\\par }" // end doc
+#define RTF_COLNUM "\\cf" // fg color
+#define RTF_BGCOLNUM "\\highlight" // bg color
+#define RTF_COLTAG_RED "\n\\red" // red
+#define RTF_COLTAG_GREEN "\\green" // green
+#define RTF_COLTAG_BLUE "\\blue"  // blue
+#define RTF_COLTAG_END ";"
+#define RTF_COL_R(r) ((unsigned char)(r)) // mask char
+#define RTF_COL_G(g) ((unsigned char)(g>>8)) // mask short
+#define RTF_COL_B(b) ((unsigned char)(b>>16)) // mask third byte
+
+#define HTML_HEADER_BEGIN "<!DOCTYPE html>\n<html>\n<head>\n"
+#define HTML_CHARSET_UTF8 "<meta charset=\"utf-8\">\n"
+#define HTML_FONT "font-family: \"Courier New\", monospace; "
+#define HTML_HEADER_END "</style>\n</head>\n<body>\n<pre>"
+#define HTML_FOOTER "</pre>\n</body>\n</html>\n"
+
+#define CSV_HEADER "line,patterns,comment,text\r\n"
+#define CSV_EOL "\r\n"
+
+tclResultExport::tclResultExport(const tclFindResultDoc& results)
+   : mResults(results)
+   , mvStyles(1)
+   , mbUtf8(false)
+   , mpOs(0)
+   , mContentEnd(0)
+   , mCurStyle(-1)
+{
+   memset(mStyleIndex, 0, sizeof(mStyleIndex));
+}
+
+void tclResultExport::setDefaultStyle(const tstStyle& style) {
+   mvStyles[0] = style;
+}
+
+void tclResultExport::addStyle(unsigned char styleId, const tstStyle& style) {
+   if (mvStyles.size() > 0xff) {
+      DBG1("addStyle() no index left for style %d", (int)styleId);
+      return;
+   }
+   mStyleIndex[styleId] = (unsigned char)mvStyles.size();
+   mvStyles.push_back(style);
+}
+
+void tclResultExport::addPattern(tPatId patternId, const std::string& name, const std::string& comment) {
+   tstPatInfo& info = mPatterns[patternId];
+   info.name = name;
+   info.comment = comment;
+}
+
+bool tclResultExport::write(std::ostream& os, teFormat format) {
+   return write(os, format, 0, 0, mResults.size(), 0);
+}
+
+bool tclResultExport::write(std::ostream& os, teFormat format, tiLine fromLine, unsigned fromCol, tiLine toLine, unsigned toCol) {
+   const tiLine size = mResults.size();
+   if (toLine >= size) {
+      toLine = size;
+      toCol = 0;
+   }
+   // a range ending at the begin of a line ends with the line before
+   tiLine lastLine = toLine;
+   size_t lastEnd = toCol;
+   if (toCol == 0 && toLine > fromLine) {
+      --lastLine;
+      lastEnd = std::string::npos;
+   }
+   mpOs = &os;
+   mOut.clear();
+   mCurStyle = -1;
+   writeHeader(format);
+   for (tiLine resLine = (fromLine < 0) ? 0 : fromLine; resLine <= lastLine && resLine < size; ++resLine) {
+      if (format == fmtCsv) {
+         writeCsvLine(resLine);
+      }
+      else {
+         composeLine(resLine);
+         size_t begin = (resLine == fromLine) ? fromCol : 0;
+         size_t end = (resLine == lastLine) ? lastEnd : std::string::npos;
+         end = (end < mLine.size()) ? end : mLine.size();
+         begin = (begin < end) ? begin : end;
+         writeSegment(format, begin, end);
+      }
+      flush(false);
+   }
+   writeFooter(format);
+   flush(true);
+   os.flush();
+   DBG3("write() format %d lines %d to %d", (int)format, (int)fromLine, (int)lastLine);
+   return os.good();
+}
+
+void tclResultExport::writeHeader(teFormat format) {
+   switch (format) {
+   case fmtRtf:
+      mOut += RTF_HEADER_BEGIN;
+      for (size_t i = 0; i < mvStyles.size(); ++i) {
+         // every first of two is fgColor, every second bgColor
+         appendRtfColor(mvStyles[i].color);
+         appendRtfColor(mvStyles[i].bgColor);
+      }
+      mOut += RTF_HEADER_END;
+      break;
+   case fmtHtml:
+      mOut += HTML_HEADER_BEGIN;
+      if (mbUtf8) {
+         mOut += HTML_CHARSET_UTF8;
+      }
+      mOut += "<style>\npre { " HTML_FONT;
+      appendHtmlStyle(mvStyles[0]);
+      mOut += "}\n";
+      for (size_t i = 1; i < mvStyles.size(); ++i) {
+         char cls[16];
+         snprintf(cls, sizeof(cls), ".s%u { ", (unsigned)i);
+         mOut += cls;
+         appendHtmlStyle(mvStyles[i]);
+         mOut += "}\n";
+      }
+      mOut += HTML_HEADER_END;
+      break;
+   case fmtCsv:
+      mOut += CSV_HEADER;
+      break;
+   default:
+      break;
+   }
+}
+
+void tclResultExport::writeFooter(teFormat format) {
+   switch (format) {
+   case fmtRtf:
+      mOut += RTF_FOOTER;
+      break;
+   case fmtHtml:
+      mOut += HTML_FOOTER;
+      break;
+   default:
+      break;
+   }
+}
+
+void tclResultExport::composeLine(tiLine resLine) {
+   mLine.clear();
+   if (mLineHead) {
+      mLineHead(mLine, resLine);
+   }
+   const size_t headSize = mLine.size();
+   unsigned length = 0;
+   const char* text = mResults.getLineTextAtRes(resLine, length);
+   mLine.append(text, length);
+   mContentEnd = headSize + getContentLength(text, length);
+   // the head keeps the default style
+   mStyles.assign(mLine.size(), 0);
+   mResults.getStyleRuns(resLine, mvRuns);
+   for (size_t r = 0; r < mvRuns.size(); ++r) {
+      const tclFindResultDoc::tstStyleRun& run = mvRuns[r];
+      if (run.start >= length) {
+         continue;
+      }
+      unsigned end = (run.length < length - run.start) ? run.start + run.length : length;
+      std::fill(mStyles.begin() + headSize + run.start, mStyles.begin() + headSize + end,
+                (char)mStyleIndex[run.style]);
+   }
+}
+
+void tclResultExport::writeSegment(teFormat format, size_t begin, size_t end) {
+   const size_t contentEnd = (end < mContentEnd) ? end : mContentEnd;
+   size_t p = begin;
+   while (p < contentEnd) {
+      // the chars up to the next change of the style
+      size_t q = p + 1;
+      while (q < contentEnd && mStyles[q] == mStyles[p]) {
+         ++q;
+      }
+      const unsigned char styleIndex = (unsigned char)mStyles[p];
+      const tstStyle& style = mvStyles[styleIndex];
+      switch (format) {
+      case fmtRtf:
+         if (mCurStyle != (int)styleIndex) {
+            char ctrl[80];
+            snprintf(ctrl, sizeof(ctrl), RTF_COLNUM "%u" RTF_BGCOLNUM "%u%s%s%s ",
+                     styleIndex * 2u, styleIndex * 2u + 1,
+                     style.bBold ? "\\b" : "\\b0",
+                     style.bItalic ? "\\i" : "\\i0",
+                     style.bUnderlined ? "\\ul" : "\\ulnone");
+            mOut += ctrl;
+            mCurStyle = styleIndex;
+         }
+         appendRtf(mLine.data() + p, q - p);
+         break;
+      case fmtHtml:
+         if (styleIndex != 0) {
+            char span[32];
+            snprintf(span, sizeof(span), "<span class=\"s%u\">", (unsigned)styleIndex);
+            mOut += span;
+            appendHtml(mLine.data() + p, q - p);
+            mOut += "</span>";
+         }
+         else {
+            appendHtml(mLine.data() + p, q - p);
+         }
+         break;
+      default:
+         mOut.append(mLine, p, q - p);
+         break;
+      }
+      p = q;
+   }
+   if (end > mContentEnd) {
+      switch (format) {
+      case fmtRtf:
+         mOut += RTF_CRLF;
+         break;
+      case fmtHtml:
+         mOut += '\n';
+         break;
+      default:
+         mOut.append(mLine, mContentEnd, end - mContentEnd);
+         break;
+      }
+   }
+}
+
+void tclResultExport::writeCsvLine(tiLine resLine) {
+   char num[24];
+   snprintf(num, sizeof(num), "%lld,", (long long)mResults.getLineNoAtMain(resLine) + 1);
+   mOut += num;
+   // the hits are sorted by pattern id, so each pattern comes in one piece
+   tclFindResultDoc::tstLineHits hits = mResults.getLineAtRes(resLine);
+   std::string names;
+   const tstPatInfo* pFirst = 0;
+   bool bFirstSet = false;
+   for (const tclFindResultDoc::tstHit* pHit = hits.begin; pHit != hits.end; ++pHit) {
+      if (pHit != hits.begin && mResults.getPatId(*pHit) == mResults.getPatId(*(pHit - 1))) {
+         continue;
+      }
+      tlmPatInfo::const_iterator iPat = mPatterns.find(mResults.getPatId(*pHit));
+      const tstPatInfo* pInfo = (iPat != mPatterns.end()) ? &iPat->second : 0;
+      if (!bFirstSet) {
+         // the comment of the first pattern found in the line as in the view
+         pFirst = pInfo;
+         bFirstSet = true;
+      }
+      if (pInfo) {
+         if (!names.empty()) {
+            names += ' ';
+         }
+         names += pInfo->name;
+      }
+   }
+   appendCsvField(names.data(), names.size());
+   mOut += ',';
+   if (pFirst) {
+      appendCsvField(pFirst->comment.data(), pFirst->comment.size());
+   }
+   mOut += ',';
+   unsigned length = 0;
+   const char* text = mResults.getLineTextAtRes(resLine, length);
+   appendCsvField(text, getContentLength(text, length));
+   mOut += CSV_EOL;
+}
+
+void tclResultExport::appendRtf(const char* text, size_t length) {
+   const unsigned char* p = (const unsigned char*)text;
+   const unsigned char* pEnd = p + length;
+   char esc[24];
+   while (p < pEnd) {
+      unsigned c = *p++;
+      if (c == '\\' || c == '{' || c == '}') {
+         mOut += '\\';
+         mOut += (char)c;
+      }
+      else if (c == 0) {
+         continue; // zero is not valid
+      }
+      else if (c < 0x80) {
+         mOut += (char)c;
+      }
+      else if (!mbUtf8) {
+         snprintf(esc, sizeof(esc), "\\'%02x", c);
+         mOut += esc;
+      }
+      else {
+         // utf-8 sequence as unicode character, the ? is for readers without \u
+         unsigned follow = (c >= 0xf0) ? 3 : (c >= 0xe0) ? 2 : (c >= 0xc0) ? 1 : 0;
+         if (follow == 0 || (size_t)(pEnd - p) < follow) {
+            snprintf(esc, sizeof(esc), "\\'%02x", c);
+            mOut += esc;
+            continue;
+         }
+         unsigned cp = c & (0x3f >> follow);
+         for (unsigned i = 0; i < follow; ++i) {
+            cp = (cp << 6) | (*p++ & 0x3f);
+         }
+         if (cp > 0xffff) {
+            cp -= 0x10000;
+            snprintf(esc, sizeof(esc), "\\u%d?\\u%d?", (int)(short)(0xd800 + (cp >> 10)), (int)(short)(0xdc00 + (cp & 0x3ff)));
+         }
+         else {
+            snprintf(esc, sizeof(esc), "\\u%d?", (int)(short)cp);
+         }
+         mOut += esc;
+      }
+   }
+}
+
+void tclResultExport::appendHtml(const char* text, size_t length) {
+   for (const char* p = text; p < text + length; ++p) {
+      switch (*p) {
+      case '&':
+         mOut += "&amp;";
+         break;
+      case '<':
+         mOut += "&lt;";
+         break;
+      case '>':
+         mOut += "&gt;";
+         break;
+      case '"':
+         mOut += "&quot;";
+         break;
+      case 0:
+         break; // zero is not valid
+      default:
+         mOut += *p;
+         break;
+      }
+   }
+}
+
+void tclResultExport::appendCsvField(const char* text, size_t length) {
+   bool bQuote = false;
+   for (size_t i = 0; i < length && !bQuote; ++i) {
+      bQuote = (text[i] == ',' || text[i] == '"' || text[i] == '\r' || text[i] == '\n');
+   }
+   if (!bQuote) {
+      mOut.append(text, length);
+      return;
+   }
+   mOut += '"';
+   for (size_t i = 0; i < length; ++i) {
+      if (text[i] == '"') {
+         mOut += '"';
+      }
+      mOut += text[i];
+   }
+   mOut += '"';
+}
+
+void tclResultExport::appendRtfColor(tColor color) {
+   char num[8];
+   mOut += RTF_COLTAG_RED;
+   snprintf(num, sizeof(num), "%u", (unsigned)RTF_COL_R(color));
+   mOut += num;
+   mOut += RTF_COLTAG_GREEN;
+   snprintf(num, sizeof(num), "%u", (unsigned)RTF_COL_G(color));
+   mOut += num;
+   mOut += RTF_COLTAG_BLUE;
+   snprintf(num, sizeof(num), "%u", (unsigned)RTF_COL_B(color));
+   mOut += num;
+   mOut += RTF_COLTAG_END;
+}
+
+void tclResultExport::appendHtmlColor(tColor color) {
+   // tColor is stored as 0x00bbggrr
+   char rgb[8];
+   snprintf(rgb, sizeof(rgb), "#%02x%02x%02x",
+            (unsigned)RTF_COL_R(color), (unsigned)RTF_COL_G(color), (unsigned)RTF_COL_B(color));
+   mOut += rgb;
+}
+
+void tclResultExport::appendHtmlStyle(const tstStyle& style) {
+   mOut += "color: ";
+   appendHtmlColor(style.color);
+   mOut += "; background-color: ";
+   appendHtmlColor(style.bgColor);
+   mOut += "; ";
+   if (style.bBold) {
+      mOut += "font-weight: bold; ";
+   }
+   if (style.bItalic) {
+      mOut += "font-style: italic; ";
+   }
+   if (style.bUnderlined) {
+      mOut += "text-decoration: underline; ";
+   }
+}
+
+void tclResultExport::flush(bool bForce) {
+   if (mOut.size() >= RESEXP_FLUSH_SIZE || (bForce && !mOut.empty())) {
+      mpOs->write(mOut.data(), (std::streamsize)mOut.size());
+      mOut.clear();
+   }
+}
+
+size_t tclResultExport::getContentLength(const char* text, size_t length) {
+   while (length > 0 && (text[length - 1] == '\n' || text[length - 1] == '\r')) {
+      --length;
+   }
+   return length;
+}
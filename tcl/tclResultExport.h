@@ -0,0 +1,143 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclResultExport writes the result lines of a tclFindResultDoc as plain
+text, RTF, HTML or CSV into a stream. The lines are taken one by one out
+of the result and their styles are resolved from the hits, so the result
+is walked once and only one line plus a small output buffer is held in
+memory, independent of the count of lines written.
+The RTF colour table is the one of the result view: the default colours
+first and then the colours of the styles in the order they were added.
+*/
+
+#ifndef TCLRESULTEXPORT_H
+#define TCLRESULTEXPORT_H
+
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "tclColor.h"
+#include "tclFindResultDoc.h"
+
+// output is handed to the stream in pieces of this size
+#define RESEXP_FLUSH_SIZE 0x10000
+
+class tclResultExport {
+public:
+   enum teFormat {
+      fmtText, // as shown in the view
+      fmtRtf,
+      fmtHtml,
+      fmtCsv   // line, patterns, comment, text
+   };
+
+   /** look of one style of the result view */
+   struct tstStyle {
+      tstStyle() : color(0), bgColor(0xffffff), bBold(false), bItalic(false), bUnderlined(false) {}
+      tColor color;     // 0x00bbggrr
+      tColor bgColor;
+      bool bBold;
+      bool bItalic;
+      bool bUnderlined;
+   };
+
+   /** appends line number and comment shown in front of a result line */
+   typedef std::function<void(std::string& s, tiLine resLine)> tfLineHead;
+
+   explicit tclResultExport(const tclFindResultDoc& results);
+
+   /** style of the text not found by any pattern */
+   void setDefaultStyle(const tstStyle& style);
+
+   /** style used for the runs with styleId; the colour table follows the order of the calls */
+   void addStyle(unsigned char styleId, const tstStyle& style);
+
+   /** name and comment of a pattern as written into the csv columns */
+   void addPattern(tPatId patternId, const std::string& name, const std::string& comment);
+
+   /** the head is written in front of the lines in text, rtf and html */
+   void setLineHead(const tfLineHead& lineHead) {
+      mLineHead = lineHead;
+   }
+
+   /** the line texts are utf-8; else they are taken as ansi bytes */
+   void setUtf8(bool bUtf8) {
+      mbUtf8 = bUtf8;
+   }
+
+   /** write all result lines; returns false if the stream failed */
+   bool write(std::ostream& os, teFormat format);
+
+   /**
+   * write the part from column fromCol of fromLine to toCol of toLine. the
+   * columns count the line head too. toLine size() with toCol 0 is the end
+   * of the result. csv writes the complete lines touched by the range
+   */
+   bool write(std::ostream& os, teFormat format, tiLine fromLine, unsigned fromCol, tiLine toLine, unsigned toCol);
+
+protected:
+   struct tstPatInfo {
+      std::string name;
+      std::string comment;
+   };
+   typedef std::map<tPatId, tstPatInfo> tlmPatInfo;
+
+   void writeHeader(teFormat format);
+   void writeFooter(teFormat format);
+
+   /** put head, text and style of resLine into mLine and mStyles */
+   void composeLine(tiLine resLine);
+
+   /** write [begin, end) of mLine; the end of line is written if included */
+   void writeSegment(teFormat format, size_t begin, size_t end);
+
+   void writeCsvLine(tiLine resLine);
+
+   /** append text escaped for the format */
+   void appendRtf(const char* text, size_t length);
+   void appendHtml(const char* text, size_t length);
+   void appendCsvField(const char* text, size_t length);
+
+   void appendRtfColor(tColor color);
+   void appendHtmlColor(tColor color);
+   void appendHtmlStyle(const tstStyle& style);
+
+   /** hand the buffer to the stream once it is full or bForce */
+   void flush(bool bForce);
+
+   /** length of text without the line end */
+   static size_t getContentLength(const char* text, size_t length);
+
+   const tclFindResultDoc& mResults;
+   tfLineHead mLineHead;
+   std::vector<tstStyle> mvStyles;     // index 0 is the default style
+   unsigned char mStyleIndex[256];     // style id -> index in mvStyles
+   tlmPatInfo mPatterns;
+   bool mbUtf8;
+
+   std::ostream* mpOs;
+   std::string mOut;                   // output not yet handed to the stream
+   std::string mLine;                  // head and text of the line written
+   std::string mStyles;                // index in mvStyles per char of mLine
+   size_t mContentEnd;                 // end of mLine without the line end
+   int mCurStyle;                      // index in mvStyles set last in rtf, -1 at the begin
+   std::vector<tclFindResultDoc::tstStyleRun> mvRuns;
+};
+#endif //TCLRESULTEXPORT_H
@@ -64,6 +64,15 @@ bool tclResultList::setPattern(tPatId i, const tclPattern& pattern){
    }
 }
 
+void tclResultList::swapResults(tlmResult& results) {
+   mlmResult.swap(results);
+   for (tlmPatternList::const_iterator it = mlmPattern.begin(); it != mlmPattern.end(); ++it) {
+      if (mlmResult.find(it->first) == mlmResult.end()) {
+         mlmResult[it->first].setDirty();
+      }
+   }
+}
+
 bool tclResultList::getIsDirty() const {
    for (tlmResult::const_iterator it = mlmResult.begin();
       it != mlmResult.end();
@@ -76,6 +85,18 @@ bool tclResultList::getIsDirty() const {
    return false;
 }
 
+bool tclResultList::getIsAllSearchedAt(tiLine length) const {
+   for (tlmResult::const_iterator it = mlmResult.begin();
+      it != mlmResult.end();
+      ++it) 
+   {
+      if(!it->second.getIsDirty() || it->second.getSearchedLength() != length) { 
+         return false;
+      }
+   }
+   return true;
+}
+
 tPatId tclResultList::push_back(const tclPattern& pattern){
    tPatId id = tclPatternList::push_back(pattern);
    mlmResult[id] = tclResult();
@@ -59,6 +59,13 @@ public:
    */
    bool getIsDirty() const ;
 
+   /**
+   * true if all results are dirty and have been searched completely in 
+   * a document of the given length. only then the results can be moved
+   * with the modifications of the document
+   */
+   bool getIsAllSearchedAt(tiLine length) const ;
+
    /**
     * adds the given pattern to the list at the end and returns the actual position (index 0..)
     */
@@ -80,6 +87,12 @@ public:
       return mlmResult[i];
    }
 
+   /**
+   * exchange all results with the given ones. patterns left without a
+   * result get a dirty one
+   */
+   void swapResults(tlmResult& results);
+
    const_iterator begin() const {
       return mlmResult.begin();
    }
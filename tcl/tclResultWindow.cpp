@@ -0,0 +1,84 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclResultWindow is the part of the result lines put into the result view
+*/
+#include "tclResultWindow.h"
+
+tclResultWindow::tclResultWindow()
+   : mFirst(0)
+   , mCount(0)
+   , mLineCount(0)
+{}
+
+void tclResultWindow::setLineCount(tiLine lineCount)
+{
+   mLineCount = lineCount;
+   if (mFirst > mLineCount) {
+      mFirst = mLineCount;
+   }
+   if (mFirst + mCount > mLineCount) {
+      mCount = mLineCount - mFirst;
+   }
+}
+
+bool tclResultWindow::getIsCovering(tiLine top, tiLine screenLines) const
+{
+   tiLine half = getMargin(screenLines) / 2;
+   tiLine bottom = top + screenLines;
+   if (bottom > mLineCount) {
+      bottom = mLineCount;
+   }
+   bool bTop = (top >= mFirst) && (mFirst == 0 || top - mFirst >= half);
+   bool bBottom = (bottom <= getEnd()) && (getEnd() == mLineCount || getEnd() - bottom >= half);
+   return bTop && bBottom;
+}
+
+void tclResultWindow::placeAround(tiLine top, tiLine screenLines)
+{
+   tiLine margin = getMargin(screenLines);
+   tiLine first = (top > margin) ? top - margin : 0;
+   tiLine end = top + screenLines + margin;
+   place(first, end - first);
+}
+
+void tclResultWindow::place(tiLine first, tiLine count)
+{
+   if (first > mLineCount) {
+      first = mLineCount;
+   }
+   if (first < 0) {
+      first = 0;
+   }
+   if (count > mLineCount - first) {
+      count = mLineCount - first;
+   }
+   mFirst = first;
+   mCount = (count > 0) ? count : 0;
+}
+
+void tclResultWindow::clear()
+{
+   mFirst = 0;
+   mCount = 0;
+}
+
+tiLine tclResultWindow::getMargin(tiLine screenLines)
+{
+   return (screenLines > RESWIN_MIN_MARGIN) ? screenLines : RESWIN_MIN_MARGIN;
+}
@@ -0,0 +1,87 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclResultWindow is the part of the result lines put into the result view.
+The view only holds the lines on screen and a margin around them, so its
+memory does not depend on the count of result lines. The lines are
+addressed by their index in tclFindResultDoc, the virtual line.
+*/
+
+#ifndef TCLRESULTWINDOW_H
+#define TCLRESULTWINDOW_H
+
+#include "tclPosInfo.h"
+
+// lines kept at least above and below the lines on screen
+#define RESWIN_MIN_MARGIN 50
+
+class tclResultWindow {
+public:
+   tclResultWindow();
+
+   /** count of all result lines; the window is cut at the end */
+   void setLineCount(tiLine lineCount);
+
+   tiLine getLineCount() const {
+      return mLineCount;
+   }
+
+   /** virtual line of the first line in the window */
+   tiLine getFirst() const {
+      return mFirst;
+   }
+
+   /** count of lines in the window */
+   tiLine getCount() const {
+      return mCount;
+   }
+
+   /** virtual line behind the window */
+   tiLine getEnd() const {
+      return mFirst + mCount;
+   }
+
+   bool getIsInside(tiLine line) const {
+      return (line >= mFirst) && (line < mFirst + mCount);
+   }
+
+   /**
+   * true if the window holds the screen starting at virtual line top with
+   * at least half of the margin around it; there is no margin needed at
+   * the begin and the end of the result
+   */
+   bool getIsCovering(tiLine top, tiLine screenLines) const;
+
+   /** place the window around the screen starting at virtual line top */
+   void placeAround(tiLine top, tiLine screenLines);
+
+   /** place the window at the given lines, e.g. to search through a page */
+   void place(tiLine first, tiLine count);
+
+   /** no lines in the window */
+   void clear();
+
+   /** lines kept above and below the screen */
+   static tiLine getMargin(tiLine screenLines);
+
+protected:
+   tiLine mFirst;
+   tiLine mCount;
+   tiLine mLineCount;
+};
+#endif //TCLRESULTWINDOW_H
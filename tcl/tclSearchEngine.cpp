@@ -0,0 +1,1047 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclSearchEngine searches all literal patterns of a result list in one pass
+over the document buffer and the regular expressions beside them.
+*/
+#include "tclSearchEngine.h"
+#include "tclCompiledPattern.h"
+#include "tclLineIndexFile.h"
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+#include <thread>
+#include <stdexcept>
+#include "Scintilla.h"
+#define MDBG_COMP "SrchEng:"
+#include "myDebug.h"
+
+// check for cancel each 4 MB of scanned text
+#define SEARCHENGINE_CANCEL_MASK 0x3FFFFF
+// documents below this count of the smallest chunks are scanned by one thread only
+#define SEARCHENGINE_MIN_PARALLEL_CHUNKS 4
+// smallest chunk of a document scanned by one thread
+#define SEARCHENGINE_MIN_CHUNK_SIZE (1024*1024)
+
+tclSearchEngine::tclSearchEngine()
+   : mpHost(0)
+   , mCodePage(0)
+   , mpDoc(0)
+   , mDocLength(0)
+   , mSearchFrom(0)
+   , mSearchTo(0)
+   , mbCanceled(false)
+   , mMaxThreads(0)
+   , mMinChunkSize(SEARCHENGINE_MIN_CHUNK_SIZE)
+   , mbStop(false)
+   , mbLineIndexValid(false)
+   , mbCollectLines(false)
+   , mbNgramIndexValid(false)
+   , mAutomataUsed(0)
+   , mbFoldCheck(false)
+   , mbFolded(false)
+   , mpCancel(0)
+{
+   setCharClasses("", "", "");
+}
+
+void tclSearchEngine::setCharClasses(const std::string& wordChars, const std::string& whitespaceChars, const std::string& punctuationChars)
+{
+   // defaults as in Scintilla CharClassify::SetDefaultCharClasses()
+   for (int ch = 0; ch < 256; ++ch) {
+      if (ch == '\r' || ch == '\n') {
+         mCharClass[ch] = ccNewLine;
+      } else if (ch < 0x20 || ch == ' ') {
+         mCharClass[ch] = ccSpace;
+      } else if (ch >= 0x80 || isalnum(ch) || ch == '_') {
+         mCharClass[ch] = ccWord;
+      } else {
+         mCharClass[ch] = ccPunctuation;
+      }
+   }
+   std::string::const_iterator it;
+   for (it = whitespaceChars.begin(); it != whitespaceChars.end(); ++it) {
+      mCharClass[(unsigned char)*it] = ccSpace;
+   }
+   for (it = punctuationChars.begin(); it != punctuationChars.end(); ++it) {
+      mCharClass[(unsigned char)*it] = ccPunctuation;
+   }
+   for (it = wordChars.begin(); it != wordChars.end(); ++it) {
+      mCharClass[(unsigned char)*it] = ccWord;
+   }
+}
+
+const std::string& tclSearchEngine::getLiteralText(const tclPattern& pattern) const
+{
+   // converted once and kept by the pattern
+   return pattern.getCompiled(mCodePage).getText();
+}
+
+bool tclSearchEngine::isRegexLiteral(const generic_string& text)
+{
+   static const TCHAR szMeta[] = TEXT("\\^$.|?*+()[]{}");
+   return text.find_first_of(szMeta) == generic_string::npos;
+}
+
+bool tclSearchEngine::isLineBound(const tclPattern& pattern)
+{
+   generic_string text = pattern.getSearchTextConverted();
+   if (text.find_first_of(TEXT("\r\n")) != generic_string::npos) {
+      return false;
+   }
+   switch (pattern.getSearchType()) {
+   case tclPattern::normal:
+   case tclPattern::escaped:
+      return true;
+   case tclPattern::regex:
+      // escapes, negated sets, classes and inline flags like (?s) may match line ends
+      for (size_t i = 0; i + 1 < text.size(); ++i) {
+         if (text[i] == '\\') {
+            if (generic_string(TEXT("nrsvWDHRNxuce0123456789pPXQ")).find(text[i + 1]) != generic_string::npos) {
+               return false;
+            }
+            ++i;
+         } else if (text[i] == '[' && (text[i + 1] == '^' || text[i + 1] == ':')) {
+            return false;
+         } else if (text[i] == '(' && text[i + 1] == '?' && i + 2 < text.size() &&
+                    generic_string(TEXT(":=!<")).find(text[i + 2]) == generic_string::npos) {
+            return false;
+         }
+      }
+      return true;
+   default:
+      return false;
+   }
+}
+
+bool tclSearchEngine::isSupported(const tclPattern& pattern) const
+{
+   if (isLiteral(pattern)) {
+      return true;
+   }
+   // tclRegex matches utf-8 per character and all others per byte
+   if (mCodePage != 0 && mCodePage != SC_CP_UTF8) {
+      return false;
+   }
+   if (pattern.getSearchType() != tclPattern::regex && pattern.getSearchType() != tclPattern::rgx_multiline) {
+      return false;
+   }
+   try {
+      // compiled once and kept by the pattern
+      pattern.getCompiled(mCodePage).getRegex();
+   } catch (const std::runtime_error&) {
+      // scintilla reports the error
+      return false;
+   }
+   return true;
+}
+
+bool tclSearchEngine::isLiteral(const tclPattern& pattern) const
+{
+   switch (pattern.getSearchType()) {
+   case tclPattern::normal:
+   case tclPattern::escaped:
+      break;
+   case tclPattern::regex:
+   case tclPattern::rgx_multiline:
+      // plain text in a regex; whole word is left to the regex engine
+      if (pattern.getIsWholeWord() || !isRegexLiteral(pattern.getSearchText())) {
+         return false;
+      }
+      break;
+   default:
+      return false;
+   }
+   // DBCS code pages need character aware stepping
+   if (mCodePage != 0 && mCodePage != SC_CP_UTF8) {
+      return false;
+   }
+   if (pattern.getIsMatchCase() == false) {
+      // scintilla folds case per character; only ASCII folding is identical
+      const std::string& text = getLiteralText(pattern);
+      for (std::string::const_iterator it = text.begin(); it != text.end(); ++it) {
+         if ((unsigned char)*it >= 0x80) {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+void tclSearchEngine::setDocument(const char* pDoc, tiLine length)
+{
+   mpDoc = (const unsigned char*)pDoc;
+   mDocLength = length;
+   mbLineIndexValid = false;
+   mbNgramIndexValid = false;
+}
+
+void tclSearchEngine::updateDocument(const char* pDoc, tiLine length, const tclEditRange& edit)
+{
+   const bool bValid = mbLineIndexValid && edit.getIsValid() && 
+                       mLineIndex.getLength() + edit.getDelta() == length;
+   mpDoc = (const unsigned char*)pDoc;
+   mDocLength = length;
+   // the n-gram index is only kept for the same text
+   if (!edit.getIsValid() || edit.getIsModified() || mNgramIndex.getLength() != length) {
+      mbNgramIndexValid = false;
+   }
+   if (!bValid) {
+      mbLineIndexValid = false;
+   } else if (edit.getIsModified()) {
+      mLineIndex.update(pDoc, length, edit.getStart(), edit.getOldEnd());
+   } else {
+      // the buffer may have been moved
+      mLineIndex.update(pDoc, length, length, length);
+   }
+}
+
+void tclSearchEngine::moveDocument(const char* pDoc)
+{
+   if (mLineIndex.getDocument() == (const char*)mpDoc) {
+      mLineIndex.moveDocument(pDoc);
+   }
+   mpDoc = (const unsigned char*)pDoc;
+}
+
+unsigned tclSearchEngine::search(const tclResultList& list, tclResultList::tlmResult& found, tiLine from, tiLine to)
+{
+   if (prepare(list, from, to) == 0) {
+      return 0;
+   }
+   run(true);
+   return collect(found);
+}
+
+unsigned tclSearchEngine::prepare(const tclResultList& list, tiLine from, tiLine to)
+{
+   mbCanceled = false;
+   mlvLiterals.clear();
+   mlvRegexes.clear();
+   mlvUnits.clear();
+   mlvFinished.clear();
+   mlvErrors.clear();
+   mAutomataUsed = 0;
+   mbFoldCheck = false;
+   mbFolded = false;
+   if (mpDoc == 0 || mDocLength < 1) {
+      // empty document is left to doFindPattern()
+      return 0;
+   }
+   mSearchTo = (to < 0 || to > mDocLength) ? mDocLength : to;
+   mSearchFrom = (from < 0) ? 0 : (from > mSearchTo) ? mSearchTo : from;
+   tclResultList::const_iterator iResult = list.begin();
+   for (; iResult != list.end(); ++iResult) {
+      if (iResult.getResult().getIsDirty() == false) {
+         continue;
+      }
+      const tclPattern& pattern = list.getPattern(iResult.getPatId());
+      if (pattern.getDoSearch() == false || !isSupported(pattern)) {
+         continue;
+      }
+      if (!isLiteral(pattern)) {
+         tstRegex rx;
+         rx.patId = iResult.getPatId();
+         rx.pCompiled = pattern.getCompiledShared(mCodePage);
+         if (rx.pCompiled->getText().size() == 0) {
+            continue;
+         }
+         rx.bLineBound = rx.pCompiled->getIsLineBound();
+         rx.lastEnd = iResult.getResult().getLastEndBefore(mSearchFrom);
+         mlvRegexes.push_back(rx);
+         continue;
+      }
+      tstLiteral lit;
+      lit.patId = iResult.getPatId();
+      lit.text = getLiteralText(pattern);
+      if (lit.text.size() == 0) {
+         continue;
+      }
+      lit.bMatchCase = pattern.getIsMatchCase();
+      lit.bWholeWord = pattern.getIsWholeWord();
+      lit.bFoldable = isFoldable(lit.text, lit.bMatchCase);
+      mbFoldCheck = mbFoldCheck || lit.bFoldable;
+      lit.lastEnd = iResult.getResult().getLastEndBefore(mSearchFrom);
+      mlvLiterals.push_back(lit);
+   }
+   if (mlvLiterals.size() == 0) {
+      return (unsigned)mlvRegexes.size();
+   }
+   // the literals are spread over automata; if there are less automata
+   // than threads the document is split into chunks scanned in parallel
+   const unsigned nThreads = getThreadCount();
+   const unsigned nAutomata = (nThreads < mlvLiterals.size()) ? nThreads : (unsigned)mlvLiterals.size();
+   mlvGroups.assign(nAutomata, std::vector<unsigned>());
+   for (unsigned i = 0; i < mlvLiterals.size(); ++i) {
+      mlvGroups[i % nAutomata].push_back(i);
+   }
+   // the automata of the last search are used again for the same literals,
+   // e.g. when searching the modified lines after an edit
+   std::string automataKey(1, (char)nAutomata);
+   for (tlvLiteral::const_iterator it = mlvLiterals.begin(); it != mlvLiterals.end(); ++it) {
+      automataKey += it->text;
+      automataKey += '\0';
+   }
+   if (automataKey != mAutomataKey || mlvAutomata.size() != nAutomata) {
+      DBG0("prepare() compile automata");
+      mlvAutomata.assign(nAutomata, tstAutomaton());
+      for (unsigned a = 0; a < nAutomata; ++a) {
+         compile(mlvGroups[a], mlvAutomata[a]);
+      }
+      mAutomataKey.swap(automataKey);
+   }
+   mAutomataUsed = nAutomata;
+   return (unsigned)(mlvLiterals.size() + mlvRegexes.size());
+}
+
+void tclSearchEngine::run(bool bPollHost)
+{
+   if (mlvLiterals.size() == 0 && mlvRegexes.size() == 0) {
+      return;
+   }
+   const unsigned nThreads = getThreadCount();
+   const unsigned nAutomata = mAutomataUsed;
+   // with an n-gram index only the blocks which may contain a literal are
+   // scanned. those, a partly searched document, the line numbers of regex
+   // matches and results handed over during the scan need a complete line
+   // index, otherwise it is built during the scan
+   const unsigned nWanted = (nAutomata > 0) ? (nThreads + nAutomata - 1) / nAutomata : 0;
+   const bool bSelected = (nAutomata > 0) && selectChunks(nWanted);
+   if (bSelected || mSearchFrom > 0 || mSearchTo < mDocLength || mlvRegexes.size() > 0 || mOnProgress) {
+      getLineIndex();
+   }
+   mbCollectLines = !mbLineIndexValid;
+   if (mbFoldCheck) {
+      // a hit may reach behind the range by the length of a literal
+      tiLine end = mSearchTo;
+      for (tlvLiteral::const_iterator it = mlvLiterals.begin(); it != mlvLiterals.end(); ++it) {
+         end = (std::max)(end, mSearchTo + (tiLine)it->text.size());
+      }
+      mbFolded = hasFoldedChars(mSearchFrom, (std::min)(end, mDocLength));
+      DBG1("run() folded characters %d", (int)mbFolded);
+   }
+   if (nAutomata > 0 && !bSelected) {
+      splitChunks(nWanted);
+   }
+   const unsigned nChunks = (nAutomata > 0) ? (unsigned)mlvChunkLines.size() : 0;
+   DBG3("run() %d literals, %d automata, %d chunks", (int)mlvLiterals.size(), (int)nAutomata, (int)nChunks);
+   // the regular expressions go first, they take longer than the automata.
+   // one which can't match a line end is split like the literals
+   mlvUnits.clear();
+   tlvPosition begins;
+   tlvPosition ends;
+   splitRange(nThreads, begins, ends);
+   for (unsigned r = 0; r < mlvRegexes.size(); ++r) {
+      const unsigned nRanges = mlvRegexes[r].bLineBound ? (unsigned)begins.size() : 1;
+      for (unsigned c = 0; c < nRanges; ++c) {
+         tstWorkUnit unit;
+         unit.group = nAutomata + r;
+         unit.chunk = c;
+         unit.begin = mlvRegexes[r].bLineBound ? begins[c] : mSearchFrom;
+         unit.end = mlvRegexes[r].bLineBound ? ends[c] : mSearchTo;
+         unit.ms = 0;
+         mlvUnits.push_back(unit);
+      }
+   }
+   for (unsigned u = 0; u < nAutomata * nChunks; ++u) {
+      tstWorkUnit unit;
+      unit.group = u / nChunks;
+      unit.chunk = u % nChunks;
+      unit.begin = mlvChunkBegin[unit.chunk];
+      unit.end = mlvChunkEnd[unit.chunk];
+      unit.hits.resize(mlvLiterals.size());
+      unit.ms = 0;
+      mlvUnits.push_back(unit);
+   }
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mlvRemaining.assign(nAutomata + mlvRegexes.size(), 0);
+      for (unsigned u = 0; u < mlvUnits.size(); ++u) {
+         ++mlvRemaining[mlvUnits[u].group];
+      }
+      mlvFinished.clear();
+   }
+   mbStop = false;
+   mNextUnit = 0;
+   std::vector<std::thread> workers;
+   for (unsigned t = 1; t < nThreads; ++t) {
+      workers.push_back(std::thread([this]() {
+         runWorkUnits(false);
+      }));
+   }
+   // the calling thread works too; only it talks to the host
+   runWorkUnits(bPollHost);
+   for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it) {
+      it->join();
+   }
+   if (mbStop) {
+      DBG0("run() cancelled");
+      mbCanceled = true;
+      mlvChunkLines.clear();
+      return;
+   }
+   if (mbCollectLines) {
+      // collect the pieces in document order; the groups have waited for it
+      mLineIndex.setDocument((const char*)mpDoc, mDocLength);
+      for (unsigned c = 0; c < nChunks; ++c) {
+         tlvPosition::const_iterator it = mlvChunkLines[c].begin();
+         for (; it != mlvChunkLines[c].end(); ++it) {
+            mLineIndex.addLineStart(*it);
+         }
+      }
+      mbLineIndexValid = true;
+      mbCollectLines = false;
+      {
+         std::lock_guard<std::mutex> lock(mMutex);
+         for (unsigned g = 0; g < mlvRemaining.size(); ++g) {
+            mlvFinished.push_back(g);
+         }
+      }
+      if (mOnProgress) {
+         mOnProgress();
+      }
+   }
+   mlvChunkLines.clear();
+}
+
+void tclSearchEngine::finishUnit(unsigned group)
+{
+   bool bFinished = false;
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (--mlvRemaining[group] == 0 && !mbCollectLines) {
+         mlvFinished.push_back(group);
+         bFinished = true;
+      }
+   }
+   if (bFinished && mOnProgress) {
+      mOnProgress();
+   }
+}
+
+unsigned tclSearchEngine::collect(tclResultList::tlmResult& found)
+{
+   std::vector<unsigned> groups;
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      groups.swap(mlvFinished);
+   }
+   if (mbCanceled) {
+      return 0;
+   }
+   // the units of a group are in document order
+   unsigned count = 0;
+   std::sort(groups.begin(), groups.end());
+   for (std::vector<unsigned>::const_iterator itGroup = groups.begin(); itGroup != groups.end(); ++itGroup) {
+      const unsigned g = *itGroup;
+      double groupMs = 0;
+      if (g >= mAutomataUsed) {
+         const tstRegex& rx = mlvRegexes[g - mAutomataUsed];
+         tclResult& result = found[rx.patId];
+         result.clear();
+         std::string error;
+         for (std::vector<tstWorkUnit>::iterator it = mlvUnits.begin(); it != mlvUnits.end(); ++it) {
+            if (it->group != g) {
+               continue;
+            }
+            if (it->error.size() > 0) {
+               error = it->error;
+            }
+            result.append(it->found);
+            tclResult().swap(it->found);
+            groupMs += it->ms;
+         }
+         if (error.size() > 0) {
+            result.clear();
+            mlvErrors.push_back(std::make_pair(rx.patId, error));
+         }
+         result.setDirty(false);
+         result.setSearchedLength(mDocLength);
+         tstSearchStats& stats = result.refStats();
+         stats.searchMs = groupMs;
+         stats.bytes = mSearchTo - mSearchFrom;
+         stats.hits = result.size();
+         ++count;
+         continue;
+      }
+      // the time of the common pass is shared by the literals of an automaton
+      const std::vector<unsigned>& literals = mlvGroups[g];
+      std::vector<tlvPosition> hits(literals.size());
+      for (std::vector<tstWorkUnit>::iterator it = mlvUnits.begin(); it != mlvUnits.end(); ++it) {
+         if (it->group != g) {
+            continue;
+         }
+         for (unsigned i = 0; i < literals.size(); ++i) {
+            const tlvPosition& unitHits = it->hits[literals[i]];
+            hits[i].insert(hits[i].end(), unitHits.begin(), unitHits.end());
+         }
+         std::vector<tlvPosition>().swap(it->hits);
+         groupMs += it->ms;
+      }
+      for (unsigned i = 0; i < literals.size(); ++i) {
+         const tstLiteral& lit = mlvLiterals[literals[i]];
+         if (lit.bFoldable && mbFolded) {
+            // left dirty for doFindPattern()
+            tlvPosition().swap(hits[i]);
+            continue;
+         }
+         tclResult& result = found[lit.patId];
+         result.clear();
+         tclStopWatch finalizeWatch;
+         finalize(lit, hits[i], result);
+         result.setDirty(false);
+         result.setSearchedLength(mDocLength);
+         tlvPosition().swap(hits[i]);
+         tstSearchStats& stats = result.refStats();
+         stats.searchMs = groupMs / literals.size() + finalizeWatch.getMs();
+         stats.bytes = mSearchTo - mSearchFrom;
+         stats.hits = result.size();
+         stats.bShared = (mlvLiterals.size() > 1);
+         ++count;
+      }
+   }
+   return count;
+}
+
+void tclSearchEngine::takeErrors(tlvError& errors)
+{
+   errors.insert(errors.end(), mlvErrors.begin(), mlvErrors.end());
+   mlvErrors.clear();
+}
+
+unsigned tclSearchEngine::getThreadCount() const
+{
+   unsigned count = (mMaxThreads != 0) ? mMaxThreads : std::thread::hardware_concurrency();
+   if (count == 0 || mSearchTo - mSearchFrom < SEARCHENGINE_MIN_PARALLEL_CHUNKS * mMinChunkSize) {
+      count = 1;
+   }
+   return count;
+}
+
+void tclSearchEngine::splitChunks(unsigned count)
+{
+   splitRange(count, mlvChunkBegin, mlvChunkEnd);
+   mlvChunkLines.assign(mlvChunkBegin.size(), tlvPosition());
+}
+
+void tclSearchEngine::splitRange(unsigned count, tlvPosition& begins, tlvPosition& ends) const
+{
+   const tiLine range = mSearchTo - mSearchFrom;
+   // chunks should not get too small to be worth a thread
+   if (count > (unsigned)(range / mMinChunkSize)) {
+      count = (unsigned)(range / mMinChunkSize);
+   }
+   if (count == 0) {
+      count = 1;
+   }
+   begins.assign(1, mSearchFrom);
+   for (unsigned c = 1; c < count; ++c) {
+      tiLine pos = mSearchFrom + (range / count) * c;
+      if (pos < begins.back()) {
+         pos = begins.back();
+      }
+      // move behind the next line end
+      while (pos < mSearchTo && !tclLineIndex::isLineEndAt(mpDoc, pos, mDocLength)) {
+         ++pos;
+      }
+      begins.push_back((pos < mSearchTo) ? pos + 1 : mSearchTo);
+   }
+   ends.assign(begins.begin() + 1, begins.end());
+   ends.push_back(mSearchTo);
+}
+
+bool tclSearchEngine::selectChunks(unsigned count)
+{
+   if (!mbNgramIndexValid) {
+      return false;
+   }
+   std::vector<tclNgramIndex::tlvKey> keys(mlvLiterals.size());
+   for (unsigned i = 0; i < mlvLiterals.size(); ++i) {
+      tclNgramIndex::getKeys(mlvLiterals[i].text, keys[i]);
+      if (keys[i].empty()) {
+         // may be in any block
+         return false;
+      }
+   }
+   const tclNgramIndex& index = mNgramIndex;
+   const unsigned lastBlock = index.getBlockAt(mSearchTo - 1);
+   // candidate ranges of whole blocks cut to the search range
+   tlvPosition begins;
+   tlvPosition ends;
+   tiLine selected = 0;
+   for (unsigned b = index.getBlockAt(mSearchFrom); b <= lastBlock && mSearchFrom < mSearchTo; ++b) {
+      unsigned i = 0;
+      while (i < keys.size() && !index.mayContain(b, keys[i])) {
+         ++i;
+      }
+      if (i == keys.size()) {
+         continue;
+      }
+      const tiLine begin = (std::max)(index.getBlockStart(b), mSearchFrom);
+      const tiLine end = (std::min)(index.getBlockEnd(b), mSearchTo);
+      if (!ends.empty() && ends.back() == begin) {
+         ends.back() = end;
+      } else {
+         begins.push_back(begin);
+         ends.push_back(end);
+      }
+      selected += end - begin;
+   }
+   if (selected == mSearchTo - mSearchFrom) {
+      return false;
+   }
+   DBG2("selectChunks() %d of %d bytes", (int)selected, (int)(mSearchTo - mSearchFrom));
+   // long ranges are cut at block borders to keep all threads busy
+   const tiLine chunkSize = (std::max)(selected / (tiLine)count, mMinChunkSize);
+   mlvChunkBegin.clear();
+   mlvChunkEnd.clear();
+   for (size_t r = 0; r < begins.size(); ++r) {
+      tiLine begin = begins[r];
+      while (ends[r] - begin > chunkSize) {
+         const unsigned b = index.getBlockAt(begin + chunkSize);
+         const tiLine cut = index.getBlockStart(b);
+         if (cut <= begin) {
+            break;
+         }
+         mlvChunkBegin.push_back(begin);
+         mlvChunkEnd.push_back(cut);
+         begin = cut;
+      }
+      mlvChunkBegin.push_back(begin);
+      mlvChunkEnd.push_back(ends[r]);
+   }
+   mlvChunkLines.assign(mlvChunkBegin.size(), tlvPosition());
+   return true;
+}
+
+void tclSearchEngine::runWorkUnits(bool bPollHost)
+{
+   try {
+      for (;;) {
+         unsigned u = mNextUnit++;
+         if (u >= mlvUnits.size() || mbStop) {
+            break;
+         }
+         tstWorkUnit& unit = mlvUnits[u];
+         tclStopWatch watch;
+         if (unit.group < mAutomataUsed) {
+            // line starts are collected together with the first automaton
+            tlvPosition* pLines = (mbCollectLines && unit.group == 0) ? &mlvChunkLines[unit.chunk] : 0;
+            scan(mlvAutomata[unit.group], unit.begin, unit.end, bPollHost, unit.hits, pLines);
+         } else {
+            searchRegex(unit, bPollHost);
+         }
+         unit.ms = watch.getMs();
+         if (!mbStop) {
+            finishUnit(unit.group);
+         }
+      }
+   } catch (...) {
+      mbStop = true;
+   }
+}
+
+void tclSearchEngine::compile(const std::vector<unsigned>& literals, tstAutomaton& automaton) const
+{
+   // reduce the alphabet to the bytes used in the patterns, class 0 is "other"
+   memset(automaton.inputClass, 0, sizeof(automaton.inputClass));
+   automaton.numClasses = 1;
+   automaton.maxLength = 0;
+   std::vector<unsigned>::const_iterator itLit;
+   for (itLit = literals.begin(); itLit != literals.end(); ++itLit) {
+      const std::string& text = mlvLiterals[*itLit].text;
+      if ((tiLine)text.size() > automaton.maxLength) {
+         automaton.maxLength = (tiLine)text.size();
+      }
+      for (std::string::const_iterator it = text.begin(); it != text.end(); ++it) {
+         unsigned char c = foldCase((unsigned char)*it);
+         if (automaton.inputClass[c] == 0) {
+            automaton.inputClass[c] = (unsigned short)automaton.numClasses++;
+         }
+      }
+   }
+   for (int c = 'A'; c <= 'Z'; ++c) {
+      automaton.inputClass[c] = automaton.inputClass[c - 'A' + 'a'];
+   }
+   // build the trie on case folded text; match case is verified on hit
+   const unsigned N = automaton.numClasses;
+   std::vector<int>& delta = automaton.delta;
+   delta.assign(N, -1);
+   std::vector<std::vector<unsigned> > out(1);
+   for (itLit = literals.begin(); itLit != literals.end(); ++itLit) {
+      int s = 0;
+      const std::string& text = mlvLiterals[*itLit].text;
+      for (std::string::const_iterator it = text.begin(); it != text.end(); ++it) {
+         size_t idx = s * N + automaton.inputClass[(unsigned char)*it];
+         if (delta[idx] < 0) {
+            delta[idx] = (int)out.size();
+            delta.resize(delta.size() + N, -1);
+            out.push_back(std::vector<unsigned>());
+         }
+         s = delta[idx];
+      }
+      out[s].push_back(*itLit);
+   }
+   // breadth first: fail links, complete transitions and merged outputs
+   std::vector<int> fail(out.size(), 0);
+   std::vector<int> queue;
+   queue.reserve(out.size());
+   for (unsigned cls = 0; cls < N; ++cls) {
+      if (delta[cls] < 0) {
+         delta[cls] = 0;
+      } else {
+         queue.push_back(delta[cls]);
+      }
+   }
+   for (size_t q = 0; q < queue.size(); ++q) {
+      int s = queue[q];
+      for (unsigned cls = 0; cls < N; ++cls) {
+         int& t = delta[s * N + cls];
+         int f = delta[fail[s] * N + cls];
+         if (t < 0) {
+            t = f;
+         } else {
+            fail[t] = f;
+            out[t].insert(out[t].end(), out[f].begin(), out[f].end());
+            queue.push_back(t);
+         }
+      }
+   }
+   automaton.outBegin.assign(out.size() + 1, 0);
+   automaton.out.clear();
+   for (size_t s = 0; s < out.size(); ++s) {
+      automaton.outBegin[s] = (unsigned)automaton.out.size();
+      automaton.out.insert(automaton.out.end(), out[s].begin(), out[s].end());
+   }
+   automaton.outBegin[out.size()] = (unsigned)automaton.out.size();
+   // in the start state the scan skips to the next byte which leaves it
+   unsigned char bytes[258];
+   unsigned count = 0;
+   for (int c = 0; c < 256; ++c) {
+      if (delta[automaton.inputClass[c]] != 0) {
+         bytes[count++] = (unsigned char)c;
+      }
+   }
+   const bool bStartPairs = !automaton.startBytes.setBytes(bytes, count);
+   bytes[count++] = '\r';
+   bytes[count++] = '\n';
+   const bool bStartOrLinePairs = !automaton.startOrLineBytes.setBytes(bytes, count);
+   if (bStartPairs || bStartOrLinePairs) {
+      // too many first bytes: skip to the first two bytes of a literal
+      // instead, any follower for a literal of one byte
+      std::vector<bool> single(N, false);
+      std::vector<bool> classPairs(N * N, false);
+      for (itLit = literals.begin(); itLit != literals.end(); ++itLit) {
+         const std::string& text = mlvLiterals[*itLit].text;
+         const unsigned first = automaton.inputClass[(unsigned char)text[0]];
+         if (text.size() == 1) {
+            single[first] = true;
+         } else {
+            classPairs[first * N + automaton.inputClass[(unsigned char)text[1]]] = true;
+         }
+      }
+      std::vector<bool> pairs(BYTESCANNER_PAIRS, false);
+      for (unsigned pair = 0; pair < BYTESCANNER_PAIRS; ++pair) {
+         const unsigned first = automaton.inputClass[pair >> 8];
+         pairs[pair] = (first != 0) && (single[first] || classPairs[first * N + automaton.inputClass[pair & 0xFF]]);
+      }
+      if (bStartPairs) {
+         automaton.startBytes.setPairs(pairs);
+      }
+      if (bStartOrLinePairs) {
+         for (unsigned follower = 0; follower < 256; ++follower) {
+            pairs['\r' * 256 + follower] = true;
+            pairs['\n' * 256 + follower] = true;
+         }
+         automaton.startOrLineBytes.setPairs(pairs);
+      }
+   }
+   DBG3("compile() %d states %d classes %d start bytes", (int)out.size(), (int)N, (int)automaton.startBytes.getCount());
+}
+
+void tclSearchEngine::scan(const tstAutomaton& automaton, tiLine begin, tiLine end, bool bPollHost,
+                           std::vector<tlvPosition>& hits, tlvPosition* pLineStarts)
+{
+   const unsigned N = automaton.numClasses;
+   const int* delta = &automaton.delta[0];
+   const unsigned* outBegin = &automaton.outBegin[0];
+   const unsigned char* p = mpDoc;
+   const tiLine len = mDocLength;
+   // hits starting before end may reach up to maxLength-1 behind it
+   const tiLine scanEnd = (end + automaton.maxLength - 1 < len) ? end + automaton.maxLength - 1 : len;
+   // skip the bytes which can't start a literal, see compile()
+   const tclByteScanner& skip = pLineStarts ? automaton.startOrLineBytes : automaton.startBytes;
+   const bool bSkip = skip.getIsSkipping();
+   tiLine nextPoll = begin + SEARCHENGINE_CANCEL_MASK;
+   int s = 0;
+   for (tiLine i = begin; i < scanEnd; ++i) {
+      if (s == 0 && bSkip) {
+         i = (tiLine)(skip.find(p + i, p + scanEnd) - p);
+         if (i >= scanEnd) {
+            break;
+         }
+      }
+      const unsigned char c = p[i];
+      if (pLineStarts && i < end && tclLineIndex::isLineEndAt(p, i, len)) {
+         pLineStarts->push_back(i + 1);
+      }
+      s = delta[s * N + automaton.inputClass[c]];
+      for (unsigned o = outBegin[s]; o < outBegin[s + 1]; ++o) {
+         const unsigned iLit = automaton.out[o];
+         const tstLiteral& lit = mlvLiterals[iLit];
+         const tiLine start = i + 1 - (tiLine)lit.text.size();
+         if (start >= end) {
+            continue; // belongs to the next chunk
+         }
+         if (lit.bMatchCase && memcmp(p + start, lit.text.data(), lit.text.size()) != 0) {
+            continue;
+         }
+         hits[iLit].push_back(start);
+      }
+      if (i >= nextPoll) {
+         nextPoll = i + SEARCHENGINE_CANCEL_MASK;
+         if (isStopped(bPollHost)) {
+            return;
+         }
+      }
+   }
+}
+
+bool tclSearchEngine::isStopped(bool bPollHost)
+{
+   if ((mpCancel && mpCancel->getIsCanceled()) || 
+       (bPollHost && mpHost && mpHost->isSearchCanceled())) {
+      mbStop = true;
+   }
+   return mbStop;
+}
+
+void tclSearchEngine::searchRegex(tstWorkUnit& unit, bool bPollHost)
+{
+   const tstRegex& rx = mlvRegexes[unit.group - mAutomataUsed];
+   const tclRegex& regex = rx.pCompiled->getRegex();
+   const char* pDoc = (const char*)mpDoc;
+   const tclLineIndex& lineIndex = mLineIndex;
+   // a range ending at a line start must not let $ match there, the same
+   // as in doFindPattern()
+   tiLine end = unit.end;
+   if (end < mDocLength && end > unit.begin && pDoc[end - 1] == '\n') {
+      --end;
+   }
+   if (end < mDocLength && end > unit.begin && pDoc[end - 1] == '\r') {
+      --end;
+   }
+   // a regex containing a literal only needs to run where the literal is;
+   // if it matches within one line only the lines with the literal
+   const tclLiteralFinder* pLiteral = rx.pCompiled->getRequiredLiteral();
+   const bool bLinewise = (pLiteral != 0) && rx.bLineBound;
+   tiLine pos = (rx.lastEnd > unit.begin) ? rx.lastEnd : unit.begin;
+   tiLine nextPoll = pos + SEARCHENGINE_CANCEL_MASK;
+   try {
+      if (pLiteral && findLiteral(*pLiteral, pos, end) == 0) {
+         return;
+      }
+      tiLine rangeEnd = end;
+      while (pos <= end) {
+         if (pos >= nextPoll) {
+            nextPoll = pos + SEARCHENGINE_CANCEL_MASK;
+            if (isStopped(bPollHost)) {
+               return;
+            }
+         }
+         if (bLinewise) {
+            // next line containing the literal; the match is inside it
+            const char* pHit = (pos < end) ? findLiteral(*pLiteral, pos, end) : 0;
+            if (pHit == 0) {
+               break;
+            }
+            tiLine line = lineIndex.lineFromPosition((tiLine)(pHit - pDoc));
+            pos = (std::max)(pos, lineIndex.positionFromLine(line));
+            rangeEnd = (std::min)(end, lineIndex.lineEndPosition(line));
+         }
+         tiLine matchStart;
+         tiLine matchEnd;
+         if (!regex.find(pDoc, mDocLength, pos, rangeEnd, matchStart, matchEnd)) {
+            if (!bLinewise || rangeEnd >= end) {
+               break;
+            }
+            // behind the line end
+            pos = lineIndex.positionFromLine(lineIndex.lineFromPosition(rangeEnd) + 1);
+            continue;
+         }
+         tiLine lineStart = lineIndex.lineFromPosition(matchStart);
+         tiLine lineEnd = lineIndex.lineFromPosition(matchEnd);
+         for (tiLine line = lineStart; line <= lineEnd; ++line) {
+            unit.found.push_back(matchStart, matchEnd, line);
+         }
+         // empty matches continue behind
+         pos = (matchEnd > matchStart) ? matchEnd : regex.getNextChar(pDoc, mDocLength, matchEnd);
+      }
+   } catch (const std::runtime_error& e) {
+      // e.g. an expression too complex for a line
+      unit.error = e.what();
+      unit.found.clear();
+   }
+}
+
+bool tclSearchEngine::isFoldable(const std::string& text, bool bMatchCase) const
+{
+   if (bMatchCase || mCodePage != SC_CP_UTF8) {
+      return false;
+   }
+   // sharp s and long s fold to s and ss, the kelvin sign to k and the
+   // ligatures to ff, fi, fl, ffi, ffl and st
+   return text.find_first_of("sSkKfF") != std::string::npos;
+}
+
+bool tclSearchEngine::hasFoldedChars(tiLine begin, tiLine end) const
+{
+   // lead bytes of U+00DF, U+017F, U+1E9E, U+212A and U+FB00 to U+FB06
+   static const unsigned char lead[] = { 0xC3, 0xC5, 0xE1, 0xE2, 0xEF };
+   tclByteScanner scanner;
+   scanner.setBytes(lead, sizeof(lead));
+   const unsigned char* p = mpDoc + begin;
+   const unsigned char* pEnd = mpDoc + end;
+   for (;;) {
+      p = scanner.find(p, pEnd);
+      if (p >= pEnd) {
+         return false;
+      }
+      // a character may reach behind end
+      const tiLine left = (tiLine)(mpDoc + mDocLength - p);
+      if ((p[0] == 0xC3 && left >= 2 && p[1] == 0x9F) ||
+          (p[0] == 0xC5 && left >= 2 && p[1] == 0xBF) ||
+          (p[0] == 0xE1 && left >= 3 && p[1] == 0xBA && p[2] == 0x9E) ||
+          (p[0] == 0xE2 && left >= 3 && p[1] == 0x84 && p[2] == 0xAA) ||
+          (p[0] == 0xEF && left >= 3 && p[1] == 0xAC && p[2] >= 0x80 && p[2] <= 0x86)) {
+         return true;
+      }
+      ++p;
+   }
+}
+
+unsigned tclSearchEngine::finalize(const tstLiteral& lit, const tlvPosition& hits, tclResult& result)
+{
+   // scintilla continues behind a hit, so hits never overlap
+   tiLine lastEnd = lit.lastEnd;
+   unsigned count = 0;
+   const tiLine len = (tiLine)lit.text.size();
+   for (tlvPosition::const_iterator it = hits.begin(); it != hits.end(); ++it) {
+      const tiLine start = *it;
+      const tiLine end = start + len;
+      if (start < lastEnd) {
+         continue;
+      }
+      if (lit.bWholeWord && !isWordAt(start, end)) {
+         continue;
+      }
+      tiLine lineStart = mLineIndex.lineFromPosition(start);
+      tiLine lineEnd = mLineIndex.lineFromPosition(end);
+      for (tiLine line = lineStart; line <= lineEnd; ++line) {
+         result.push_back(start, end, line);
+      }
+      lastEnd = end;
+      ++count;
+   }
+   DBG1("finalize() found %d items.", count);
+   return count;
+}
+
+tclSearchEngine::teCharClass tclSearchEngine::getCharClassAt(tiLine pos) const
+{
+   // outside of the document is treated as space
+   if (pos < 0 || pos >= mDocLength) {
+      return ccSpace;
+   }
+   return (teCharClass)mCharClass[mpDoc[pos]];
+}
+
+bool tclSearchEngine::isWordAt(tiLine start, tiLine end)
+{
+   if (mCodePage == SC_CP_UTF8 && mpHost) {
+      // unicode characters are classified by category in scintilla
+      if ((start > 0 && mpDoc[start - 1] >= 0x80) || mpDoc[start] >= 0x80 ||
+          mpDoc[end - 1] >= 0x80 || (end < mDocLength && mpDoc[end] >= 0x80)) {
+         return mpHost->isRangeWord(start, end);
+      }
+   }
+   teCharClass ccStart = getCharClassAt(start);
+   teCharClass ccEnd = getCharClassAt(end - 1);
+   // same as Document::IsWordEdge()
+   bool bStart = (ccStart != getCharClassAt(start - 1)) && (ccStart == ccWord || ccStart == ccPunctuation);
+   bool bEnd = (ccEnd != getCharClassAt(end)) && (ccEnd == ccWord || ccEnd == ccPunctuation);
+   return (start < end) && bStart && bEnd;
+}
+
+const tclLineIndex& tclSearchEngine::getLineIndex()
+{
+   if (!mbLineIndexValid) {
+      mLineIndex.build((const char*)mpDoc, mDocLength);
+      mbLineIndexValid = true;
+   }
+   return mLineIndex;
+}
+
+bool tclSearchEngine::takeLineIndex(tclLineIndex& index)
+{
+   if (index.getDocument() != (const char*)mpDoc || index.getLength() != mDocLength) {
+      return false;
+   }
+   mLineIndex.swap(index);
+   mbLineIndexValid = true;
+   return true;
+}
+
+void tclSearchEngine::buildNgramIndex()
+{
+   mNgramIndex.build((const char*)mpDoc, mDocLength, mMaxThreads);
+   mbNgramIndexValid = (mDocLength > 0);
+}
+
+bool tclSearchEngine::takeNgramIndex(tclNgramIndex& index)
+{
+   if (index.getLength() != mDocLength || mDocLength < 1 ||
+       index.getHash() != tclLineIndexFile::getHash((const char*)mpDoc, mDocLength)) {
+      return false;
+   }
+   mNgramIndex.swap(index);
+   mbNgramIndexValid = true;
+   return true;
+}
+
+const char* tclSearchEngine::findLiteral(const tclLiteralFinder& literal, tiLine from, tiLine to) const
+{
+   const char* pDoc = (const char*)mpDoc;
+   const tclNgramIndex::tlvKey& keys = literal.getNgramKeys();
+   if (!mbNgramIndexValid || keys.empty() || from >= to) {
+      return literal.find(pDoc + from, pDoc + to);
+   }
+   // a literal without line ends doesn't cross a block border
+   for (unsigned b = mNgramIndex.getBlockAt(from); b < mNgramIndex.getBlockCount() && mNgramIndex.getBlockStart(b) < to; ++b) {
+      if (!mNgramIndex.mayContain(b, keys)) {
+         continue;
+      }
+      const tiLine begin = (std::max)(mNgramIndex.getBlockStart(b), from);
+      const tiLine end = (std::min)(mNgramIndex.getBlockEnd(b), to);
+      const char* hit = literal.find(pDoc + begin, pDoc + end);
+      if (hit != 0) {
+         return hit;
+      }
+   }
+   return 0;
+}
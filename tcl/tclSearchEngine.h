@@ -0,0 +1,396 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclSearchEngine searches all literal patterns of a result list in one pass
+over the document buffer. The patterns are compiled into one Aho-Corasick
+automaton; every hit is verified and filtered so that the result is the
+same as the one of the SCI_SEARCHINTARGET loop in doFindPattern().
+Regular expressions without any meta character are searched as literals,
+all others with tclRegex in parallel to the literals; those which can't
+match a line end in line aligned chunks on all threads.
+*/
+
+#ifndef TCLSEARCHENGINE_H
+#define TCLSEARCHENGINE_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include "tclPattern.h"
+#include "tclResultList.h"
+#include "tclLineIndex.h"
+#include "tclEditRange.h"
+#include "tclByteScanner.h"
+#include "tclNgramIndex.h"
+#include "tclCancelToken.h"
+
+class tclLiteralFinder;
+class tclCompiledPattern;
+
+/**
+ * interface used by the engine to ask the editor for things it cannot
+ * decide on the raw buffer
+ */
+class tclSearchHost {
+public:
+   virtual ~tclSearchHost() {}
+   /** whole word test as done by scintilla; used for non ASCII neighbours */
+   virtual bool isRangeWord(tiLine start, tiLine end) = 0;
+   /** polled during the scan; return true to stop searching */
+   virtual bool isSearchCanceled() = 0;
+};
+
+class tclSearchEngine {
+public:
+   // same values as Scintilla::CharacterClass
+   enum teCharClass {
+      ccSpace = 0,
+      ccNewLine,
+      ccWord,
+      ccPunctuation
+   };
+
+   tclSearchEngine();
+
+   void setHost(tclSearchHost* pHost) {
+      mpHost = pHost;
+   }
+
+   void setCodePage(unsigned cp) {
+      mCodePage = cp;
+   }
+
+   /**
+   * set the document to be searched. the buffer is not copied and has to
+   * stay valid during search().
+   */
+   void setDocument(const char* pDoc, tiLine length);
+
+   /**
+   * same as setDocument() for the former document modified as told by 
+   * edit; the line index is updated instead of being built again
+   */
+   void updateDocument(const char* pDoc, tiLine length, const tclEditRange& edit);
+
+   /**
+   * the same text as the one set is found at pDoc now, e.g. a copy of it
+   * or the buffer again after the copy was searched; the indexes are kept
+   */
+   void moveDocument(const char* pDoc);
+
+   const char* getDocument() const {
+      return (const char*)mpDoc;
+   }
+
+   tiLine getDocLength() const {
+      return mDocLength;
+   }
+
+   /**
+   * line index of the document; built during search() or on first request
+   */
+   const tclLineIndex& getLineIndex();
+
+   /**
+   * use a line index of the actual document built elsewhere, e.g. read
+   * from a file, so search() doesn't collect the lines. index gets the
+   * former one. false if it doesn't belong to the document.
+   */
+   bool takeLineIndex(tclLineIndex& index);
+
+   /**
+   * build the n-gram index of the document. search() and findLiteral()
+   * skip the blocks without the literals until the document is set again
+   * or modified.
+   */
+   void buildNgramIndex();
+
+   /**
+   * use an n-gram index of the actual document built elsewhere, e.g. read
+   * from a file. index gets the former one. false if it doesn't belong to
+   * the document.
+   */
+   bool takeNgramIndex(tclNgramIndex& index);
+
+   /** n-gram index of the document or 0 */
+   const tclNgramIndex* getNgramIndex() const {
+      return mbNgramIndexValid ? &mNgramIndex : 0;
+   }
+
+   /**
+   * first occurrence of literal in [from, to) of the document or 0; only
+   * the blocks of the n-gram index which may contain it are searched
+   */
+   const char* findLiteral(const tclLiteralFinder& literal, tiLine from, tiLine to) const;
+
+   /**
+   * initialise the character classes used for whole word checks.
+   * the strings are those returned by SCI_GETWORDCHARS,
+   * SCI_GETWHITESPACECHARS and SCI_GETPUNCTUATIONCHARS
+   */
+   void setCharClasses(const std::string& wordChars, const std::string& whitespaceChars, const std::string& punctuationChars);
+
+   /**
+   * returns true if the pattern can be searched by the engine as literal
+   * or as regular expression. all other patterns and regular expressions
+   * which don't compile have to be searched by scintilla.
+   */
+   bool isSupported(const tclPattern& pattern) const;
+
+   /** returns true if the pattern is searched as literal by the automata */
+   bool isLiteral(const tclPattern& pattern) const;
+
+   /**
+   * returns true if no match of pattern can contain a line end. only then
+   * a document with appended text can be searched from its last line on
+   */
+   static bool isLineBound(const tclPattern& pattern);
+
+   /**
+   * search all dirty and supported patterns of list in one pass; the
+   * regular expressions are searched during the same pass.
+   * the results are added into found with the pattern id as key and
+   * are not dirty anymore. returns the number of searched patterns.
+   * with a range [from, to) only matches starting in there are searched;
+   * the results in list are expected to be valid in front of from.
+   * to < 0 means the end of the document.
+   */
+   unsigned search(const tclResultList& list, tclResultList::tlmResult& found, tiLine from = 0, tiLine to = -1);
+
+   /**
+   * search() in three parts for scanning on another thread. prepare()
+   * takes the patterns out of list, which is not used afterwards, and
+   * returns their count. run() scans the document; without bPollHost the
+   * host is not asked, so it may run on any thread while the document
+   * stays unmodified. collect() hands the results over like search(); 
+   * while run() is still going on only those of the patterns completely
+   * searched so far, the next call the following ones. case insensitive
+   * literals scintilla would also find at folded characters of a utf-8
+   * document are not handed over, see hasFoldedChars().
+   */
+   unsigned prepare(const tclResultList& list, tiLine from = 0, tiLine to = -1);
+   void run(bool bPollHost = true);
+   unsigned collect(tclResultList::tlmResult& found);
+
+   /**
+   * called by run() on the scanning thread whenever collect() has results
+   * of further patterns, e.g. to post a message to the UI thread
+   */
+   void setOnProgress(const std::function<void()>& onProgress) {
+      mOnProgress = onProgress;
+   }
+
+   /** pattern id and message of the regular expressions failed in the text */
+   typedef std::vector<std::pair<tPatId, std::string> > tlvError;
+
+   /**
+   * errors of the results handed over by collect(), e.g. of a regular
+   * expression too complex for a line; the patterns have empty results
+   */
+   void takeErrors(tlvError& errors);
+
+   /**
+   * the scan stops soon after pToken got cancelled; it is polled by all
+   * scanning threads
+   */
+   void setCancelToken(const tclCancelToken* pToken) {
+      mpCancel = pToken;
+   }
+
+   bool getCanceled() const {
+      return mbCanceled;
+   }
+
+   /**
+   * maximum count of threads used for scanning; 0 means one per core
+   */
+   void setMaxThreads(unsigned count) {
+      mMaxThreads = count;
+   }
+
+   /**
+   * smallest part of the document scanned by one thread, 1 MB by default;
+   * documents below four of them are scanned by one thread only. lowered
+   * by the tests for searching small documents in parallel.
+   */
+   void setMinChunkSize(tiLine size) {
+      mMinChunkSize = (size > 0) ? size : 1;
+   }
+
+protected:
+   struct tstLiteral {
+      tPatId patId;
+      std::string text;    // pattern in document code page
+      bool bMatchCase;
+      bool bWholeWord;
+      bool bFoldable;      // scintilla also matches it at characters it folds to ASCII letters
+      tiLine lastEnd;      // end of the last match in front of the search range
+   };
+   typedef std::vector<tstLiteral> tlvLiteral;
+   typedef std::vector<tiLine> tlvPosition;
+
+   /**
+   * regular expression; the compiled pattern is shared, so it stays while
+   * the pattern gets modified during the search
+   */
+   struct tstRegex {
+      tPatId patId;
+      std::shared_ptr<const tclCompiledPattern> pCompiled;
+      bool bLineBound;     // searched in chunks
+      tiLine lastEnd;      // end of the last match in front of the search range
+   };
+
+   /**
+   * automaton for a group of literals; each thread scans with its own one
+   */
+   struct tstAutomaton {
+      unsigned short inputClass[256]; // byte -> input class
+      unsigned numClasses;
+      std::vector<int> delta;         // dense transition table
+      std::vector<unsigned> outBegin; // per state index into out
+      std::vector<unsigned> out;      // literal indexes
+      tiLine maxLength;               // longest literal
+      tclByteScanner startBytes;      // bytes leaving the start state
+      tclByteScanner startOrLineBytes; // the same and the line ends
+   };
+
+   /**
+   * one piece of work: one automaton or regular expression over one line
+   * aligned chunk. groups from the count of automata on are the regular
+   * expressions.
+   */
+   struct tstWorkUnit {
+      unsigned group;
+      unsigned chunk;
+      tiLine begin;
+      tiLine end;
+      std::vector<tlvPosition> hits;  // per literal, only those of the automaton used
+      tclResult found;                // matches of the regular expression
+      std::string error;              // message of the regular expression failed
+      double ms;
+   };
+
+   /** search text of pattern in document code page */
+   const std::string& getLiteralText(const tclPattern& pattern) const;
+
+   /** true if text has no regular expression meta character */
+   static bool isRegexLiteral(const generic_string& text);
+
+   /** build the automaton for the given literals */
+   void compile(const std::vector<unsigned>& literals, tstAutomaton& automaton) const;
+
+   /**
+   * run the automaton over [begin, end) of the document and collect the
+   * raw hits starting in there. the scan runs up to maxLength-1 behind
+   * end to find hits crossing the chunk border. line starts are collected
+   * if pLineStarts is given.
+   */
+   void scan(const tstAutomaton& automaton, tiLine begin, tiLine end, bool bPollHost,
+             std::vector<tlvPosition>& hits, tlvPosition* pLineStarts);
+
+   /** search the regular expression of unit in its range */
+   void searchRegex(tstWorkUnit& unit, bool bPollHost);
+
+   /** true if the scan has to stop; the host is only asked with bPollHost */
+   bool isStopped(bool bPollHost);
+
+   /** process work units until none is left */
+   void runWorkUnits(bool bPollHost);
+
+   /** a unit of group is done; the group is collectable after its last one */
+   void finishUnit(unsigned group);
+
+   /** number of threads to be used for the actual literals */
+   unsigned getThreadCount() const;
+
+   /** split the search range into count line aligned chunks */
+   void splitChunks(unsigned count);
+
+   /** the line aligned ranges of splitChunks() */
+   void splitRange(unsigned count, tlvPosition& begins, tlvPosition& ends) const;
+
+   /**
+   * make chunks of the blocks of the n-gram index in the search range
+   * which may contain a literal, about count for the whole range. false
+   * if no block can be left out.
+   */
+   bool selectChunks(unsigned count);
+
+   /**
+   * true if scintilla may match a case insensitive literal of text in a
+   * utf-8 document at characters it folds to ASCII letters, see
+   * hasFoldedChars()
+   */
+   bool isFoldable(const std::string& text, bool bMatchCase) const;
+
+   /**
+   * true if [begin, end) contains a character CaseFolderUnicode folds to
+   * ASCII letters: sharp s, long s, the kelvin sign and the ligatures
+   */
+   bool hasFoldedChars(tiLine begin, tiLine end) const;
+
+   /** apply whole word and non overlapping rules and fill the result */
+   unsigned finalize(const tstLiteral& lit, const tlvPosition& hits, tclResult& result);
+
+   bool isWordAt(tiLine start, tiLine end);
+   teCharClass getCharClassAt(tiLine pos) const;
+   static unsigned char foldCase(unsigned char c) {
+      return (c >= 'A' && c <= 'Z') ? (unsigned char)(c - 'A' + 'a') : c;
+   }
+
+   tclSearchHost* mpHost;
+   unsigned mCodePage;
+   const unsigned char* mpDoc;
+   tiLine mDocLength;
+   tiLine mSearchFrom;
+   tiLine mSearchTo;
+   bool mbCanceled;
+   unsigned mMaxThreads;
+   tiLine mMinChunkSize;
+   std::atomic<bool> mbStop;       // signals all scanning threads to stop
+   std::atomic<unsigned> mNextUnit; // next work unit to be processed
+   unsigned char mCharClass[256];
+
+   tlvLiteral mlvLiterals;
+   std::vector<std::vector<unsigned> > mlvGroups; // literals per automaton
+   std::vector<tstAutomaton> mlvAutomata; // kept for searching the same literals again
+   std::string mAutomataKey;              // count of automata and texts they are built of
+   unsigned mAutomataUsed;                // automata used by the actual literals
+   bool mbFoldCheck;                      // a literal is foldable, see tstLiteral
+   bool mbFolded;                         // the foldable literals are left to scintilla
+   std::vector<tstRegex> mlvRegexes;
+   std::vector<tstWorkUnit> mlvUnits;
+   std::mutex mMutex;                     // guards the two below
+   std::vector<unsigned> mlvRemaining;    // units left per group
+   std::vector<unsigned> mlvFinished;     // groups not collected yet
+   tlvError mlvErrors;                    // of the groups collected
+   std::function<void()> mOnProgress;
+   tlvPosition mlvChunkBegin;          // per chunk
+   tlvPosition mlvChunkEnd;            // per chunk, may leave a gap to the next one
+   std::vector<tlvPosition> mlvChunkLines; // line starts found per chunk
+   tclLineIndex mLineIndex;
+   bool mbLineIndexValid;
+   bool mbCollectLines;  // the line index is built during the scan
+   tclNgramIndex mNgramIndex;
+   bool mbNgramIndexValid;
+   const tclCancelToken* mpCancel;
+};
+#endif //TCLSEARCHENGINE_H
@@ -0,0 +1,70 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclSearchStats holds what the last search of a pattern has cost
+*/
+
+#ifndef TCLSEARCHSTATS_H
+#define TCLSEARCHSTATS_H
+
+#include <chrono>
+#include "tclPosInfo.h"
+
+/**
+ * costs of the last search of one pattern. unlike the DBG macros they are
+ * collected in release builds too; it takes two clock reads per pattern.
+ */
+struct tstSearchStats {
+   tstSearchStats() {
+      clear();
+   }
+   void clear() {
+      searchMs = 0;
+      insertMs = 0;
+      bytes = 0;
+      hits = 0;
+      lines = 0;
+      bShared = false;
+   }
+   double searchMs;  // wall time of searching the pattern
+   double insertMs;  // wall time of updating the result window
+   tiLine bytes;     // length of the searched text
+   unsigned hits;    // positions found
+   unsigned lines;   // lines added to the result window
+   bool bShared;     // searched in one pass with other literals, searchMs is its share
+};
+
+/**
+ * wall time since construction or the last restart()
+ */
+class tclStopWatch {
+public:
+   tclStopWatch() : mStart(std::chrono::steady_clock::now()) {}
+
+   void restart() {
+      mStart = std::chrono::steady_clock::now();
+   }
+
+   double getMs() const {
+      return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStart).count();
+   }
+
+protected:
+   std::chrono::steady_clock::time_point mStart;
+};
+#endif //TCLSEARCHSTATS_H
@@ -0,0 +1,63 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclSearchTask runs a search job on a thread of its own
+*/
+#include <exception>
+#include "tclSearchTask.h"
+#define MDBG_COMP "SrTask:"
+#include "myDebug.h"
+
+tclSearchTask::tclSearchTask()
+   : mbRunning(false)
+   , mbFailed(false)
+{}
+
+tclSearchTask::~tclSearchTask()
+{
+   wait();
+}
+
+void tclSearchTask::start(const std::function<void()>& job, const std::function<void()>& done)
+{
+   wait();
+   mbRunning = true;
+   mbFailed = false;
+   mThread = std::thread([this, job, done]() {
+      // an exception must not leave the thread, it would terminate the process
+      try {
+         job();
+      } catch (const std::exception& e) {
+         DBG1("start() job failed: %s", e.what());
+         mbFailed = true;
+      } catch (...) {
+         DBG0("start() job failed");
+         mbFailed = true;
+      }
+      mbRunning = false;
+      done();
+   });
+}
+
+void tclSearchTask::wait()
+{
+   if (mThread.joinable()) {
+      DBG0("wait()");
+      mThread.join();
+   }
+}
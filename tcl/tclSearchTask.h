@@ -0,0 +1,64 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tclSearchTask runs one job at a time on a thread of its own, so the UI
+thread stays responsive while the document is scanned. When the job is
+done, done() is called on that thread too; it is expected to post a
+message to the UI thread and nothing more. An exception thrown by the job,
+e.g. bad_alloc, is caught on the thread and recorded as failure; done() is
+called anyway, so the UI thread learns that the job is over.
+*/
+
+#ifndef TCLSEARCHTASK_H
+#define TCLSEARCHTASK_H
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+class tclSearchTask {
+public:
+   tclSearchTask();
+
+   /** waits for the running job */
+   ~tclSearchTask();
+
+   /** run job and then done; a job still running is waited for before */
+   void start(const std::function<void()>& job, const std::function<void()>& done);
+
+   /** block until the job and done() have returned */
+   void wait();
+
+   bool getIsRunning() const {
+      return mbRunning.load();
+   }
+
+   /** the last job was left by an exception */
+   bool getFailed() const {
+      return mbFailed.load();
+   }
+
+protected:
+   tclSearchTask(const tclSearchTask&);
+   tclSearchTask& operator=(const tclSearchTask&);
+
+   std::thread mThread;
+   std::atomic<bool> mbRunning;
+   std::atomic<bool> mbFailed;
+};
+#endif //TCLSEARCHTASK_H
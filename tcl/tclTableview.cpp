@@ -29,6 +29,7 @@ in the find config dock window
 #include "myDebug.h"
 
 #define MAX_CHAR_CELL 1000 // max chars in a cell including \0
+#define TIME_COL_SIZE 40
 
 // use teColumnNums to address the columns
 const tstPatternConfTab tclTableview::gPatternConfTab[tclTableview::TBLVIEW_COL_MAX] = {
@@ -36,6 +37,7 @@ const tstPatternConfTab tclTableview::gPatternConfTab[tclTableview::TBLVIEW_COL_
     {TEXT("#"), 20 },
 #endif
     {TEXT("Hits"),   0 }
+   ,{TEXT("ms"),     0 }
    ,{TEXT("Active"), 20 }
    ,{TEXT("Order"),  30}
    ,{TEXT("Search"), 100}
@@ -125,6 +127,7 @@ void tclTableview::updateRow(int item, const tclPattern& rp) {
    updateCell(item, TBLVIEW_COL_NUM, generic_itoa(item, num, 10));
 #endif
    updateCell(item, TBLVIEW_COL_HITS, generic_string(TEXT(""))); // TODO test if pattern is dirty before resetting.
+   updateCell(item, TBLVIEW_COL_TIME, generic_string(TEXT("")));
    updateCell(item, TBLVIEW_COL_ORDER_NUM, rp.getOrderNumStr());
    updateCell(item, TBLVIEW_COL_DO_SEARCH, rp.getDoSearch()?TEXT("X"):TEXT(""));
    updateCell(item, TBLVIEW_COL_SEARCH_TEXT, rp.getSearchText());
@@ -167,9 +170,14 @@ void tclTableview::setHitsRowVisible(bool bVisible, const tclResultList& results
          generic_itoa(n, num, 10);
          updateCell(row, TBLVIEW_COL_HITS, num);
          max = (n > max) ? n : max;
+         // literals searched together show their share of the common pass
+         const tstSearchStats& stats = r.getStats();
+         generic_sprintf(num, stats.bShared ? TEXT("~%.1f") : TEXT("%.1f"), stats.searchMs + stats.insertMs);
+         updateCell(row, TBLVIEW_COL_TIME, num);
       }
       else {
          updateCell(row, TBLVIEW_COL_HITS, TEXT(""));
+         updateCell(row, TBLVIEW_COL_TIME, TEXT(""));
       }
    }
    miHitsCountColSize =   (max<10) ? 20 :
@@ -177,6 +185,7 @@ void tclTableview::setHitsRowVisible(bool bVisible, const tclResultList& results
                            (max<10000) ? 35 :
                            (max<100000) ? 40 : 50;
    ListView_SetColumnWidth(mhList, TBLVIEW_COL_HITS, bVisible ? miHitsCountColSize : 0);
+   ListView_SetColumnWidth(mhList, TBLVIEW_COL_TIME, bVisible ? TIME_COL_SIZE : 0);
 }
 
 void tclTableview::setGroupColumnVisible(bool bVisible) {
@@ -286,11 +295,12 @@ void tclTableview::resetTableColumns(bool bUpdateWindow) {
    if (bUpdateWindow) {
       ListView_SetColumnOrderArray(mhList, TBLVIEW_COL_MAX, mColumnOrder);
       for (int i = 0; i < TBLVIEW_COL_MAX; ++i) {
-         if (i != TBLVIEW_COL_HITS) {
+         if (i != TBLVIEW_COL_HITS && i != TBLVIEW_COL_TIME) {
             ListView_SetColumnWidth(mhList, i, mColumnWidth[i]);
          }
       }
       ListView_SetColumnWidth(mhList, TBLVIEW_COL_HITS, isHitsRowVisible() ? miHitsCountColSize : 0);
+      ListView_SetColumnWidth(mhList, TBLVIEW_COL_TIME, isHitsRowVisible() ? TIME_COL_SIZE : 0);
       ListView_SetColumnWidth(mhList, TBLVIEW_COL_ORDER_NUM, isOrderNumRowVisible() ? miOrderNumColSize : 0);
       ListView_SetColumnWidth(mhList, TBLVIEW_COL_GROUP, isGroupRowVisible() ? gPatternConfTab[TBLVIEW_COL_GROUP].iColumnSize : 0);
       ::InvalidateRgn(mhList, 0, TRUE);
@@ -298,13 +308,28 @@ void tclTableview::resetTableColumns(bool bUpdateWindow) {
    }
 }
 
+bool tclTableview::isWithoutTimeCol(const generic_string& str) {
+   size_t count = 1;
+   for (size_t i = 0; i < str.size(); ++i) {
+      if (str[i] == TEXT(',')) {
+         ++count;
+      }
+   }
+   return count == TBLVIEW_COL_MAX - 1;
+}
+
 // has to be called before create()
 void tclTableview::setTableColumns(const generic_string& str) {
    TCHAR tmp[MAX_CHAR_CELL];
    generic_strncpy(tmp, str.c_str(), MAX_CHAR_CELL);
+   bool bWithoutTimeCol = isWithoutTimeCol(str);
    TCHAR* colWidth = generic_strtok(tmp, TEXT(","));
    int col = 0;
    while (colWidth && col < TBLVIEW_COL_MAX) {
+      if (bWithoutTimeCol && col == TBLVIEW_COL_TIME) {
+         mColumnWidth[col++] = gPatternConfTab[TBLVIEW_COL_TIME].iColumnSize;
+         continue;
+      }
       mColumnWidth[col] = generic_atoi(colWidth);
       colWidth = generic_strtok(NULL, TEXT(","));
       ++col;
@@ -334,12 +359,21 @@ generic_string tclTableview::getTableColumns() const {
 void tclTableview::setTableColumnOrder(const generic_string& str) {
    TCHAR tmp[MAX_CHAR_CELL];
    generic_strncpy(tmp, str.c_str(), MAX_CHAR_CELL);
+   bool bWithoutTimeCol = isWithoutTimeCol(str);
    TCHAR* colOrder = generic_strtok(tmp, TEXT(","));
    int col = 0;
    while (colOrder && col < TBLVIEW_COL_MAX) {
-      mColumnOrder[col] = generic_atoi(colOrder);
+      int order = generic_atoi(colOrder);
+      if (bWithoutTimeCol && order >= TBLVIEW_COL_TIME) {
+         ++order;
+      }
+      mColumnOrder[col] = order;
       colOrder = generic_strtok(NULL, TEXT(","));
       ++col;
+      // the time column is shown behind the hits
+      if (bWithoutTimeCol && order == TBLVIEW_COL_HITS && col < TBLVIEW_COL_MAX) {
+         mColumnOrder[col++] = TBLVIEW_COL_TIME;
+      }
    }
    DBG1("setTableColumnOrder: done %s", str.c_str());
 }
@@ -377,6 +411,7 @@ generic_string tclTableview::getTableColumnOrder() const {
 generic_string tclTableview::getItemNumStr() const { return getItem(TBLVIEW_COL_NUM);}
 #endif
 generic_string tclTableview::getHitsStr() const { return getItem(TBLVIEW_COL_HITS); }
+generic_string tclTableview::getTimeStr() const { return getItem(TBLVIEW_COL_TIME); }
 generic_string tclTableview::getOrderNumStr() const { return getItem(TBLVIEW_COL_ORDER_NUM); }
 generic_string tclTableview::getDoSearchStr() const { return getItem(TBLVIEW_COL_DO_SEARCH);}
 generic_string tclTableview::getSearchTextStr() const { return getItem(TBLVIEW_COL_SEARCH_TEXT);}
@@ -46,6 +46,7 @@ public:
       TBLVIEW_COL_NUM,
 #endif
       TBLVIEW_COL_HITS,
+      TBLVIEW_COL_TIME,
       TBLVIEW_COL_DO_SEARCH,
       TBLVIEW_COL_ORDER_NUM,
       TBLVIEW_COL_SEARCH_TEXT,
@@ -136,6 +137,7 @@ public:
    generic_string getGroupStr() const ;
    generic_string getDoSearchStr() const ;
    generic_string getHitsStr() const;
+   generic_string getTimeStr() const;
    generic_string getOrderNumStr() const;
 #ifdef COL_NUMBERING
    generic_string getItemNumStr() const ;
@@ -176,6 +178,8 @@ protected:
    generic_string getCell(int item, int column) const;
    void updateRow(int item, const tclPattern& rp);
    void updateCell(int item, int column, const generic_string& s);
+   /** column settings stored before the time column existed get it inserted */
+   static bool isWithoutTimeCol(const generic_string& str);
    //void updateRowColor(int item, const tclPattern& rp);
 
    HWND mhList;
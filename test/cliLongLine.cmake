@@ -0,0 +1,26 @@
+# AnalyseCli with regular expressions over a line of 320 KB and with the
+# inline flags of the perl syntax notepad++ accepts.
+# run by ctest: cmake -DCLI=<AnalyseCli> -DWORK=<directory> -P cliLongLine.cmake
+file(MAKE_DIRECTORY "${WORK}")
+file(WRITE "${WORK}/longline.xml" [=[<?xml version="1.0" encoding="UTF-8" ?>
+<AnalyseDoc>
+    <SearchText searchType="regex" matchCase="true">BEGIN.*END</SearchText>
+    <SearchText searchType="regex" matchCase="true">(?i)error</SearchText>
+    <SearchText searchType="regex" matchCase="true">\Qa.b\E</SearchText>
+</AnalyseDoc>
+]=])
+set(filler "xxxxxxxxxx")
+foreach(i RANGE 14)
+   string(APPEND filler "${filler}")
+endforeach()
+file(WRITE "${WORK}/longline.log" "first ERROR\nBEGIN ${filler} END\n${filler}\na.b axb\nno match\n")
+execute_process(COMMAND "${CLI}" -x -t 1 "${WORK}/longline.xml" "${WORK}/longline.log"
+   RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE errors)
+if(NOT result EQUAL 0)
+   message(FATAL_ERROR "AnalyseCli failed with ${result}: ${errors}")
+endif()
+string(REGEX REPLACE "x+" "x" output "${output}")
+set(expected "1: first ERROR\n2: BEGIN x END\n4: a.b axb\n")
+if(NOT output STREQUAL expected)
+   message(FATAL_ERROR "AnalyseCli wrote\n${output}\ninstead of\n${expected}")
+endif()
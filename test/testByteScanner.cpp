@@ -0,0 +1,179 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tests of the kernels of tclByteScanner against a naive scan
+*/
+#include <random>
+#include <vector>
+#include "tclByteScanner.h"
+#include "catch.hpp"
+
+namespace {
+
+   const unsigned char* findNaive(const unsigned char* bytes, unsigned count, const unsigned char* p, const unsigned char* end) {
+      for (; p < end; ++p) {
+         for (unsigned i = 0; i < count; ++i) {
+            if (*p == bytes[i]) {
+               return p;
+            }
+         }
+      }
+      return end;
+   }
+
+   /** the kernel set is used by all scanners until the test is left */
+   class tclKernelScope {
+   public:
+      explicit tclKernelScope(tclByteScanner::teKernel kernel)
+         : mFormer(tclByteScanner::getKernel()) {
+         tclByteScanner::setKernel(kernel);
+      }
+      ~tclKernelScope() {
+         tclByteScanner::setKernel(mFormer);
+      }
+   private:
+      tclByteScanner::teKernel mFormer;
+   };
+
+}
+
+TEST_CASE("ByteScanner") {
+
+   std::mt19937 random(4711);
+   // a text of few different bytes has hits close to each other and far apart
+   std::vector<unsigned char> text(4096);
+   for (size_t i = 0; i < text.size(); ++i) {
+      text[i] = (random() % 4 == 0) ? (unsigned char)(random() % 256) : (unsigned char)('a' + random() % 3);
+   }
+   const unsigned char* pText = text.data();
+   const unsigned char* pEnd = pText + text.size();
+
+   for (int k = tclByteScanner::kernelScalar; k <= tclByteScanner::getSupportedKernel(); ++k) {
+      const tclByteScanner::teKernel kernel = (tclByteScanner::teKernel)k;
+      tclKernelScope scope(kernel);
+      REQUIRE(tclByteScanner::getKernel() == kernel);
+      INFO("kernel " << tclByteScanner::getKernelName(kernel));
+
+      // random sets of each size, half of them with a frequent byte
+      for (unsigned count = 1; count <= BYTESCANNER_MAX_BYTES; ++count) {
+         for (int round = 0; round < 20; ++round) {
+            unsigned char bytes[BYTESCANNER_MAX_BYTES];
+            for (unsigned i = 0; i < count; ++i) {
+               // duplicates and the zero byte included
+               bytes[i] = (unsigned char)(random() % 256);
+            }
+            if (round % 2 == 0) {
+               bytes[0] = (unsigned char)('a' + random() % 3);
+            }
+            tclByteScanner scanner;
+            REQUIRE(scanner.setBytes(bytes, count));
+            // random ranges start unaligned and end in a tail shorter than a vector
+            for (int test = 0; test < 200; ++test) {
+               const unsigned char* p = pText + random() % text.size();
+               const unsigned char* end = p + random() % (pEnd - p + 1);
+               INFO("count " << count << " from " << (p - pText) << " to " << (end - pText));
+               REQUIRE(scanner.find(p, end) == findNaive(bytes, count, p, end));
+            }
+            for (const unsigned char* p = pText; p < pEnd; ) {
+               const unsigned char* pHit = scanner.find(p, pEnd);
+               REQUIRE(pHit == findNaive(bytes, count, p, pEnd));
+               p = pHit + 1;
+            }
+         }
+      }
+
+      {
+         // nothing to scan
+         const unsigned char byte = 'a';
+         tclByteScanner scanner;
+         REQUIRE(scanner.setBytes(&byte, 1));
+         REQUIRE(scanner.find(pText, pText) == pText);
+      }
+
+      {
+         // every byte is a hit
+         const unsigned char bytes[] = "abcdefghi";
+         tclByteScanner scanner;
+         REQUIRE_FALSE(scanner.setBytes(bytes, BYTESCANNER_MAX_BYTES + 1));
+         REQUIRE(scanner.find(pText + 7, pEnd) == pText + 7);
+      }
+   }
+}
+
+TEST_CASE("PairScanner") {
+
+   std::mt19937 random(815);
+   std::vector<unsigned char> text(4096);
+   for (size_t i = 0; i < text.size(); ++i) {
+      text[i] = (random() % 4 == 0) ? (unsigned char)(random() % 256) : (unsigned char)('a' + random() % 6);
+   }
+   const unsigned char* pText = text.data();
+   const unsigned char* pEnd = pText + text.size();
+
+   for (int k = tclByteScanner::kernelScalar; k <= tclByteScanner::getSupportedKernel(); ++k) {
+      const tclByteScanner::teKernel kernel = (tclByteScanner::teKernel)k;
+      tclKernelScope scope(kernel);
+      INFO("kernel " << tclByteScanner::getKernelName(kernel));
+
+      for (int round = 0; round < 40; ++round) {
+         // the first two bytes of literals in both cases, some of one byte only
+         std::vector<bool> pairs(BYTESCANNER_PAIRS, false);
+         std::vector<bool> firsts(256, false);
+         const unsigned count = 1 + random() % 30;
+         for (unsigned i = 0; i < count; ++i) {
+            const unsigned first = (round % 2 == 0) ? 'a' + random() % 26 : random() % 256;
+            const unsigned second = (random() % 2 == 0) ? 'a' + random() % 6 : random() % 256;
+            for (unsigned follower = 0; follower < 256; ++follower) {
+               if (follower == second || (i % 8 == 7)) {
+                  pairs[first * 256 + follower] = true;
+                  if (first >= 'a' && first <= 'z') {
+                     pairs[(first - 'a' + 'A') * 256 + follower] = true;
+                  }
+               }
+            }
+            firsts[first] = true;
+            if (first >= 'a' && first <= 'z') {
+               firsts[first - 'a' + 'A'] = true;
+            }
+         }
+         tclByteScanner scanner;
+         scanner.setPairs(pairs);
+         REQUIRE(scanner.getIsSkipping());
+         for (int test = 0; test < 200; ++test) {
+            const unsigned char* p = pText + random() % text.size();
+            const unsigned char* end = p + random() % (pEnd - p + 1);
+            const unsigned char* expected = p;
+            while (expected < end && !(expected + 1 < end ? pairs[expected[0] * 256 + expected[1]] : firsts[*expected])) {
+               ++expected;
+            }
+            INFO("round " << round << " from " << (p - pText) << " to " << (end - pText));
+            REQUIRE(scanner.find(p, end) == expected);
+         }
+      }
+
+      {
+         // single bytes again after pairs
+         const unsigned char byte = 'a';
+         tclByteScanner scanner;
+         scanner.setPairs(std::vector<bool>(BYTESCANNER_PAIRS, true));
+         REQUIRE(scanner.find(pText + 3, pEnd) == pText + 3);
+         REQUIRE(scanner.setBytes(&byte, 1));
+         REQUIRE(scanner.find(pText, pEnd) == findNaive(&byte, 1, pText, pEnd));
+      }
+   }
+}
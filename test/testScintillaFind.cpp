@@ -0,0 +1,284 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tests of tclSearchEngine against Document::FindText() of scintilla, which
+finds the patterns in doFindPattern() when the engine is not used
+*/
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ScintillaTypes.h"
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Debugging.h"
+#include "CharacterCategoryMap.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+
+#include "tclCompiledPattern.h"
+#include "tclSearchEngine.h"
+#include "catch.hpp"
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+
+// needed by the scintilla sources tested against
+void Platform::Assert(const char* c, const char* file, int line) noexcept
+{
+   fprintf(stderr, "Assertion [%s] failed at %s %d\n", c, file, line);
+   abort();
+}
+
+void Platform::DebugPrintf(const char* format, ...) noexcept
+{
+   va_list pArguments;
+   va_start(pArguments, format);
+   vfprintf(stderr, format, pArguments);
+   va_end(pArguments);
+}
+
+namespace {
+
+   /** document searched by scintilla and by the engine */
+   class tclSciDoc : public tclSearchHost {
+   public:
+      tclSciDoc(const std::string& text, int codePage)
+         : mDoc(DocumentOption::Default)
+         , mCodePage(codePage)
+      {
+         mDoc.SetDBCSCodePage(codePage);
+         if (codePage == CpUtf8) {
+            mDoc.SetCaseFolder(std::make_unique<CaseFolderUnicode>());
+         } else {
+            mDoc.SetCaseFolder(std::make_unique<CaseFolderTable>());
+         }
+         mDoc.InsertString(0, text.data(), (Sci::Position)text.size());
+      }
+
+      // the plugin asks SCI_ISRANGEWORD, which is this
+      virtual bool isRangeWord(tiLine start, tiLine end) {
+         return mDoc.IsWordAt(start, end);
+      }
+
+      virtual bool isSearchCanceled() {
+         return false;
+      }
+
+      /** hits of the SCI_SEARCHINTARGET loop in doFindPattern() as "start-end@line" */
+      std::string findText(const tclPattern& pattern) {
+         FindOption flags = FindOption::None;
+         if (pattern.getIsMatchCase()) {
+            flags = flags | FindOption::MatchCase;
+         }
+         if (pattern.getIsWholeWord()) {
+            flags = flags | FindOption::WholeWord;
+         }
+         const std::string& text = pattern.getCompiled(mCodePage).getText();
+         std::string s;
+         Sci::Position start = 0;
+         for (;;) {
+            Sci::Position length = (Sci::Position)text.size();
+            Sci::Position pos = mDoc.FindText(start, mDoc.Length(), text.c_str(), flags, &length);
+            if (pos < 0) {
+               break;
+            }
+            // a match reaching into further lines is kept for each of them
+            for (Sci::Line line = mDoc.SciLineFromPosition(pos); line <= mDoc.SciLineFromPosition(pos + length); ++line) {
+               s += std::to_string((long long)pos) + "-" + std::to_string((long long)(pos + length)) +
+                    "@" + std::to_string((long long)line) + " ";
+            }
+            start = pos + length;
+         }
+         return s;
+      }
+
+      /** the same as findText() by the engine with up to threads threads */
+      std::string search(const tclPattern& pattern, unsigned threads) {
+         tclSearchEngine engine;
+         engine.setHost(this);
+         engine.setCodePage(mCodePage);
+         engine.setCharClasses(getCharsOfClass(CharacterClass::word),
+                               getCharsOfClass(CharacterClass::space),
+                               getCharsOfClass(CharacterClass::punctuation));
+         engine.setMaxThreads(threads);
+         // the generated documents of a few KB are split into chunks for each thread
+         engine.setMinChunkSize(256);
+         engine.setDocument(mDoc.BufferPointer(), mDoc.Length());
+         REQUIRE(engine.isSupported(pattern));
+         tclResultList list;
+         list.push_back(pattern);
+         tclResultList::tlmResult found;
+         engine.search(list, found);
+         if (found.empty()) {
+            // left to doFindPattern() for characters scintilla folds to ASCII letters
+            REQUIRE_FALSE(pattern.getIsMatchCase());
+            REQUIRE(hasFoldedChars());
+            return findText(pattern);
+         }
+         REQUIRE(found.size() == 1);
+         std::string s;
+         const tclResult::tlvPosInfo& positions = found.begin()->second.getPositions();
+         for (size_t i = 0; i < positions.size(); ++i) {
+            s += std::to_string((long long)positions[i].start) + "-" + std::to_string((long long)positions[i].end) +
+                 "@" + std::to_string((long long)positions[i].line) + " ";
+         }
+         return s;
+      }
+
+      /** true if the text contains a character CaseFolderUnicode folds to ASCII letters */
+      bool hasFoldedChars() {
+         static const char* folded[] = {
+            "\xc3\x9f", "\xc5\xbf", "\xe1\xba\x9e", "\xe2\x84\xaa", "\xef\xac\x80", "\xef\xac\x81",
+            "\xef\xac\x82", "\xef\xac\x83", "\xef\xac\x84", "\xef\xac\x85", "\xef\xac\x86"
+         };
+         std::string_view text(mDoc.BufferPointer(), (size_t)mDoc.Length());
+         for (size_t i = 0; i < sizeof(folded) / sizeof(folded[0]); ++i) {
+            if (text.find(folded[i]) != std::string_view::npos) {
+               return true;
+            }
+         }
+         return false;
+      }
+
+   protected:
+      /** as SCI_GETWORDCHARS and its siblings */
+      std::string getCharsOfClass(CharacterClass charClass) const {
+         unsigned char buffer[256];
+         int count = mDoc.GetCharsOfClass(charClass, buffer);
+         return std::string((const char*)buffer, count);
+      }
+
+      Document mDoc;
+      int mCodePage;
+   };
+
+   tclPattern makePattern(const std::string& text, bool bMatchCase, bool bWholeWord) {
+      tclPattern pattern;
+      pattern.setSearchText(text);
+      pattern.setSearchType(tclPattern::normal);
+      pattern.setMatchCase(bMatchCase);
+      pattern.setWholeWord(bWholeWord);
+      return pattern;
+   }
+
+   /** random text out of the given pieces */
+   std::string makeText(std::mt19937& random, const std::vector<std::string>& pieces, size_t count) {
+      std::string text;
+      for (size_t i = 0; i < count; ++i) {
+         text += pieces[random() % pieces.size()];
+      }
+      return text;
+   }
+
+   /** compare engine and scintilla for all option combinations of the patterns */
+   void compare(const std::string& text, int codePage, const std::vector<std::string>& patterns) {
+      tclSciDoc doc(text, codePage);
+      for (size_t p = 0; p < patterns.size(); ++p) {
+         bool bAscii = true;
+         for (size_t i = 0; i < patterns[p].size(); ++i) {
+            if ((unsigned char)patterns[p][i] >= 0x80) {
+               bAscii = false;
+            }
+         }
+         for (int options = 0; options < 4; ++options) {
+            const bool bMatchCase = (options & 1) != 0;
+            const bool bWholeWord = (options & 2) != 0;
+            if (!bMatchCase && !bAscii) {
+               // scintilla folds these by itself, see tclSearchEngine::isSupported()
+               continue;
+            }
+            tclPattern pattern = makePattern(patterns[p], bMatchCase, bWholeWord);
+            const std::string expected = doc.findText(pattern);
+            INFO("pattern '" << patterns[p] << "' match case " << bMatchCase << " whole word " << bWholeWord);
+            REQUIRE(doc.search(pattern, 1) == expected);
+            REQUIRE(doc.search(pattern, 4) == expected);
+         }
+      }
+   }
+
+}
+
+TEST_CASE("SameAsScintilla") {
+
+   std::mt19937 random(815);
+
+   SECTION("Ansi") {
+      const std::vector<std::string> pieces = {
+         "ab", "AB", "aB", "b", "a", " ", "_", ".", "-", "1", "\t", "\r\n", "\n", "\r", "\xe4", "\xc4" "b", "a\xdf"
+      };
+      const std::vector<std::string> patterns = {
+         "a", "ab", "Ab", "ba", "aa", "b a", "a_b", "a.b", "1a", "b\r\na", "a\xe4", "\xc4"
+      };
+      for (int round = 0; round < 10; ++round) {
+         compare(makeText(random, pieces, 2000), 0, patterns);
+      }
+   }
+
+   SECTION("Utf8") {
+      // umlauts, the euro sign and a letter out of the supplementary planes
+      const std::vector<std::string> pieces = {
+         "ab", "AB", "aB", "b", "a", " ", "_", ".", "1", "\r\n", "\n",
+         "\xc3\xa4", "\xc3\x84" "b", "a\xc3\x9f", "\xe2\x82\xac", "\xf0\x90\x90\x80", "\xe3\x80\x80"
+      };
+      const std::vector<std::string> patterns = {
+         "a", "ab", "Ab", "ba", "b a", "a_b", "a.b", "b\r\na", "\n\n",
+         "a\xc3\xa4", "\xc3\x84", "\xe2\x82\xac" "a", "\xf0\x90\x90\x80", "b\xe3\x80\x80"
+      };
+      for (int round = 0; round < 10; ++round) {
+         compare(makeText(random, pieces, 2000), CpUtf8, patterns);
+      }
+   }
+
+   SECTION("Utf8Folded") {
+      // sharp s, long s, capital sharp s, the kelvin sign and the ligatures ff, fi, st
+      const std::vector<std::string> folded = {
+         "\xc3\x9f", "\xc5\xbf", "\xe1\xba\x9e", "\xe2\x84\xaa", "\xef\xac\x80", "\xef\xac\x81", "\xef\xac\x86"
+      };
+      std::vector<std::string> pieces = {
+         "s", "S", "k", "K", "f", "i", "t", "a", " ", "\n", "\xc3\xa4", "\xe2\x82\xac"
+      };
+      const std::vector<std::string> patterns = {
+         "s", "ss", "k", "sk", "Ks", "ff", "fi", "st", "ffi", "a", "at"
+      };
+      // the engine finds them all without the folded characters
+      for (int round = 0; round < 5; ++round) {
+         compare(makeText(random, pieces, 2000), CpUtf8, patterns);
+      }
+      pieces.insert(pieces.end(), folded.begin(), folded.end());
+      for (int round = 0; round < 10; ++round) {
+         compare(makeText(random, pieces, 2000), CpUtf8, patterns);
+      }
+   }
+}
@@ -0,0 +1,257 @@
+/* -------------------------------------
+This file is part of AnalysePlugin for NotePad++
+Copyright (c) 2022 Matthias H. mattesh(at)gmx.net
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either
+version 3 of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------- */
+/**
+tests of the patterns searched by tclSearchEngine through tclBatchAnalyser
+*/
+#include <algorithm>
+#include <string>
+#include <random>
+#include <vector>
+#include "tclBatchAnalyser.h"
+#include "tclCompiledPattern.h"
+#include "tclRegex.h"
+#include "Scintilla.h"
+#include "catch.hpp"
+
+namespace {
+
+   tclPattern makePattern(const char* text, int searchType, bool bMatchCase = false) {
+      tclPattern pattern;
+      pattern.setSearchText(text);
+      pattern.setSearchType(searchType);
+      pattern.setMatchCase(bMatchCase);
+      return pattern;
+   }
+
+   /** positions found by the pattern in doc as "start-end@line" */
+   std::string analyse(const tclPattern& pattern, const std::string& doc, unsigned threads = 1) {
+      tclResultList list;
+      list.push_back(pattern);
+      tclBatchAnalyser analyser;
+      analyser.setMaxThreads(threads);
+      analyser.analyse(list, doc.data(), (tiLine)doc.size());
+      std::string s;
+      const tclResult::tlvPosInfo& positions = list.begin().getResult().getPositions();
+      for (size_t i = 0; i < positions.size(); ++i) {
+         s += std::to_string((long long)positions[i].start) + "-" + std::to_string((long long)positions[i].end) + 
+              "@" + std::to_string((long long)positions[i].line) + " ";
+      }
+      return s;
+   }
+
+   /** the same as analyse() by one tclRegex over the whole document */
+   std::string findPlain(const tclPattern& pattern, const std::string& doc) {
+      std::vector<tiLine> lineStarts(1, 0);
+      for (size_t i = 0; i < doc.size(); ++i) {
+         if (doc[i] == '\n') {
+            lineStarts.push_back((tiLine)i + 1);
+         }
+      }
+      const tclRegex& regex = pattern.getCompiled(SC_CP_UTF8).getRegex();
+      const tiLine length = (tiLine)doc.size();
+      std::string s;
+      tiLine pos = 0;
+      tiLine start;
+      tiLine end;
+      while (pos <= length && regex.find(doc.data(), length, pos, length, start, end)) {
+         tiLine first = (tiLine)(std::upper_bound(lineStarts.begin(), lineStarts.end(), start) - lineStarts.begin()) - 1;
+         tiLine last = (tiLine)(std::upper_bound(lineStarts.begin(), lineStarts.end(), end) - lineStarts.begin()) - 1;
+         for (tiLine line = first; line <= last; ++line) {
+            s += std::to_string((long long)start) + "-" + std::to_string((long long)end) + 
+                 "@" + std::to_string((long long)line) + " ";
+         }
+         pos = (end > start) ? end : regex.getNextChar(doc.data(), length, end);
+      }
+      return s;
+   }
+
+}
+
+TEST_CASE("EscapedPattern") {
+
+   SECTION("CompiledTextHasNoTerminator") {
+      tclPattern pattern = makePattern("a\\tb", tclPattern::escaped);
+      REQUIRE(pattern.getCompiled(SC_CP_UTF8).getText() == std::string("a\tb"));
+   }
+
+   SECTION("Tab") {
+      const std::string doc = "xx a\tb yy\nfoo\nA\tB\n";
+      REQUIRE(analyse(makePattern("a\\tb", tclPattern::escaped), doc) == "3-6@0 14-17@2 ");
+      REQUIRE(analyse(makePattern("a\\tb", tclPattern::escaped, true), doc) == "3-6@0 ");
+   }
+
+   SECTION("LineEnd") {
+      // a match reaching into the next line is kept for both lines as in doFindPattern()
+      const std::string doc = "Foo::bar\r\nFoo::bar x\r\nFoo::bar\r\n";
+      REQUIRE(analyse(makePattern("Foo::bar\\r\\n", tclPattern::escaped), doc) == "0-10@0 0-10@1 22-32@2 22-32@3 ");
+   }
+
+   SECTION("SameAsNormal") {
+      const std::string doc = "one two\nthree one\n";
+      REQUIRE(analyse(makePattern("one", tclPattern::escaped), doc) == analyse(makePattern("one", tclPattern::normal), doc));
+   }
+}
+
+TEST_CASE("RequiredLiteral") {
+
+   SECTION("Text") {
+      REQUIRE(tclCompiledPattern::getRequiredLiteralText("ab+cde") == "cde");
+      REQUIRE(tclCompiledPattern::getRequiredLiteralText("(?:x|y)error") == "error");
+      REQUIRE(tclCompiledPattern::getRequiredLiteralText("(?<!x)error") == "error");
+   }
+
+   SECTION("DialectGivesNone") {
+      // constructs of the perl syntax of boost, which change the meaning of the rest
+      REQUIRE(tclCompiledPattern::getRequiredLiteralText("(?i)error") == "");
+      REQUIRE(tclCompiledPattern::getRequiredLiteralText("(?x) err or") == "");
+      REQUIRE(tclCompiledPattern::getRequiredLiteralText("(?i:E)rror") == "");
+      REQUIRE(tclCompiledPattern::getRequiredLiteralText("\\Qa.b\\E") == "");
+      REQUIRE(tclCompiledPattern::getRequiredLiteralText("(?<w>ab)\\k<w>") == "");
+      REQUIRE(tclCompiledPattern::getRequiredLiteralText("\\x{41}bc") == "");
+      REQUIRE(tclCompiledPattern::getRequiredLiteralText("\\p{L}abc") == "");
+   }
+
+   SECTION("SameAsUnfiltered") {
+      // each pattern with a required literal against one without
+      const std::string doc = "ERROR one\nerror two\nerr or\na.b axb\nError\n";
+      REQUIRE(analyse(makePattern("(?i)error", tclPattern::regex, true), doc) ==
+              analyse(makePattern("[e]rror", tclPattern::regex, false), doc));
+      REQUIRE(analyse(makePattern("(?i)error", tclPattern::regex, true), doc) == "0-5@0 10-15@1 35-40@4 ");
+      REQUIRE(analyse(makePattern("(?x) err or", tclPattern::regex, true), doc) ==
+              analyse(makePattern("[e]rror", tclPattern::regex, true), doc));
+      REQUIRE(analyse(makePattern("\\Qa.b\\E", tclPattern::regex, true), doc) ==
+              analyse(makePattern("a[.]b", tclPattern::regex, true), doc));
+      REQUIRE(analyse(makePattern("\\Qa.b\\E", tclPattern::regex, true), doc) == "27-30@3 ");
+   }
+
+   SECTION("FoldedByBoost") {
+      // the kelvin sign and the capital I with dot above may match k and i,
+      // depending on the case folding of the platform
+      const std::string doc = "one \xe2\x84\xaa" "ilo\nt\xc4\xb0" "ck\nkilo tick\n";
+      const tclPattern kilo = makePattern("kilo\\b", tclPattern::regex);
+      const tclPattern tick = makePattern("tick\\b", tclPattern::regex);
+      REQUIRE(analyse(kilo, doc) == findPlain(kilo, doc));
+      REQUIRE(analyse(tick, doc) == findPlain(tick, doc));
+   }
+}
+
+TEST_CASE("RegexChunks") {
+
+   // large enough for being split into chunks searched by four threads
+   std::mt19937 random(4711);
+   const char* pieces[] = { "err", "error ", "42", "abc", " ", "x", "y", "\n", "\r\n", "\xc3\xa4" };
+   std::string doc;
+   while (doc.size() < 5 * 1024 * 1024) {
+      doc += pieces[random() % (sizeof(pieces) / sizeof(pieces[0]))];
+   }
+   const tclPattern patterns[] = {
+      makePattern("err(or)? ?[0-9]+", tclPattern::regex),   // line bound with a literal
+      makePattern("^[a-z]+$", tclPattern::regex, true),     // line bound without one
+      makePattern("$", tclPattern::regex),                  // empty at each line end
+      makePattern("x\\r?\\ny", tclPattern::regex),          // across lines
+      makePattern("c.x", tclPattern::rgx_multiline)         // . matching line ends
+   };
+   for (size_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]); ++p) {
+      INFO("pattern " << p);
+      const std::string expected = findPlain(patterns[p], doc);
+      REQUIRE(expected.size() > 0);
+      // megabytes of positions are not worth printing
+      REQUIRE((analyse(patterns[p], doc, 4) == expected));
+      REQUIRE((analyse(patterns[p], doc, 1) == expected));
+   }
+}
+
+TEST_CASE("ManyFirstBytes") {
+
+   // more first bytes than the scanner compares at once, the scan skips to
+   // the first two bytes of a literal then
+   std::mt19937 random(42);
+   const char* pieces[] = { "Error", "warn", "info", "debug", "x", "q", "Trace", "\r\n", "\n", " ", "=", "42", "\xc3\xa4" };
+   std::string doc;
+   while (doc.size() < 256 * 1024) {
+      doc += pieces[random() % (sizeof(pieces) / sizeof(pieces[0]))];
+   }
+   tclResultList list;
+   const char* texts[] = { "error", "warn", "info", "debug", "trace", "q", "42", "=x", "fatal", "ox", "nd", "\xc3\xa4" };
+   for (size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); ++t) {
+      list.push_back(makePattern(texts[t], tclPattern::normal, t % 3 == 2));
+   }
+   tclBatchAnalyser analyser;
+   analyser.analyse(list, doc.data(), (tiLine)doc.size());
+   for (tclResultList::const_iterator iResult = list.begin(); iResult != list.end(); ++iResult) {
+      const tclPattern& pattern = list.getPattern(iResult.getPatId());
+      INFO("pattern " << pattern.getSearchText());
+      std::string s;
+      const tclResult::tlvPosInfo& positions = iResult.getResult().getPositions();
+      for (size_t i = 0; i < positions.size(); ++i) {
+         s += std::to_string((long long)positions[i].start) + "-" + std::to_string((long long)positions[i].end) + 
+              "@" + std::to_string((long long)positions[i].line) + " ";
+      }
+      REQUIRE((s == findPlain(pattern, doc)));
+   }
+}
+
+TEST_CASE("CollectDuringRun") {
+
+   const std::string doc = "one error\ntwo warning\nthree error 42\n";
+   tclResultList list;
+   list.push_back(makePattern("error", tclPattern::normal));
+   list.push_back(makePattern("warning", tclPattern::normal));
+   list.push_back(makePattern("e[0-9]+", tclPattern::regex));
+   list.push_back(makePattern("r [0-9]+$", tclPattern::regex));
+   tclSearchEngine engine;
+   engine.setCodePage(SC_CP_UTF8);
+   engine.setMaxThreads(1);
+   engine.setDocument(doc.data(), (tiLine)doc.size());
+   // each pattern is handed over once, whenever it is collected
+   unsigned progress = 0;
+   tclResultList::tlmResult found;
+   engine.setOnProgress([&engine, &progress, &found]() {
+      ++progress;
+      engine.collect(found);
+   });
+   REQUIRE(engine.prepare(list) == 4);
+   engine.run(false);
+   REQUIRE(engine.collect(found) == 0);
+   // the literals share one automaton
+   REQUIRE(progress == 3);
+   REQUIRE(found.size() == 4);
+   tclResultList::const_iterator iResult = list.begin();
+   REQUIRE(found[iResult.getPatId()].size() == 2);
+   REQUIRE(found[(++iResult).getPatId()].size() == 1);
+   REQUIRE(found[(++iResult).getPatId()].size() == 0);
+   REQUIRE(found[(++iResult).getPatId()].size() == 1);
+   REQUIRE(found[iResult.getPatId()].getPosition(0).line == 2);
+}
+
+TEST_CASE("BatchCancelToken") {
+
+   // the token stops an analyser running on another thread than its host
+   const std::string doc = "one error\ntwo warning\n";
+   tclResultList list;
+   list.push_back(makePattern("err(or)?", tclPattern::regex));
+   tclCancelToken token;
+   tclBatchAnalyser analyser;
+   analyser.setCancelToken(&token);
+   analyser.analyse(list, doc.data(), (tiLine)doc.size());
+   REQUIRE_FALSE(analyser.getCanceled());
+   REQUIRE(list.begin().getResult().size() == 1);
+   token.cancel();
+   analyser.analyse(list, doc.data(), (tiLine)doc.size());
+   REQUIRE(analyser.getCanceled());
+}